@@ -26,6 +26,7 @@
 #include "networkmanager.h"
 #include "browserwindow.h"
 #include "settings.h"
+#include "requestinfo.h"
 
 #include <QDateTime>
 #include <QTextStream>
@@ -82,26 +83,28 @@ QList<AdBlockSubscription*> AdBlockManager::subscriptions() const
 }
 
 QNetworkReply* AdBlockManager::block(const QNetworkRequest &request)
+{
+    return block(request, RequestInfo(request.url()));
+}
+
+QNetworkReply* AdBlockManager::block(const QNetworkRequest &request, const RequestInfo &info)
 {
 #ifdef ADBLOCK_DEBUG
     QElapsedTimer timer;
     timer.start();
 #endif
-    const QString urlString = request.url().toEncoded().toLower();
-    const QString urlDomain = request.url().host().toLower();
-    const QString urlScheme = request.url().scheme().toLower();
-
-    if (!isEnabled() || !canRunOnScheme(urlScheme)) {
+    if (!isEnabled() || !canRunOnScheme(info.schemeString())) {
         return 0;
     }
 
+    const QString urlString = request.url().toEncoded().toLower();
+
     foreach (AdBlockSubscription* subscription, m_subscriptions) {
-        const AdBlockRule* blockedRule = subscription->match(request, urlDomain, urlString);
+        const AdBlockRule* blockedRule = subscription->match(request, info, urlString);
 
         if (blockedRule) {
-            QVariant v = request.attribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100));
-            WebPage* webPage = static_cast<WebPage*>(v.value<void*>());
-            if (WebPage::isPointerSafeToUse(webPage)) {
+            WebPage* webPage = WebPage::fromRequest(request);
+            if (webPage) {
                 if (!canBeBlocked(webPage->url())) {
                     return 0;
                 }
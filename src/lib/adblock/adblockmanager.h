@@ -28,6 +28,8 @@ class QUrl;
 class QNetworkReply;
 class QNetworkRequest;
 
+class RequestInfo;
+
 class AdBlockDialog;
 class AdBlockCustomList;
 class AdBlockSubscription;
@@ -56,6 +58,7 @@ public:
     QList<AdBlockSubscription*> subscriptions() const;
 
     QNetworkReply* block(const QNetworkRequest &request);
+    QNetworkReply* block(const QNetworkRequest &request, const RequestInfo &info);
 
     QStringList disabledRules() const;
     void addDisabledRule(const QString &filter);
@@ -48,6 +48,7 @@
 #include "adblocksubscription.h"
 #include "qztools.h"
 #include "qzregexp.h"
+#include "requestinfo.h"
 
 #include <QUrl>
 #include <QString>
@@ -56,44 +57,6 @@
 #include <QWebFrame>
 #include <QWebPage>
 
-// Version for Qt < 4.8 has one issue, it will wrongly
-// count .co.uk (and others) as second-level domain
-static QString toSecondLevelDomain(const QUrl &url)
-{
-#if QT_VERSION >= 0x040800
-    const QString topLevelDomain = url.topLevelDomain();
-    const QString urlHost = url.host();
-
-    if (topLevelDomain.isEmpty() || urlHost.isEmpty()) {
-        return QString();
-    }
-
-    QString domain = urlHost.left(urlHost.size() - topLevelDomain.size());
-
-    if (domain.count(QLatin1Char('.')) == 0) {
-        return urlHost;
-    }
-
-    while (domain.count(QLatin1Char('.')) != 0) {
-        domain = domain.mid(domain.indexOf(QLatin1Char('.')) + 1);
-    }
-
-    return domain + topLevelDomain;
-#else
-    QString domain = url.host();
-
-    if (domain.count(QLatin1Char('.')) == 0) {
-        return QString();
-    }
-
-    while (domain.count(QLatin1Char('.')) != 1) {
-        domain = domain.mid(domain.indexOf(QLatin1Char('.')) + 1);
-    }
-
-    return domain;
-#endif
-}
-
 AdBlockRule::AdBlockRule(const QString &filter, AdBlockSubscription* subscription)
     : m_subscription(subscription)
     , m_type(StringContainsMatchRule)
@@ -189,13 +152,15 @@ bool AdBlockRule::urlMatch(const QUrl &url) const
     }
 
     const QString encodedUrl = url.toEncoded();
-    const QString domain = url.host();
+    const RequestInfo info(url);
 
-    return networkMatch(QNetworkRequest(url), domain, encodedUrl);
+    return networkMatch(QNetworkRequest(url), info, encodedUrl);
 }
 
-bool AdBlockRule::networkMatch(const QNetworkRequest &request, const QString &domain, const QString &encodedUrl) const
+bool AdBlockRule::networkMatch(const QNetworkRequest &request, const RequestInfo &info, const QString &encodedUrl) const
 {
+    const QString &domain = info.host();
+
     if (m_type == CssRule || !m_isEnabled || m_isInternalDisabled) {
         return false;
     }
@@ -216,7 +181,7 @@ bool AdBlockRule::networkMatch(const QNetworkRequest &request, const QString &do
             return false;
         }
 
-        matched = (m_regExp->regExp.indexIn(encodedUrl) != -1);
+        matched = m_regExp->regExp.matches(encodedUrl);
     }
 
     if (matched) {
@@ -226,7 +191,7 @@ bool AdBlockRule::networkMatch(const QNetworkRequest &request, const QString &do
         }
 
         // Check third-party restriction
-        if (hasOption(ThirdPartyOption) && !matchThirdParty(request)) {
+        if (hasOption(ThirdPartyOption) && !matchThirdParty(request, info)) {
             return false;
         }
 
@@ -296,7 +261,7 @@ bool AdBlockRule::matchDomain(const QString &domain) const
     return false;
 }
 
-bool AdBlockRule::matchThirdParty(const QNetworkRequest &request) const
+bool AdBlockRule::matchThirdParty(const QNetworkRequest &request, const RequestInfo &info) const
 {
     const QString referer = request.attribute(QNetworkRequest::Attribute(QNetworkRequest::User + 151), QString()).toString();
 
@@ -305,10 +270,9 @@ bool AdBlockRule::matchThirdParty(const QNetworkRequest &request) const
     }
 
     // Third-party matching should be performed on second-level domains
-    const QString refererHost = toSecondLevelDomain(QUrl(referer));
-    const QString host = toSecondLevelDomain(request.url());
+    const QString refererHost = RequestInfo::registrableDomainForUrl(QUrl(referer));
 
-    bool match = refererHost != host;
+    bool match = refererHost != info.registrableDomain();
 
     return hasException(ThirdPartyOption) ? !match : match;
 }
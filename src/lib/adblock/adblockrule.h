@@ -55,6 +55,8 @@
 class QNetworkRequest;
 class QUrl;
 
+class RequestInfo;
+
 class AdBlockSubscription;
 
 class QUPZILLA_EXPORT AdBlockRule
@@ -86,10 +88,10 @@ public:
     bool isInternalDisabled() const;
 
     bool urlMatch(const QUrl &url) const;
-    bool networkMatch(const QNetworkRequest &request, const QString &domain, const QString &encodedUrl) const;
+    bool networkMatch(const QNetworkRequest &request, const RequestInfo &info, const QString &encodedUrl) const;
 
     bool matchDomain(const QString &domain) const;
-    bool matchThirdParty(const QNetworkRequest &request) const;
+    bool matchThirdParty(const QNetworkRequest &request, const RequestInfo &info) const;
     bool matchObject(const QNetworkRequest &request) const;
     bool matchSubdocument(const QNetworkRequest &request) const;
     bool matchXmlHttpRequest(const QNetworkRequest &request) const;
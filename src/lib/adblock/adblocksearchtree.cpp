@@ -67,7 +67,7 @@ bool AdBlockSearchTree::add(const AdBlockRule* rule)
     return true;
 }
 
-const AdBlockRule* AdBlockSearchTree::find(const QNetworkRequest &request, const QString &domain, const QString &urlString) const
+const AdBlockRule* AdBlockSearchTree::find(const QNetworkRequest &request, const RequestInfo &info, const QString &urlString) const
 {
     int len = urlString.size();
 
@@ -78,7 +78,7 @@ const AdBlockRule* AdBlockSearchTree::find(const QNetworkRequest &request, const
     const QChar* string = urlString.constData();
 
     for (int i = 0; i < len; ++i) {
-        const AdBlockRule* rule = prefixSearch(request, domain, urlString, string++, len - i);
+        const AdBlockRule* rule = prefixSearch(request, info, urlString, string++, len - i);
         if (rule) {
             return rule;
         }
@@ -87,7 +87,7 @@ const AdBlockRule* AdBlockSearchTree::find(const QNetworkRequest &request, const
     return 0;
 }
 
-const AdBlockRule* AdBlockSearchTree::prefixSearch(const QNetworkRequest &request, const QString &domain, const QString &urlString, const QChar* string, int len) const
+const AdBlockRule* AdBlockSearchTree::prefixSearch(const QNetworkRequest &request, const RequestInfo &info, const QString &urlString, const QChar* string, int len) const
 {
     if (len <= 0) {
         return 0;
@@ -104,7 +104,7 @@ const AdBlockRule* AdBlockSearchTree::prefixSearch(const QNetworkRequest &reques
     for (int i = 1; i < len; ++i) {
         const QChar c = (++string)[0];
 
-        if (node->rule && node->rule->networkMatch(request, domain, urlString)) {
+        if (node->rule && node->rule->networkMatch(request, info, urlString)) {
             return node->rule;
         }
 
@@ -115,7 +115,7 @@ const AdBlockRule* AdBlockSearchTree::prefixSearch(const QNetworkRequest &reques
         node = node->children[c];
     }
 
-    if (node->rule && node->rule->networkMatch(request, domain, urlString)) {
+    if (node->rule && node->rule->networkMatch(request, info, urlString)) {
         return node->rule;
     }
 
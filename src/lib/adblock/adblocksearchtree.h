@@ -25,6 +25,8 @@
 
 class QNetworkRequest;
 
+class RequestInfo;
+
 class AdBlockRule;
 
 class QUPZILLA_EXPORT AdBlockSearchTree
@@ -36,7 +38,7 @@ public:
     void clear();
 
     bool add(const AdBlockRule* rule);
-    const AdBlockRule* find(const QNetworkRequest &request, const QString &domain, const QString &urlString) const;
+    const AdBlockRule* find(const QNetworkRequest &request, const RequestInfo &info, const QString &urlString) const;
 
 private:
     struct Node {
@@ -47,7 +49,7 @@ private:
         Node() : c(0) , rule(0) { }
     };
 
-    const AdBlockRule* prefixSearch(const QNetworkRequest &request, const QString &domain,
+    const AdBlockRule* prefixSearch(const QNetworkRequest &request, const RequestInfo &info,
                                     const QString &urlString, const QChar* string, int len) const;
 
     void deleteNode(Node* node);
@@ -202,30 +202,30 @@ void AdBlockSubscription::saveDownloadedData(const QByteArray &data)
     file.close();
 }
 
-const AdBlockRule* AdBlockSubscription::match(const QNetworkRequest &request, const QString &urlDomain, const QString &urlString) const
+const AdBlockRule* AdBlockSubscription::match(const QNetworkRequest &request, const RequestInfo &info, const QString &urlString) const
 {
     // Exception rules
-    if (m_networkExceptionTree.find(request, urlDomain, urlString)) {
+    if (m_networkExceptionTree.find(request, info, urlString)) {
         return 0;
     }
 
     int count = m_networkExceptionRules.count();
     for (int i = 0; i < count; ++i) {
         const AdBlockRule* rule = m_networkExceptionRules.at(i);
-        if (rule->networkMatch(request, urlDomain, urlString)) {
+        if (rule->networkMatch(request, info, urlString)) {
             return 0;
         }
     }
 
     // Block rules
-    if (const AdBlockRule* rule = m_networkBlockTree.find(request, urlDomain, urlString)) {
+    if (const AdBlockRule* rule = m_networkBlockTree.find(request, info, urlString)) {
         return rule;
     }
 
     count = m_networkBlockRules.count();
     for (int i = 0; i < count; ++i) {
         const AdBlockRule* rule = m_networkBlockRules.at(i);
-        if (rule->networkMatch(request, urlDomain, urlString)) {
+        if (rule->networkMatch(request, info, urlString)) {
             return rule;
         }
     }
@@ -58,6 +58,7 @@ class QNetworkReply;
 class QUrl;
 
 class FollowRedirectReply;
+class RequestInfo;
 
 class QUPZILLA_EXPORT AdBlockSubscription : public QObject
 {
@@ -77,7 +78,7 @@ public:
     virtual void loadSubscription(const QStringList &disabledRules);
     virtual void saveSubscription();
 
-    const AdBlockRule* match(const QNetworkRequest &request, const QString &urlDomain, const QString &urlString) const;
+    const AdBlockRule* match(const QNetworkRequest &request, const RequestInfo &info, const QString &urlString) const;
 
     bool adBlockDisabledForUrl(const QUrl &url) const;
     bool elemHideDisabledForUrl(const QUrl &url) const;
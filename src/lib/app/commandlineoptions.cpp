@@ -46,6 +46,7 @@ void CommandLineOptions::showHelp()
                        "    -p=PROFILE or --profile=PROFILE     start with specified profile \n"
                        "    -ne or --no-extensions              start without extensions\n"
                        "    -po or --portable                   start in portable mode\n"
+                       "    -st or --startup-timeline           print duration of startup phases\n"
                        "\n"
                        " Options to control running QupZilla:\n"
                        "    -nt or --new-tab                    open new tab\n"
@@ -164,6 +165,12 @@ void CommandLineOptions::parseActions()
             m_actions.append(pair);
         }
 
+        if (arg.startsWith(QLatin1String("-st")) || arg.startsWith(QLatin1String("--startup-timeline"))) {
+            ActionPair pair;
+            pair.action = Qz::CL_StartupTimeline;
+            m_actions.append(pair);
+        }
+
         if (arg.startsWith(QLatin1String("-fs")) || arg.startsWith(QLatin1String("--fullscreen"))) {
             ActionPair pair;
             pair.action = Qz::CL_ToggleFullScreen;
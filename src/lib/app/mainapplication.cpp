@@ -30,6 +30,7 @@
 #include "bookmarks.h"
 #include "qzsettings.h"
 #include "rssmanager.h"
+#include "rssupdater.h"
 #include "proxystyle.h"
 #include "pluginproxy.h"
 #include "sqldatabase.h"
@@ -37,6 +38,7 @@
 #include "browserwindow.h"
 #include "cookiemanager.h"
 #include "networkmanager.h"
+#include "networkcache.h"
 #include "checkboxdialog.h"
 #include "profilemanager.h"
 #include "adblockmanager.h"
@@ -46,12 +48,12 @@
 #include "clearprivatedata.h"
 #include "useragentmanager.h"
 #include "commandlineoptions.h"
+#include "startuptimeline.h"
 #include "webhistoryinterface.h"
 #include "searchenginesmanager.h"
 #include "desktopnotificationsfactory.h"
 #include "html5permissions/html5permissionsmanager.h"
 
-#include <QNetworkDiskCache>
 #include <QDesktopServices>
 #include <QSqlDatabase>
 #include <QTranslator>
@@ -63,14 +65,28 @@
 
 #if QT_VERSION < 0x050000
 #include "qwebkitversion.h"
+#include <QtConcurrentRun>
 #else
 #include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
 #endif
 
 #if defined(Q_OS_WIN) && !defined(Q_OS_OS2)
 #include "registerqappassociation.h"
 #endif
 
+static QVariant parseBookmarksFile()
+{
+    StartupTimeline::Scope scope(QSL("bookmarks file"));
+    return Bookmarks::parseBookmarksFile();
+}
+
+static QByteArray readSessionFile()
+{
+    StartupTimeline::Scope scope(QSL("session file"));
+    return RestoreManager::readSessionFile();
+}
+
 MainApplication::MainApplication(int &argc, char** argv)
     : QtSingleApplication(argc, argv)
     , m_isPrivate(false)
@@ -86,6 +102,7 @@ MainApplication::MainApplication(int &argc, char** argv)
     , m_networkCache(0)
     , m_browsingLibrary(0)
     , m_rssManager(0)
+    , m_rssUpdater(0)
     , m_cookieManager(0)
     , m_networkManager(0)
     , m_restoreManager(0)
@@ -96,6 +113,7 @@ MainApplication::MainApplication(int &argc, char** argv)
     , m_desktopNotifications(0)
     , m_autoSaver(0)
     , m_proxyStyle(0)
+    , m_printStartupTimeline(false)
 #if defined(Q_OS_WIN) && !defined(Q_OS_OS2)
     , m_registerQAppAssociation(0)
 #endif
@@ -104,6 +122,8 @@ MainApplication::MainApplication(int &argc, char** argv)
     , m_macDockMenu(0)
 #endif
 {
+    StartupTimeline::start();
+
     setApplicationName(QLatin1String("QupZilla"));
     setApplicationVersion(Qz::VERSION);
     setOrganizationDomain(QLatin1String("qupzilla"));
@@ -151,6 +171,9 @@ MainApplication::MainApplication(int &argc, char** argv)
             case Qz::CL_StartNewInstance:
                 newInstance = true;
                 break;
+            case Qz::CL_StartupTimeline:
+                m_printStartupTimeline = true;
+                break;
             case Qz::CL_OpenUrlInCurrentTab:
                 startUrl = QUrl::fromUserInput(pair.text);
                 messages.append("ACTION:OpenUrlInCurrentTab" + pair.text);
@@ -221,35 +244,70 @@ MainApplication::MainApplication(int &argc, char** argv)
     QDesktopServices::setUrlHandler("http", this, "addNewTab");
     QDesktopServices::setUrlHandler("ftp", this, "addNewTab");
 
-    ProfileManager profileManager;
-    profileManager.initConfigDir();
-    profileManager.initCurrentProfile(startProfile);
+    {
+        StartupTimeline::Scope scope(QSL("profile"));
 
-    Settings::createSettings(DataPaths::currentProfilePath() + QLatin1String("/settings.ini"));
+        ProfileManager profileManager;
+        profileManager.initConfigDir();
+        profileManager.initCurrentProfile(startProfile);
+
+        Settings::createSettings(DataPaths::currentProfilePath() + QLatin1String("/settings.ini"));
+    }
+
+    bool shouldRestoreSession = false;
+
+    if (!isPrivate()) {
+        Settings settings;
+        m_isStartingAfterCrash = settings.value("SessionRestore/isRunning", false).toBool();
+        int afterLaunch = settings.value("Web-URL-Settings/afterLaunch", 3).toInt();
+        settings.setValue("SessionRestore/isRunning", true);
+
+        shouldRestoreSession = m_isStartingAfterCrash || afterLaunch == 3;
+    }
+
+    // Files independent on the rest of startup are read in background
+    m_bookmarksData = QtConcurrent::run(parseBookmarksFile);
+
+    if (!isPrivate()) {
+        m_sessionBackup = QtConcurrent::run(this, &MainApplication::backupSavedSessions);
+
+        if (shouldRestoreSession) {
+            m_sessionData = QtConcurrent::run(readSessionFile);
+        }
+    }
 
     m_autoSaver = new AutoSaver(this);
     connect(m_autoSaver, SIGNAL(save()), this, SLOT(saveSession()));
 
-    translateApp();
+    {
+        StartupTimeline::Scope scope(QSL("translations"));
+        translateApp();
+    }
 
-    BrowserWindow* window = createWindow(Qz::BW_FirstAppWindow, startUrl);
-    connect(window, SIGNAL(startingCompleted()), this, SLOT(restoreOverrideCursor()));
+    BrowserWindow* window;
+    {
+        StartupTimeline::Scope scope(QSL("first window"));
+        window = createWindow(Qz::BW_FirstAppWindow, startUrl);
+        connect(window, SIGNAL(startingCompleted()), this, SLOT(restoreOverrideCursor()));
+    }
 
-    loadSettings();
+    {
+        StartupTimeline::Scope scope(QSL("settings"));
+        loadSettings();
+    }
 
-    m_plugins = new PluginProxy;
+    {
+        StartupTimeline::Scope scope(QSL("plugins"));
+        m_plugins = new PluginProxy;
 
-    if (!noAddons) {
-        m_plugins->loadPlugins();
+        if (!noAddons) {
+            m_plugins->loadPlugins();
+        }
     }
 
     if (!isPrivate()) {
-        Settings settings;
-        m_isStartingAfterCrash = settings.value("SessionRestore/isRunning", false).toBool();
-        int afterLaunch = settings.value("Web-URL-Settings/afterLaunch", 3).toInt();
-        settings.setValue("SessionRestore/isRunning", true);
-
 #ifndef DISABLE_UPDATES_CHECK
+        Settings settings;
         bool checkUpdates = settings.value("Web-Browser-Settings/CheckUpdates", DEFAULT_CHECK_UPDATES).toBool();
 
         if (checkUpdates) {
@@ -257,10 +315,10 @@ MainApplication::MainApplication(int &argc, char** argv)
         }
 #endif
 
-        backupSavedSessions();
+        if (shouldRestoreSession) {
+            StartupTimeline::Scope scope(QSL("session"));
 
-        if (m_isStartingAfterCrash || afterLaunch == 3) {
-            m_restoreManager = new RestoreManager();
+            m_restoreManager = new RestoreManager(m_sessionData.result());
             if (!m_restoreManager->isValid()) {
                 destroyRestoreManager();
             }
@@ -448,7 +506,11 @@ History* MainApplication::history()
 Bookmarks* MainApplication::bookmarks()
 {
     if (!m_bookmarks) {
-        m_bookmarks = new Bookmarks(this);
+        // Bookmarks file is parsed in background on startup
+        const QVariant data = m_bookmarksData.isCanceled() ? QVariant() : m_bookmarksData.result();
+        m_bookmarksData = QFuture<QVariant>();
+
+        m_bookmarks = new Bookmarks(this, data);
     }
     return m_bookmarks;
 }
@@ -474,7 +536,7 @@ PluginProxy* MainApplication::plugins()
     return m_plugins;
 }
 
-QNetworkDiskCache* MainApplication::networkCache()
+NetworkCache* MainApplication::networkCache()
 {
     if (!m_networkCache) {
         Settings settings;
@@ -482,7 +544,7 @@ QNetworkDiskCache* MainApplication::networkCache()
         const QString basePath = settings.value("Web-Browser-Settings/CachePath", defaultBasePath).toString();
         const QString cachePath = QString("%1/%2-Qt%3/").arg(basePath, qWebKitVersion(), qVersion());
 
-        m_networkCache = new QNetworkDiskCache(this);
+        m_networkCache = new NetworkCache(this);
         m_networkCache->setCacheDirectory(cachePath);
     }
 
@@ -505,6 +567,14 @@ RSSManager* MainApplication::rssManager()
     return m_rssManager;
 }
 
+RSSUpdater* MainApplication::rssUpdater()
+{
+    if (!m_rssUpdater) {
+        m_rssUpdater = new RSSUpdater(this);
+    }
+    return m_rssUpdater;
+}
+
 CookieManager* MainApplication::cookieManager()
 {
     if (!m_cookieManager) {
@@ -649,6 +719,19 @@ void MainApplication::quitApplication()
 
 void MainApplication::postLaunch()
 {
+    StartupTimeline::mark(QSL("event loop"));
+
+    // Load subsystems needed by first page load before it needs them
+    {
+        StartupTimeline::Scope scope(QSL("bookmarks"));
+        bookmarks();
+    }
+
+    {
+        StartupTimeline::Scope scope(QSL("history"));
+        history();
+    }
+
     if (m_postLaunchActions.contains(OpenDownloadManager)) {
         downloadManager()->show();
     }
@@ -667,8 +750,22 @@ void MainApplication::postLaunch()
     connect(this, SIGNAL(messageReceived(QString)), this, SLOT(messageReceived(QString)));
     connect(this, SIGNAL(aboutToQuit()), this, SLOT(saveSettings()));
 
+    // Feeds are updated in background
+    if (!isPrivate()) {
+        rssUpdater();
+    }
+
     checkDefaultWebBrowser();
     QtWin::createJumpList();
+
+    StartupTimeline::mark(QSL("startup finished"));
+
+    if (m_printStartupTimeline) {
+        m_sessionBackup.waitForFinished();
+
+        std::cout << "QupZilla: Startup timeline (ms)" << std::endl;
+        std::cout << qPrintable(StartupTimeline::toString()) << std::flush;
+    }
 }
 
 void MainApplication::saveSession()
@@ -698,6 +795,9 @@ void MainApplication::saveSession()
         qupzilla_->tabWidget()->savePinnedTabs();
     }
 
+    // Backup of previous session may still be running
+    m_sessionBackup.waitForFinished();
+
     QFile file(DataPaths::currentProfilePath() + QLatin1String("/session.dat"));
     file.open(QIODevice::WriteOnly);
     file.write(data);
@@ -883,6 +983,10 @@ void MainApplication::loadSettings()
         m_downloadManager->loadSettings();
     }
 
+    if (m_rssUpdater) {
+        m_rssUpdater->loadSettings();
+    }
+
     qzSettings->loadSettings();
     userAgentManager()->loadSettings();
 }
@@ -976,6 +1080,8 @@ void MainApplication::translateApp()
 
 void MainApplication::backupSavedSessions()
 {
+    StartupTimeline::Scope scope(QSL("session backup"));
+
     // session.dat      - current
     // session.dat.old  - first backup
     // session.dat.old1 - second backup
@@ -21,13 +21,14 @@
 #define mApp MainApplication::instance()
 
 #include <QList>
+#include <QFuture>
+#include <QVariant>
 
 #include "qtsingleapplication.h"
 #include "restoremanager.h"
 #include "qzcommon.h"
 
 class QMenu;
-class QNetworkDiskCache;
 
 class History;
 class AutoFill;
@@ -35,8 +36,10 @@ class Bookmarks;
 class CookieJar;
 class AutoSaver;
 class RSSManager;
+class RSSUpdater;
 class ProxyStyle;
 class PluginProxy;
+class NetworkCache;
 class CookieManager;
 class BrowserWindow;
 class NetworkManager;
@@ -92,10 +95,11 @@ public:
     AutoFill* autoFill();
     CookieJar* cookieJar();
     PluginProxy* plugins();
-    QNetworkDiskCache* networkCache();
+    NetworkCache* networkCache();
     BrowsingLibrary* browsingLibrary();
 
     RSSManager* rssManager();
+    RSSUpdater* rssUpdater();
     CookieManager* cookieManager();
     NetworkManager* networkManager();
     RestoreManager* restoreManager();
@@ -157,10 +161,11 @@ private:
     AutoFill* m_autoFill;
     CookieJar* m_cookieJar;
     PluginProxy* m_plugins;
-    QNetworkDiskCache* m_networkCache;
+    NetworkCache* m_networkCache;
     BrowsingLibrary* m_browsingLibrary;
 
     RSSManager* m_rssManager;
+    RSSUpdater* m_rssUpdater;
     CookieManager* m_cookieManager;
     NetworkManager* m_networkManager;
     RestoreManager* m_restoreManager;
@@ -178,6 +183,12 @@ private:
 
     QString m_languageFile;
 
+    // Startup tasks running in background while the first window is created
+    QFuture<void> m_sessionBackup;
+    QFuture<QByteArray> m_sessionData;
+    QFuture<QVariant> m_bookmarksData;
+    bool m_printStartupTimeline;
+
 #if defined(Q_OS_WIN) && !defined(Q_OS_OS2)
 public:
     RegisterQAppAssociation* associationManager();
@@ -87,6 +87,7 @@ enum CommandLineAction {
     CL_StartPrivateBrowsing,
     CL_StartNewInstance,
     CL_StartPortable,
+    CL_StartupTimeline,
     CL_ExitAction
 };
 
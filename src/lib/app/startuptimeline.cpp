@@ -0,0 +1,96 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "startuptimeline.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+
+Q_GLOBAL_STATIC(QMutex, s_mutex)
+static QElapsedTimer s_timer;
+static QList<StartupTimeline::Phase> s_phases;
+
+StartupTimeline::Scope::Scope(const QString &name)
+    : m_name(name)
+    , m_start(StartupTimeline::elapsed())
+{
+}
+
+StartupTimeline::Scope::~Scope()
+{
+    StartupTimeline::addPhase(m_name, m_start, StartupTimeline::elapsed() - m_start);
+}
+
+void StartupTimeline::start()
+{
+    QMutexLocker locker(s_mutex());
+
+    s_timer.start();
+    s_phases.clear();
+}
+
+qint64 StartupTimeline::elapsed()
+{
+    QMutexLocker locker(s_mutex());
+
+    return s_timer.isValid() ? s_timer.elapsed() : 0;
+}
+
+void StartupTimeline::addPhase(const QString &name, qint64 start, qint64 duration)
+{
+    Phase phase;
+    phase.name = name;
+    phase.start = start;
+    phase.duration = duration;
+    phase.mainThread = !QCoreApplication::instance() || QThread::currentThread() == QCoreApplication::instance()->thread();
+
+    QMutexLocker locker(s_mutex());
+    s_phases.append(phase);
+}
+
+void StartupTimeline::mark(const QString &name)
+{
+    addPhase(name, elapsed(), 0);
+}
+
+static bool phaseStartsBefore(const StartupTimeline::Phase &p1, const StartupTimeline::Phase &p2)
+{
+    return p1.start < p2.start;
+}
+
+QList<StartupTimeline::Phase> StartupTimeline::phases()
+{
+    QMutexLocker locker(s_mutex());
+
+    QList<Phase> list = s_phases;
+    qStableSort(list.begin(), list.end(), phaseStartsBefore);
+    return list;
+}
+
+QString StartupTimeline::toString()
+{
+    QString out = QLatin1String("   start  duration  thread      phase\n");
+
+    foreach (const Phase &phase, phases()) {
+        out += QString("%1 %2  %3  %4\n").arg(phase.start, 8).arg(phase.duration, 9)
+               .arg(phase.mainThread ? QLatin1String("main      ") : QLatin1String("background"), phase.name);
+    }
+
+    return out;
+}
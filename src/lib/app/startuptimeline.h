@@ -0,0 +1,61 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QString>
+#include <QList>
+
+#include "qzcommon.h"
+
+// Records duration of individual startup phases, it can be used from any thread
+class QUPZILLA_EXPORT StartupTimeline
+{
+public:
+    struct Phase {
+        QString name;
+        // Milliseconds since start()
+        qint64 start;
+        qint64 duration;
+        bool mainThread;
+    };
+
+    // Records the phase from construction to destruction
+    class Scope
+    {
+    public:
+        explicit Scope(const QString &name);
+        ~Scope();
+
+    private:
+        QString m_name;
+        qint64 m_start;
+    };
+
+    static void start();
+    static qint64 elapsed();
+
+    static void addPhase(const QString &name, qint64 start, qint64 duration);
+    // Phase with zero duration
+    static void mark(const QString &name);
+
+    static QList<Phase> phases();
+    static QString toString();
+};
+
+#endif // STARTUPTIMELINE_H
@@ -206,9 +206,8 @@ void AutoFill::post(const QNetworkRequest &request, const QByteArray &outgoingDa
         return;
     }
 
-    QVariant v = request.attribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100));
-    WebPage* webPage = static_cast<WebPage*>(v.value<void*>());
-    if (!WebPage::isPointerSafeToUse(webPage)) {
+    WebPage* webPage = WebPage::fromRequest(request);
+    if (!webPage) {
         return;
     }
     WebView* webView = qobject_cast<WebView*>(webPage->view());
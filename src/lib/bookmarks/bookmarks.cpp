@@ -27,14 +27,117 @@
 
 #include <QFile>
 
-Bookmarks::Bookmarks(QObject* parent)
+static QString urlKey(const QUrl &url)
+{
+    return QString::fromUtf8(url.toEncoded());
+}
+
+// Lowercased words of title
+static QStringList titleTokens(const QString &title)
+{
+    QStringList tokens;
+    QString token;
+
+    for (int i = 0; i < title.size(); ++i) {
+        const QChar c = title.at(i);
+
+        if (c.isLetterOrNumber()) {
+            token.append(c.toLower());
+        }
+        else if (!token.isEmpty()) {
+            tokens.append(token);
+            token.clear();
+        }
+    }
+
+    if (!token.isEmpty()) {
+        tokens.append(token);
+    }
+
+    tokens.removeDuplicates();
+    return tokens;
+}
+
+static bool entryMatches(const BookmarksSnapshot::Entry &entry, const QString &string, Qt::CaseSensitivity sensitive)
+{
+    return entry.title.contains(string, sensitive) ||
+           entry.urlString.contains(string, sensitive) ||
+           entry.description.contains(string, sensitive) ||
+           entry.keyword.compare(string, sensitive) == 0;
+}
+
+int BookmarksSnapshot::count() const
+{
+    return m_entries.count();
+}
+
+bool BookmarksSnapshot::isBookmarked(const QUrl &url) const
+{
+    return m_urlIndex.contains(urlKey(url));
+}
+
+QVector<BookmarksSnapshot::Entry> BookmarksSnapshot::search(const QString &string, int limit, Qt::CaseSensitivity sensitive) const
+{
+    QVector<Entry> result;
+    QVector<bool> found(m_entries.count(), false);
+
+    if (limit == 0) {
+        return result;
+    }
+
+    // Entries found through indexes are always matching
+    if (sensitive == Qt::CaseInsensitive && !string.isEmpty()) {
+        const QString needle = string.toLower();
+        QList<int> positions;
+
+        foreach (BookmarkItem* item, m_keywordIndex.values(needle)) {
+            positions.append(m_positions.value(item));
+        }
+
+        QMultiMap<QString, BookmarkItem*>::const_iterator it = m_tokenIndex.lowerBound(needle);
+        for (; it != m_tokenIndex.constEnd() && it.key().startsWith(needle); ++it) {
+            positions.append(m_positions.value(it.value()));
+        }
+
+        qSort(positions);
+
+        foreach (int pos, positions) {
+            if (found.at(pos)) {
+                continue;
+            }
+
+            found[pos] = true;
+            result.append(m_entries.at(pos));
+
+            if (result.count() == limit) {
+                return result;
+            }
+        }
+    }
+
+    for (int i = 0; i < m_entries.count(); ++i) {
+        if (found.at(i) || !entryMatches(m_entries.at(i), string, sensitive)) {
+            continue;
+        }
+
+        result.append(m_entries.at(i));
+
+        if (result.count() == limit) {
+            break;
+        }
+    }
+
+    return result;
+}
+
+Bookmarks::Bookmarks(QObject* parent, const QVariant &bookmarksData)
     : QObject(parent)
     , m_autoSaver(0)
 {
     m_autoSaver = new AutoSaver(this);
     connect(m_autoSaver, SIGNAL(save()), this, SLOT(saveSettings()));
 
-    init();
+    init(bookmarksData);
     loadSettings();
 }
 
@@ -89,7 +192,7 @@ BookmarksModel* Bookmarks::model() const
 
 bool Bookmarks::isBookmarked(const QUrl &url)
 {
-    return !searchBookmarks(url).isEmpty();
+    return m_urlIndex.contains(urlKey(url));
 }
 
 bool Bookmarks::canBeModified(BookmarkItem* item) const
@@ -104,15 +207,17 @@ bool Bookmarks::canBeModified(BookmarkItem* item) const
 
 QList<BookmarkItem*> Bookmarks::searchBookmarks(const QUrl &url) const
 {
-    QList<BookmarkItem*> items;
-    search(&items, m_root, url);
-    return items;
+    return m_urlIndex.values(urlKey(url));
 }
 
 QList<BookmarkItem*> Bookmarks::searchBookmarks(const QString &string, int limit, Qt::CaseSensitivity sensitive) const
 {
     QList<BookmarkItem*> items;
-    search(&items, m_root, string, limit, sensitive);
+
+    foreach (const BookmarksSnapshot::Entry &entry, snapshot()->search(string, limit, sensitive)) {
+        items.append(entry.item);
+    }
+
     return items;
 }
 
@@ -135,6 +240,10 @@ void Bookmarks::insertBookmark(BookmarkItem* parent, int row, BookmarkItem* item
 
     m_lastFolder = parent;
     m_model->addBookmark(parent, row, item);
+
+    indexBookmark(item);
+    invalidateSnapshot();
+
     emit bookmarkAdded(item);
 
     m_autoSaver->changeOcurred();
@@ -147,6 +256,10 @@ bool Bookmarks::removeBookmark(BookmarkItem* item)
     }
 
     m_model->removeBookmark(item);
+
+    unindexBookmark(item);
+    invalidateSnapshot();
+
     emit bookmarkRemoved(item);
 
     m_autoSaver->changeOcurred();
@@ -156,11 +269,35 @@ bool Bookmarks::removeBookmark(BookmarkItem* item)
 void Bookmarks::changeBookmark(BookmarkItem* item)
 {
     Q_ASSERT(item);
+
+    unindexBookmark(item, false);
+    indexBookmark(item, false);
+    invalidateSnapshot();
+
     emit bookmarkChanged(item);
 
     m_autoSaver->changeOcurred();
 }
 
+QSharedPointer<const BookmarksSnapshot> Bookmarks::snapshot() const
+{
+    if (m_snapshot) {
+        return m_snapshot;
+    }
+
+    BookmarksSnapshot* snapshot = new BookmarksSnapshot;
+    snapshot->m_entries.reserve(m_indexKeys.count());
+    addSnapshotEntries(snapshot, m_root);
+
+    // Indexes are implicitly shared with the snapshot
+    snapshot->m_urlIndex = m_urlIndex;
+    snapshot->m_keywordIndex = m_keywordIndex;
+    snapshot->m_tokenIndex = m_tokenIndex;
+
+    m_snapshot = QSharedPointer<const BookmarksSnapshot>(snapshot);
+    return m_snapshot;
+}
+
 void Bookmarks::setShowOnlyIconsInToolbar(bool state)
 {
     m_showOnlyIconsInToolbar = state;
@@ -177,7 +314,24 @@ void Bookmarks::saveSettings()
     saveBookmarks();
 }
 
-void Bookmarks::init()
+QVariant Bookmarks::parseBookmarksFile()
+{
+    QFile file(DataPaths::currentProfilePath() + QLatin1String("/bookmarks.json"));
+    file.open(QFile::ReadOnly);
+    QByteArray data = file.readAll();
+    file.close();
+
+    Json json;
+    const QVariant res = json.parse(QString::fromUtf8(data));
+
+    if (!json.ok() || res.type() != QVariant::Map) {
+        return QVariant();
+    }
+
+    return res;
+}
+
+void Bookmarks::init(const QVariant &bookmarksData)
 {
     m_root = new BookmarkItem(BookmarkItem::Root);
 
@@ -199,27 +353,23 @@ void Bookmarks::init()
     }
     else {
         // Bookmarks don't need to be migrated, just load them as usual
-        loadBookmarks();
+        loadBookmarks(bookmarksData);
     }
 
     m_lastFolder = m_folderUnsorted;
     m_model = new BookmarksModel(m_root, this, this);
+
+    indexBookmark(m_root);
 }
 
-void Bookmarks::loadBookmarks()
+void Bookmarks::loadBookmarks(const QVariant &bookmarksData)
 {
     const QString bookmarksFile = DataPaths::currentProfilePath() + QLatin1String("/bookmarks.json");
     const QString backupFile = bookmarksFile + QLatin1String(".old");
 
-    QFile file(bookmarksFile);
-    file.open(QFile::ReadOnly);
-    QByteArray data = file.readAll();
-    file.close();
+    const QVariant res = bookmarksData.isValid() ? bookmarksData : parseBookmarksFile();
 
-    Json json;
-    const QVariant res = json.parse(QString::fromUtf8(data));
-
-    if (!json.ok() || res.type() != QVariant::Map) {
+    if (!res.isValid()) {
         qWarning() << "Bookmarks::init() Error parsing bookmarks! Using default bookmarks!";
         qWarning() << "Bookmarks::init() Your bookmarks have been backed up in" << backupFile;
 
@@ -228,6 +378,7 @@ void Bookmarks::loadBookmarks()
         QFile::copy(bookmarksFile, backupFile);
 
         // Load default bookmarks
+        Json json;
         const QVariant data = json.parse(QzTools::readAllFileContents(":data/bookmarks.json"));
 
         Q_ASSERT(json.ok());
@@ -377,55 +528,91 @@ QVariantList Bookmarks::writeBookmarks(BookmarkItem* parent)
     return list;
 }
 
-void Bookmarks::search(QList<BookmarkItem*>* items, BookmarkItem* parent, const QUrl &url) const
+void Bookmarks::indexBookmark(BookmarkItem* item, bool recursive)
 {
-    Q_ASSERT(items);
-    Q_ASSERT(parent);
+    Q_ASSERT(item);
 
-    switch (parent->type()) {
-    case BookmarkItem::Root:
-    case BookmarkItem::Folder:
-        foreach (BookmarkItem* child, parent->children()) {
-            search(items, child, url);
+    if (item->isUrl()) {
+        IndexKeys keys;
+        keys.url = urlKey(item->url());
+        keys.keyword = item->keyword().toLower();
+        keys.tokens = titleTokens(item->title());
+
+        m_urlIndex.insert(keys.url, item);
+
+        if (!keys.keyword.isEmpty()) {
+            m_keywordIndex.insert(keys.keyword, item);
         }
-        break;
 
-    case BookmarkItem::Url:
-        if (parent->url() == url) {
-            items->append(parent);
+        foreach (const QString &token, keys.tokens) {
+            m_tokenIndex.insert(token, item);
         }
-        break;
 
-    default:
-        break;
+        m_indexKeys.insert(item, keys);
+    }
+
+    if (recursive) {
+        foreach (BookmarkItem* child, item->children()) {
+            indexBookmark(child);
+        }
     }
 }
 
-void Bookmarks::search(QList<BookmarkItem*>* items, BookmarkItem* parent, const QString &string, int limit, Qt::CaseSensitivity sensitive) const
+void Bookmarks::unindexBookmark(BookmarkItem* item, bool recursive)
 {
-    Q_ASSERT(items);
-    Q_ASSERT(parent);
+    Q_ASSERT(item);
 
-    if (limit == items->count()) {
-        return;
+    if (m_indexKeys.contains(item)) {
+        const IndexKeys keys = m_indexKeys.take(item);
+
+        m_urlIndex.remove(keys.url, item);
+        m_keywordIndex.remove(keys.keyword, item);
+
+        foreach (const QString &token, keys.tokens) {
+            m_tokenIndex.remove(token, item);
+        }
+    }
+
+    if (recursive) {
+        foreach (BookmarkItem* child, item->children()) {
+            unindexBookmark(child);
+        }
     }
+}
+
+void Bookmarks::invalidateSnapshot()
+{
+    // Snapshots already handed out stay valid, next call of snapshot() builds new one
+    m_snapshot.clear();
+}
+
+void Bookmarks::addSnapshotEntries(BookmarksSnapshot* snapshot, BookmarkItem* parent) const
+{
+    Q_ASSERT(snapshot);
+    Q_ASSERT(parent);
 
     switch (parent->type()) {
     case BookmarkItem::Root:
     case BookmarkItem::Folder:
         foreach (BookmarkItem* child, parent->children()) {
-            search(items, child, string, limit, sensitive);
+            addSnapshotEntries(snapshot, child);
         }
         break;
 
-    case BookmarkItem::Url:
-        if (parent->title().contains(string, sensitive) ||
-                parent->urlString().contains(string, sensitive) ||
-                parent->description().contains(string, sensitive) ||
-                parent->keyword().compare(string, sensitive) == 0) {
-            items->append(parent);
-        }
+    case BookmarkItem::Url: {
+        BookmarksSnapshot::Entry entry;
+        entry.item = parent;
+        entry.url = parent->url();
+        entry.urlString = parent->urlString();
+        entry.title = parent->title();
+        entry.description = parent->description();
+        entry.keyword = parent->keyword();
+        entry.visitCount = parent->visitCount();
+
+        snapshot->m_positions.insert(parent, snapshot->m_entries.count());
+        snapshot->m_entries.append(entry);
         break;
+    }
 
     default:
         break;
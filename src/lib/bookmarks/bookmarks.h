@@ -20,22 +20,62 @@
 
 #include <QObject>
 #include <QVariant>
+#include <QVector>
+#include <QMultiHash>
+#include <QMultiMap>
+#include <QSharedPointer>
+#include <QUrl>
 
 #include "qzcommon.h"
 
-class QUrl;
-
 class BookmarkItem;
 class BookmarksModel;
 class AutoSaver;
 
+// Immutable copy of all url bookmarks, it is safe to use from any thread
+class QUPZILLA_EXPORT BookmarksSnapshot
+{
+public:
+    struct Entry {
+        // Must be dereferenced only in main thread
+        BookmarkItem* item;
+
+        QUrl url;
+        QString urlString;
+        QString title;
+        QString description;
+        QString keyword;
+        int visitCount;
+    };
+
+    int count() const;
+    bool isBookmarked(const QUrl &url) const;
+
+    // Same matching as Bookmarks::searchBookmarks(QString), entries with a word
+    // in title starting with string (or matching keyword) are returned first
+    QVector<Entry> search(const QString &string, int limit = -1, Qt::CaseSensitivity sensitive = Qt::CaseInsensitive) const;
+
+private:
+    friend class Bookmarks;
+
+    QVector<Entry> m_entries;
+    QHash<BookmarkItem*, int> m_positions;
+    QMultiHash<QString, BookmarkItem*> m_urlIndex;
+    QMultiHash<QString, BookmarkItem*> m_keywordIndex;
+    QMultiMap<QString, BookmarkItem*> m_tokenIndex;
+};
+
 class QUPZILLA_EXPORT Bookmarks : public QObject
 {
     Q_OBJECT
 public:
-    explicit Bookmarks(QObject* parent = 0);
+    // bookmarksData is result of parseBookmarksFile() if it was already called
+    explicit Bookmarks(QObject* parent = 0, const QVariant &bookmarksData = QVariant());
     ~Bookmarks();
 
+    // Reads and parses bookmarks file of current profile, can be called from any thread
+    static QVariant parseBookmarksFile();
+
     void loadSettings();
 
     bool showOnlyIconsInToolbar() const;
@@ -61,6 +101,10 @@ public:
     bool removeBookmark(BookmarkItem* item);
     void changeBookmark(BookmarkItem* item);
 
+    // Snapshot is rebuilt on first call after a change, it must be called from
+    // the main thread but the returned snapshot can be used from other threads
+    QSharedPointer<const BookmarksSnapshot> snapshot() const;
+
 public slots:
     void setShowOnlyIconsInToolbar(bool state);
 
@@ -78,16 +122,24 @@ private slots:
     void saveSettings();
 
 private:
-    void init();
-    void loadBookmarks();
+    void init(const QVariant &bookmarksData);
+    void loadBookmarks(const QVariant &bookmarksData);
     void saveBookmarks();
 
     void loadBookmarksFromMap(const QVariantMap &map);
     void readBookmarks(const QVariantList &list, BookmarkItem* parent);
     QVariantList writeBookmarks(BookmarkItem* parent);
 
-    void search(QList<BookmarkItem*>* items, BookmarkItem* parent, const QUrl &url) const;
-    void search(QList<BookmarkItem*>* items, BookmarkItem* parent, const QString &string, int limit, Qt::CaseSensitivity sensitive) const;
+    void indexBookmark(BookmarkItem* item, bool recursive = true);
+    void unindexBookmark(BookmarkItem* item, bool recursive = true);
+    void invalidateSnapshot();
+    void addSnapshotEntries(BookmarksSnapshot* snapshot, BookmarkItem* parent) const;
+
+    struct IndexKeys {
+        QString url;
+        QString keyword;
+        QStringList tokens;
+    };
 
     BookmarkItem* m_root;
     BookmarkItem* m_folderToolbar;
@@ -99,6 +151,14 @@ private:
     AutoSaver* m_autoSaver;
 
     bool m_showOnlyIconsInToolbar;
+
+    // Indexes of url bookmarks, updated with every change
+    QMultiHash<QString, BookmarkItem*> m_urlIndex;
+    QMultiHash<QString, BookmarkItem*> m_keywordIndex;
+    QMultiMap<QString, BookmarkItem*> m_tokenIndex;
+    QHash<BookmarkItem*, IndexKeys> m_indexKeys;
+
+    mutable QSharedPointer<const BookmarksSnapshot> m_snapshot;
 };
 
 #endif // BOOKMARKS_H
@@ -29,7 +29,6 @@
 #include "qzregexp.h"
 
 #include <QFileIconProvider>
-#include <QListWidgetItem>
 #include <QTemporaryFile>
 #include <QWebHistory>
 #include <QFileDialog>
@@ -50,7 +49,6 @@ DownloadFileHelper::DownloadFileHelper(const QString &lastDownloadPath, const QS
     , m_reply(0)
     , m_fileSize(0)
     , m_openFileChoosed(false)
-    , m_listWidget(0)
     , m_iconProvider(new QFileIconProvider)
     , m_manager(0)
 {
@@ -294,11 +292,11 @@ void DownloadFileHelper::fileNameChoosed(const QString &name, bool fileNameAutoG
     settings.endGroup();
     m_manager->setLastDownloadPath(m_lastDownloadPath);
 
-    QListWidgetItem* item = new QListWidgetItem(m_listWidget);
-    DownloadItem* downItem = new DownloadItem(item, m_reply, m_path, m_fileName, m_fileIcon, m_timer, m_openFileChoosed, m_downloadPage, m_manager);
+    const QModelIndex index = m_manager->model()->addDownload(m_path, m_fileName, m_reply->url(), m_downloadPage);
+    DownloadItem* downItem = new DownloadItem(index, m_reply, m_path, m_fileName, m_fileIcon, m_timer, m_openFileChoosed, m_downloadPage, m_manager);
     downItem->setTotalSize(m_fileSize);
 
-    emit itemCreated(item, downItem);
+    emit itemCreated(downItem);
 }
 
 //////////////////////////////////////////////////////
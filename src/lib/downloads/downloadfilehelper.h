@@ -26,7 +26,6 @@
 #include "downloadmanager.h"
 
 class QFileIconProvider;
-class QListWidget;
 
 class DownloadItem;
 class DownloadManager;
@@ -39,7 +38,6 @@ public:
     explicit DownloadFileHelper(const QString &lastDownloadPath, const QString &downloadPath, bool useNativeDialog);
     ~DownloadFileHelper();
 
-    void setListWidget(QListWidget* tw) { m_listWidget = tw; }
     void setDownloadManager(DownloadManager* m) { m_manager = m; }
     void setLastDownloadOption(const DownloadManager::DownloadOption &option) { m_lastDownloadOption = option; }
 
@@ -48,7 +46,7 @@ public:
     static QString parseContentDisposition(const QByteArray &header);
 
 signals:
-    void itemCreated(QListWidgetItem* item, DownloadItem* downItem);
+    void itemCreated(DownloadItem* downItem);
 
 private slots:
     void optionsDialogAccepted(int finish = -1);
@@ -73,7 +71,6 @@ private:
     qint64 m_fileSize;
     bool m_openFileChoosed;
 
-    QListWidget* m_listWidget;
     QFileIconProvider* m_iconProvider;
     DownloadManager* m_manager;
 };
@@ -29,23 +29,18 @@
 
 #include <QMenu>
 #include <QClipboard>
-#include <QListWidgetItem>
 #include <QMouseEvent>
 #include <QTimer>
 #include <QFileInfo>
 #include <QMessageBox>
-#include <QDesktopServices>
-
-#ifdef Q_OS_WIN
-#include "Shlwapi.h"
-#endif
 
 //#define DOWNMANAGER_DEBUG
 
-DownloadItem::DownloadItem(QListWidgetItem* item, QNetworkReply* reply, const QString &path, const QString &fileName, const QPixmap &fileIcon, QTime* timer, bool openAfterFinishedDownload, const QUrl &downloadPage, DownloadManager* manager)
+DownloadItem::DownloadItem(const QModelIndex &index, QNetworkReply* reply, const QString &path, const QString &fileName, const QPixmap &fileIcon, QTime* timer, bool openAfterFinishedDownload, const QUrl &downloadPage, DownloadManager* manager)
     : QWidget()
     , ui(new Ui::DownloadItem)
-    , m_item(item)
+    , m_index(index)
+    , m_manager(manager)
     , m_reply(reply)
     , m_ftpDownloader(0)
     , m_path(path)
@@ -56,11 +51,12 @@ DownloadItem::DownloadItem(QListWidgetItem* item, QNetworkReply* reply, const QS
     , m_downloading(false)
     , m_openAfterFinish(openAfterFinishedDownload)
     , m_downloadStopped(false)
+    , m_currSpeed(0)
     , m_received(0)
     , m_total(0)
 {
 #ifdef DOWNMANAGER_DEBUG
-    qDebug() << __FUNCTION__ << item << reply << path << fileName;
+    qDebug() << __FUNCTION__ << index << reply << path << fileName;
 #endif
     QString fullPath = path + fileName;
     if (QFile::exists(fullPath)) {
@@ -85,6 +81,11 @@ DownloadItem::DownloadItem(QListWidgetItem* item, QNetworkReply* reply, const QS
     startDownloading();
 }
 
+QModelIndex DownloadItem::index() const
+{
+    return m_index;
+}
+
 void DownloadItem::setTotalSize(qint64 total)
 {
     if (total > 0) {
@@ -136,6 +137,7 @@ void DownloadItem::startDownloadingFromFtp(const QUrl &url)
     if (!m_outputFile.isOpen() && !m_outputFile.open(QIODevice::WriteOnly)) {
         stop(false);
         ui->downloadInfo->setText(tr("Error: Cannot write to file!"));
+        updateState(DownloadsModel::Error);
         return;
     }
 
@@ -181,10 +183,20 @@ void DownloadItem::finished()
 #ifdef DOWNMANAGER_DEBUG
     qDebug() << __FUNCTION__ << m_reply;
 #endif
+    // Aborted from stop()
+    if (m_downloadStopped) {
+        return;
+    }
+
     m_timer.stop();
 
     QString host = m_reply ? m_reply->url().host() : m_ftpDownloader->url().host();
-    ui->downloadInfo->setText(tr("Done - %1").arg(host));
+    const bool failed = m_reply && m_reply->error() != QNetworkReply::NoError;
+
+    if (!failed) {
+        ui->downloadInfo->setText(tr("Done - %1").arg(host));
+    }
+
     ui->progressBar->hide();
     ui->button->hide();
     ui->frame->hide();
@@ -197,13 +209,14 @@ void DownloadItem::finished()
         m_ftpDownloader->deleteLater();
     }
 
-    m_item->setSizeHint(sizeHint());
 #if QT_VERSION == 0x040700 // Workaround
     ui->button->show();
     ui->button->hide();
 #endif
     m_downloading = false;
 
+    updateState(failed ? DownloadsModel::Error : DownloadsModel::Finished);
+
     if (m_openAfterFinish) {
         openFile();
     }
@@ -227,6 +240,8 @@ void DownloadItem::downloadProgress(qint64 received, qint64 total)
     m_currSpeed = received * 1000.0 / m_downTimer->elapsed();
     m_received = received;
     m_total = total;
+
+    emit progressChanged();
 }
 
 void DownloadItem::timerEvent(QTimerEvent* event)
@@ -239,6 +254,11 @@ void DownloadItem::timerEvent(QTimerEvent* event)
     }
 }
 
+qint64 DownloadItem::remainingBytes() const
+{
+    return m_total > 0 ? m_total - m_received : 0;
+}
+
 int DownloadItem::progress()
 {
     return ui->progressBar->value();
@@ -344,7 +364,6 @@ void DownloadItem::stop(bool askForDeleteFile)
     ui->downloadInfo->setText(tr("Cancelled - %1").arg(host));
     ui->progressBar->hide();
     ui->button->hide();
-    m_item->setSizeHint(sizeHint());
 
 #if QT_VERSION == 0x040700 // Workaround
     ui->button->show();
@@ -352,14 +371,21 @@ void DownloadItem::stop(bool askForDeleteFile)
 #endif
     m_downloading = false;
 
-    emit downloadFinished(false);
+    updateState(DownloadsModel::Cancelled);
 
     if (askForDeleteFile) {
-        QMessageBox::StandardButton button = QMessageBox::question(m_item->listWidget()->parentWidget(), tr("Delete file"), tr("Do you want to also delete dowloaded file?"), QMessageBox::Yes | QMessageBox::No);
+        QMessageBox::StandardButton button = QMessageBox::question(m_manager, tr("Delete file"), tr("Do you want to also delete dowloaded file?"), QMessageBox::Yes | QMessageBox::No);
         if (button == QMessageBox::Yes) {
             QFile::remove(outputfile);
         }
     }
+
+    emit downloadFinished(false);
+}
+
+void DownloadItem::updateState(DownloadsModel::State state)
+{
+    m_manager->model()->setDownloadState(m_index, state, ui->downloadInfo->text());
 }
 
 void DownloadItem::mouseDoubleClickEvent(QMouseEvent* e)
@@ -379,7 +405,6 @@ void DownloadItem::customContextMenuRequested(const QPoint &pos)
     menu.addAction(QIcon::fromTheme("edit-copy"), tr("Copy Download Link"), this, SLOT(copyDownloadLink()));
     menu.addSeparator();
     menu.addAction(IconProvider::standardIcon(QStyle::SP_BrowserStop), tr("Cancel downloading"), this, SLOT(stop()))->setEnabled(m_downloading);
-    menu.addAction(QIcon::fromTheme("list-remove"), tr("Remove From List"), this, SLOT(clear()))->setEnabled(!m_downloading);
 
     if (m_downloading || ui->downloadInfo->text().startsWith(tr("Cancelled")) || ui->downloadInfo->text().startsWith(tr("Error"))) {
         menu.actions().at(0)->setEnabled(false);
@@ -404,35 +429,18 @@ void DownloadItem::copyDownloadLink()
     QApplication::clipboard()->setText(m_downUrl.toString());
 }
 
-void DownloadItem::clear()
-{
-    emit deleteItem(this);
-}
-
 void DownloadItem::openFile()
 {
     if (m_downloading) {
         return;
     }
-    QFileInfo info(m_path + m_fileName);
-    if (info.exists()) {
-        QDesktopServices::openUrl(QUrl::fromLocalFile(info.absoluteFilePath()));
-    }
-    else {
-        QMessageBox::warning(m_item->listWidget()->parentWidget(), tr("Not found"), tr("Sorry, the file \n %1 \n was not found!").arg(info.absoluteFilePath()));
-    }
+
+    DownloadManager::openDownloadedFile(m_path, m_fileName, m_manager);
 }
 
 void DownloadItem::openFolder()
 {
-#ifdef Q_OS_WIN
-    QString winFileName = m_path + m_fileName;
-    winFileName.replace(QLatin1Char('/'), "\\");
-    QString shExArg = "/e,/select,\"" + winFileName + "\"";
-    ShellExecute(NULL, NULL, TEXT("explorer.exe"), shExArg.toStdWString().c_str(), NULL, SW_SHOW);
-#else
-    QDesktopServices::openUrl(QUrl::fromLocalFile(m_path));
-#endif
+    DownloadManager::openDownloadFolder(m_path, m_fileName);
 }
 
 void DownloadItem::readyRead()
@@ -443,6 +451,7 @@ void DownloadItem::readyRead()
     if (!m_outputFile.isOpen() && !m_outputFile.open(QIODevice::WriteOnly)) {
         stop(false);
         ui->downloadInfo->setText(tr("Error: Cannot write to file!"));
+        updateState(DownloadsModel::Error);
         return;
     }
     m_outputFile.write(m_reply->readAll());
@@ -455,10 +464,16 @@ void DownloadItem::error()
 #endif
     if (m_reply && m_reply->error() != QNetworkReply::NoError) {
         ui->downloadInfo->setText(tr("Error: ") + m_reply->errorString());
+
+        // Otherwise state is updated in finished()
+        if (m_downloadStopped) {
+            updateState(DownloadsModel::Error);
+        }
     }
     else if (m_ftpDownloader && m_ftpDownloader->error() != QFtp::NoError) {
         stop(false);
         ui->downloadInfo->setText(tr("Error: ") + m_ftpDownloader->errorString());
+        updateState(DownloadsModel::Error);
     }
 }
 
@@ -479,6 +494,5 @@ void DownloadItem::updateDownload()
 DownloadItem::~DownloadItem()
 {
     delete ui;
-    delete m_item;
     delete m_downTimer;
 }
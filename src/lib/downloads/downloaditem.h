@@ -24,16 +24,16 @@
 #include <QUrl>
 #include <QNetworkReply>
 #include <QTime>
+#include <QPersistentModelIndex>
 
 #include "qzcommon.h"
+#include "downloadsmodel.h"
 
 namespace Ui
 {
 class DownloadItem;
 }
 
-class QListWidgetItem;
-
 class DownloadManager;
 class FtpDownloader;
 
@@ -42,21 +42,24 @@ class QUPZILLA_EXPORT DownloadItem : public QWidget
     Q_OBJECT
 
 public:
-    explicit DownloadItem(QListWidgetItem* item, QNetworkReply* reply, const QString &path, const QString &fileName, const QPixmap &fileIcon, QTime* timer, bool openAfterFinishedDownload, const QUrl &downloadPage, DownloadManager* manager);
+    explicit DownloadItem(const QModelIndex &index, QNetworkReply* reply, const QString &path, const QString &fileName, const QPixmap &fileIcon, QTime* timer, bool openAfterFinishedDownload, const QUrl &downloadPage, DownloadManager* manager);
     bool isDownloading() { return m_downloading; }
     bool isCancelled();
     QTime remainingTime() { return m_remTime; }
     double currentSpeed() { return m_currSpeed; }
+    qint64 remainingBytes() const;
     int progress();
     ~DownloadItem();
 
+    QModelIndex index() const;
+
     void setTotalSize(qint64 total);
 
     static QString remaingTimeToString(QTime time);
     static QString currentSpeedToString(double speed);
 
 signals:
-    void deleteItem(DownloadItem*);
+    void progressChanged();
     void downloadFinished(bool success);
 
 private slots:
@@ -71,7 +74,6 @@ private slots:
     void error();
     void updateDownload();
     void customContextMenuRequested(const QPoint &pos);
-    void clear();
 
     void goToDownloadPage();
     void copyDownloadLink();
@@ -82,10 +84,12 @@ private:
 
     void timerEvent(QTimerEvent* event);
     void updateDownloadInfo(double currSpeed, qint64 received, qint64 total);
+    void updateState(DownloadsModel::State state);
     void mouseDoubleClickEvent(QMouseEvent* e);
     Ui::DownloadItem* ui;
 
-    QListWidgetItem* m_item;
+    QPersistentModelIndex m_index;
+    DownloadManager* m_manager;
     QNetworkReply* m_reply;
     FtpDownloader* m_ftpDownloader;
     QString m_path;
@@ -0,0 +1,95 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "downloaditemdelegate.h"
+#include "downloadsmodel.h"
+
+#include <QPainter>
+#include <QApplication>
+#include <QAbstractItemView>
+
+#define ICON_SIZE 30
+
+DownloadItemDelegate::DownloadItemDelegate(QAbstractItemView* parent)
+    : QStyledItemDelegate(parent)
+    , m_rowHeight(0)
+    , m_padding(0)
+    , m_view(parent)
+{
+}
+
+void DownloadItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItemV4 opt = option;
+    initStyleOption(&opt, index);
+
+    const QWidget* w = opt.widget;
+    const QStyle* style = w ? w->style() : QApplication::style();
+
+    // Draw background
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, w);
+
+    if (m_view->indexWidget(index)) {
+        return;
+    }
+
+    if (!m_rowHeight) {
+        sizeHint(option, index);
+    }
+
+    const QPalette::ColorRole colorRole = opt.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text;
+    const int center = opt.rect.top() + opt.rect.height() / 2;
+
+    // Draw icon
+    QRect iconRect(opt.rect.left() + m_padding * 2, center - ICON_SIZE / 2, ICON_SIZE, ICON_SIZE);
+    opt.icon.paint(painter, iconRect);
+
+    // Draw file name
+    const int leftPosition = iconRect.right() + m_padding * 3;
+    const int textWidth = opt.rect.right() - m_padding - leftPosition;
+    const int lineHeight = opt.fontMetrics.height();
+
+    QRect nameRect(leftPosition, center - lineHeight - 1, textWidth, lineHeight);
+    const QString fileName = opt.fontMetrics.elidedText(index.data(DownloadsModel::FileNameRole).toString(), Qt::ElideMiddle, nameRect.width());
+    style->drawItemText(painter, nameRect, Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine, opt.palette, true, fileName, colorRole);
+
+    // Draw info
+    QRect infoRect(leftPosition, center + 1, textWidth, lineHeight);
+    const QString info = opt.fontMetrics.elidedText(index.data(DownloadsModel::InfoRole).toString(), Qt::ElideRight, infoRect.width());
+    style->drawItemText(painter, infoRect, Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine, opt.palette, false, info, colorRole);
+}
+
+QSize DownloadItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (QWidget* widget = m_view->indexWidget(index)) {
+        return widget->sizeHint();
+    }
+
+    if (!m_rowHeight) {
+        QStyleOptionViewItemV4 opt(option);
+        initStyleOption(&opt, index);
+
+        const QWidget* w = opt.widget;
+        const QStyle* style = w ? w->style() : QApplication::style();
+        const int padding = style->pixelMetric(QStyle::PM_FocusFrameHMargin, 0) + 1;
+
+        m_padding = padding > 3 ? padding : 3;
+        m_rowHeight = 4 * m_padding + qMax(ICON_SIZE, 2 * opt.fontMetrics.height() + 2);
+    }
+
+    return QSize(200, m_rowHeight);
+}
@@ -0,0 +1,43 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef DOWNLOADITEMDELEGATE_H
+#define DOWNLOADITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+#include "qzcommon.h"
+
+class QAbstractItemView;
+
+// Paints finished downloads, running downloads are shown with DownloadItem widget
+class QUPZILLA_EXPORT DownloadItemDelegate : public QStyledItemDelegate
+{
+public:
+    explicit DownloadItemDelegate(QAbstractItemView* parent);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
+private:
+    mutable int m_rowHeight;
+    mutable int m_padding;
+
+    QAbstractItemView* m_view;
+};
+
+#endif // DOWNLOADITEMDELEGATE_H
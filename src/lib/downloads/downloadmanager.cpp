@@ -21,6 +21,9 @@
 #include "mainapplication.h"
 #include "downloadoptionsdialog.h"
 #include "downloaditem.h"
+#include "downloaditemdelegate.h"
+#include "downloadsmodel.h"
+#include "tabwidget.h"
 #include "ecwin7.h"
 #include "networkmanager.h"
 #include "qtwin.h"
@@ -33,10 +36,20 @@
 #include <QMessageBox>
 #include <QCloseEvent>
 #include <QDir>
+#include <QMenu>
+#include <QTimer>
+#include <QClipboard>
+#include <QFileInfo>
+#include <QDesktopServices>
+
+#ifdef Q_OS_WIN
+#include "Shlwapi.h"
+#endif
 
 DownloadManager::DownloadManager(QWidget* parent)
     : QWidget(parent)
     , ui(new Ui::DownloadManager)
+    , m_model(new DownloadsModel(this))
     , m_isClosing(false)
     , m_lastDownloadOption(NoOption)
 {
@@ -52,6 +65,13 @@ DownloadManager::DownloadManager(QWidget* parent)
 
     m_networkManager = mApp->networkManager();
 
+    ui->list->setModel(m_model);
+    ui->list->setItemDelegate(new DownloadItemDelegate(ui->list));
+    ui->list->setContextMenuPolicy(Qt::CustomContextMenu);
+    ui->list->scrollToBottom();
+
+    connect(ui->list, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(listContextMenuRequested(QPoint)));
+    connect(ui->list, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(indexDoubleClicked(QModelIndex)));
     connect(ui->clearButton, SIGNAL(clicked()), this, SLOT(clearList()));
 
     loadSettings();
@@ -133,49 +153,26 @@ bool DownloadManager::nativeEvent(const QByteArray &eventType, void* _message, l
 
 void DownloadManager::timerEvent(QTimerEvent* e)
 {
-    QVector<QTime> remTimes;
-    QVector<int> progresses;
-    QVector<double> speeds;
-
     if (e->timerId() == m_timer.timerId()) {
-        if (!ui->list->count()) {
+        if (m_model->rowCount() == 0) {
             ui->speedLabel->clear();
             setWindowTitle(tr("Download Manager"));
             return;
         }
-        for (int i = 0; i < ui->list->count(); i++) {
-            DownloadItem* downItem = qobject_cast<DownloadItem*>(ui->list->itemWidget(ui->list->item(i)));
-            if (!downItem || (downItem && downItem->isCancelled()) || !downItem->isDownloading()) {
-                continue;
-            }
-            progresses.append(downItem->progress());
-            remTimes.append(downItem->remainingTime());
-            speeds.append(downItem->currentSpeed());
-        }
-        if (remTimes.isEmpty()) {
-            return;
-        }
 
-        QTime remaining;
-        foreach (const QTime &time, remTimes) {
-            if (time > remaining) {
-                remaining = time;
-            }
+        if (m_activeDownloads.isEmpty()) {
+            return;
         }
 
-        int progress = 0;
-        foreach (int prog, progresses) {
-            progress += prog;
-        }
-        progress = progress / progresses.count();
+        const int progress = m_totalStats.progress / m_activeDownloads.count();
 
-        double speed = 0.00;
-        foreach (double spee, speeds) {
-            speed += spee;
+        QTime remaining(0, 0);
+        if (m_totalStats.speed > 0) {
+            remaining = remaining.addSecs(m_totalStats.remainingBytes / m_totalStats.speed);
         }
 
-        ui->speedLabel->setText(tr("%1% of %2 files (%3) %4 remaining").arg(QString::number(progress), QString::number(progresses.count()),
-                                DownloadItem::currentSpeedToString(speed),
+        ui->speedLabel->setText(tr("%1% of %2 files (%3) %4 remaining").arg(QString::number(progress), QString::number(m_activeDownloads.count()),
+                                DownloadItem::currentSpeedToString(m_totalStats.speed),
                                 DownloadItem::remaingTimeToString(remaining)));
         setWindowTitle(tr("%1% - Download Manager").arg(progress));
 #ifdef W7TASKBAR
@@ -192,18 +189,7 @@ void DownloadManager::timerEvent(QTimerEvent* e)
 
 void DownloadManager::clearList()
 {
-    QList<DownloadItem*> items;
-    for (int i = 0; i < ui->list->count(); i++) {
-        DownloadItem* downItem = qobject_cast<DownloadItem*>(ui->list->itemWidget(ui->list->item(i)));
-        if (!downItem) {
-            continue;
-        }
-        if (downItem->isDownloading()) {
-            continue;
-        }
-        items.append(downItem);
-    }
-    qDeleteAll(items);
+    m_model->clearFinished();
 }
 
 void DownloadManager::download(const QNetworkRequest &request, const DownloadInfo &info)
@@ -235,40 +221,76 @@ void DownloadManager::handleUnsupportedContent(QNetworkReply* reply, const Downl
     reply->setProperty("downReply", QVariant(true));
 
     DownloadFileHelper* h = new DownloadFileHelper(m_lastDownloadPath, m_downloadPath, m_useNativeDialog);
-    connect(h, SIGNAL(itemCreated(QListWidgetItem*,DownloadItem*)), this, SLOT(itemCreated(QListWidgetItem*,DownloadItem*)));
+    connect(h, SIGNAL(itemCreated(DownloadItem*)), this, SLOT(itemCreated(DownloadItem*)));
 
     h->setLastDownloadOption(m_lastDownloadOption);
     h->setDownloadManager(this);
-    h->setListWidget(ui->list);
     h->handleUnsupportedContent(reply, info);
 }
 
-void DownloadManager::itemCreated(QListWidgetItem* item, DownloadItem* downItem)
+void DownloadManager::itemCreated(DownloadItem* downItem)
 {
-    connect(downItem, SIGNAL(deleteItem(DownloadItem*)), this, SLOT(deleteItem(DownloadItem*)));
-    connect(downItem, SIGNAL(downloadFinished(bool)), this, SLOT(downloadFinished(bool)));
-
-    ui->list->setItemWidget(item, downItem);
-    item->setSizeHint(downItem->sizeHint());
-    downItem->show();
-
     show();
     raise();
     activateWindow();
+
+    // Download failed right when starting
+    if (!downItem->isDownloading()) {
+        downItem->deleteLater();
+        return;
+    }
+
+    connect(downItem, SIGNAL(progressChanged()), this, SLOT(downloadProgressChanged()));
+    connect(downItem, SIGNAL(downloadFinished(bool)), this, SLOT(downloadFinished(bool)));
+
+    m_activeDownloads.insert(downItem, DownloadStats());
+
+    ui->list->setIndexWidget(downItem->index(), downItem);
+    ui->list->scrollTo(downItem->index());
+}
+
+void DownloadManager::downloadProgressChanged()
+{
+    DownloadItem* downItem = qobject_cast<DownloadItem*>(sender());
+    if (!downItem || !m_activeDownloads.contains(downItem)) {
+        return;
+    }
+
+    DownloadStats &stats = m_activeDownloads[downItem];
+
+    m_totalStats.progress -= stats.progress;
+    m_totalStats.speed -= stats.speed;
+    m_totalStats.remainingBytes -= stats.remainingBytes;
+
+    stats.progress = downItem->progress();
+    stats.speed = downItem->currentSpeed();
+    stats.remainingBytes = downItem->remainingBytes();
+
+    m_totalStats.progress += stats.progress;
+    m_totalStats.speed += stats.speed;
+    m_totalStats.remainingBytes += stats.remainingBytes;
 }
 
 void DownloadManager::downloadFinished(bool success)
 {
-    bool downloadingAllFilesFinished = true;
-    for (int i = 0; i < ui->list->count(); i++) {
-        DownloadItem* downItem = qobject_cast<DownloadItem*>(ui->list->itemWidget(ui->list->item(i)));
-        if (!downItem || (downItem && downItem->isCancelled()) || !downItem->isDownloading()) {
-            continue;
-        }
-        downloadingAllFilesFinished = false;
+    DownloadItem* downItem = qobject_cast<DownloadItem*>(sender());
+
+    if (downItem && m_activeDownloads.contains(downItem)) {
+        const DownloadStats stats = m_activeDownloads.take(downItem);
+
+        m_totalStats.progress -= stats.progress;
+        m_totalStats.speed -= stats.speed;
+        m_totalStats.remainingBytes -= stats.remainingBytes;
+
+        // Finished download is painted by delegate, the widget is removed
+        // after returning from its slots
+        m_finishedItems.append(downItem);
+        QTimer::singleShot(0, this, SLOT(removeFinishedItems()));
     }
 
-    if (downloadingAllFilesFinished) {
+    if (m_activeDownloads.isEmpty()) {
+        m_totalStats = DownloadStats();
+
         if (success && qApp->activeWindow() != this) {
             mApp->desktopNotifications()->showNotification(QIcon::fromTheme("mail-inbox", QIcon(":icons/notifications/download.png")).pixmap(48), tr("Download Finished"), tr("All files have been successfully downloaded."));
             if (!m_closeOnFinish) {
@@ -290,32 +312,129 @@ void DownloadManager::downloadFinished(bool success)
     }
 }
 
-void DownloadManager::deleteItem(DownloadItem* item)
+void DownloadManager::removeFinishedItems()
 {
-    if (item && !item->isDownloading()) {
-        delete item;
+    if (m_finishedItems.isEmpty()) {
+        return;
     }
+
+    foreach (const QPointer<DownloadItem> &downItem, m_finishedItems) {
+        if (!downItem) {
+            continue;
+        }
+
+        if (downItem->index().isValid()) {
+            ui->list->setIndexWidget(downItem->index(), 0);
+        }
+
+        if (downItem) {
+            downItem->deleteLater();
+        }
+    }
+
+    m_finishedItems.clear();
+
+    // Finished rows have different height than item widgets
+    ui->list->doItemsLayout();
 }
 
-bool DownloadManager::canClose()
+void DownloadManager::listContextMenuRequested(const QPoint &pos)
 {
-    if (m_isClosing) {
-        return true;
+    const QModelIndex index = ui->list->indexAt(pos);
+
+    // Running downloads have their own menu
+    if (!index.isValid() || ui->list->indexWidget(index)) {
+        return;
     }
 
-    bool isDownloading = false;
-    for (int i = 0; i < ui->list->count(); i++) {
-        DownloadItem* downItem = qobject_cast<DownloadItem*>(ui->list->itemWidget(ui->list->item(i)));
-        if (!downItem) {
-            continue;
+    const QString path = index.data(DownloadsModel::PathRole).toString();
+    const QString fileName = index.data(DownloadsModel::FileNameRole).toString();
+    const QUrl downloadPage = index.data(DownloadsModel::DownloadPageRole).toUrl();
+    const int state = index.data(DownloadsModel::StateRole).toInt();
+
+    QMenu menu;
+    QAction* openFileAction = menu.addAction(QIcon::fromTheme("document-open"), DownloadItem::tr("Open File"));
+    QAction* openFolderAction = menu.addAction(DownloadItem::tr("Open Folder"));
+    menu.addSeparator();
+    QAction* goToPageAction = menu.addAction(DownloadItem::tr("Go to Download Page"));
+    QAction* copyLinkAction = menu.addAction(QIcon::fromTheme("edit-copy"), DownloadItem::tr("Copy Download Link"));
+    menu.addSeparator();
+    QAction* removeAction = menu.addAction(QIcon::fromTheme("list-remove"), DownloadItem::tr("Remove From List"));
+
+    openFileAction->setEnabled(state == DownloadsModel::Finished);
+    goToPageAction->setEnabled(!downloadPage.isEmpty());
+
+    QAction* action = menu.exec(ui->list->viewport()->mapToGlobal(pos));
+
+    if (action == openFileAction) {
+        openDownloadedFile(path, fileName, this);
+    }
+    else if (action == openFolderAction) {
+        openDownloadFolder(path, fileName);
+    }
+    else if (action == goToPageAction) {
+        BrowserWindow* window = mApp->getWindow();
+
+        if (window) {
+            window->tabWidget()->addView(downloadPage, Qz::NT_SelectedTab);
         }
-        if (downItem->isDownloading()) {
-            isDownloading = true;
-            break;
+        else {
+            mApp->createWindow(Qz::BW_NewWindow, downloadPage);
         }
     }
+    else if (action == copyLinkAction) {
+        QApplication::clipboard()->setText(index.data(DownloadsModel::UrlRole).toUrl().toString());
+    }
+    else if (action == removeAction) {
+        m_model->removeDownload(index);
+    }
+}
+
+void DownloadManager::indexDoubleClicked(const QModelIndex &index)
+{
+    if (ui->list->indexWidget(index) || index.data(DownloadsModel::StateRole).toInt() != DownloadsModel::Finished) {
+        return;
+    }
+
+    openDownloadedFile(index.data(DownloadsModel::PathRole).toString(), index.data(DownloadsModel::FileNameRole).toString(), this);
+}
+
+DownloadsModel* DownloadManager::model() const
+{
+    return m_model;
+}
+
+void DownloadManager::openDownloadedFile(const QString &path, const QString &fileName, QWidget* parent)
+{
+    QFileInfo info(path + fileName);
+    if (info.exists()) {
+        QDesktopServices::openUrl(QUrl::fromLocalFile(info.absoluteFilePath()));
+    }
+    else {
+        QMessageBox::warning(parent, DownloadItem::tr("Not found"), DownloadItem::tr("Sorry, the file \n %1 \n was not found!").arg(info.absoluteFilePath()));
+    }
+}
+
+void DownloadManager::openDownloadFolder(const QString &path, const QString &fileName)
+{
+#ifdef Q_OS_WIN
+    QString winFileName = path + fileName;
+    winFileName.replace(QLatin1Char('/'), "\\");
+    QString shExArg = "/e,/select,\"" + winFileName + "\"";
+    ShellExecute(NULL, NULL, TEXT("explorer.exe"), shExArg.toStdWString().c_str(), NULL, SW_SHOW);
+#else
+    Q_UNUSED(fileName)
+    QDesktopServices::openUrl(QUrl::fromLocalFile(path));
+#endif
+}
+
+bool DownloadManager::canClose()
+{
+    if (m_isClosing) {
+        return true;
+    }
 
-    return !isDownloading;
+    return m_activeDownloads.isEmpty();
 }
 
 bool DownloadManager::useExternalManager() const
@@ -19,6 +19,8 @@
 #define DOWNLOADMANAGER_H
 
 #include <QBasicTimer>
+#include <QPointer>
+#include <QHash>
 
 #include "qzcommon.h"
 #include "ecwin7.h"
@@ -30,10 +32,11 @@ class DownloadManager;
 
 class QNetworkReply;
 class QNetworkRequest;
-class QListWidgetItem;
+class QModelIndex;
 class QUrl;
 
 class DownloadItem;
+class DownloadsModel;
 class EcWin7;
 class NetworkManager;
 class WebPage;
@@ -75,6 +78,11 @@ public:
     void setLastDownloadPath(const QString &lastPath) { m_lastDownloadPath = lastPath; }
     void setLastDownloadOption(const DownloadOption &option) { m_lastDownloadOption = option; }
 
+    DownloadsModel* model() const;
+
+    static void openDownloadedFile(const QString &path, const QString &fileName, QWidget* parent = 0);
+    static void openDownloadFolder(const QString &path, const QString &fileName);
+
 public slots:
     void show();
 
@@ -89,15 +97,27 @@ protected:
 
 private slots:
     void clearList();
-    void deleteItem(DownloadItem* item);
 
-    void itemCreated(QListWidgetItem* item, DownloadItem* downItem);
+    void itemCreated(DownloadItem* downItem);
+    void downloadProgressChanged();
     void downloadFinished(bool success);
+    void removeFinishedItems();
+
+    void listContextMenuRequested(const QPoint &pos);
+    void indexDoubleClicked(const QModelIndex &index);
 
 signals:
     void resized(QSize);
 
 private:
+    struct DownloadStats {
+        int progress;
+        double speed;
+        qint64 remainingBytes;
+
+        DownloadStats() : progress(0), speed(0), remainingBytes(0) { }
+    };
+
 #ifdef W7TASKBAR
     EcWin7 win7;
 #endif
@@ -108,8 +128,14 @@ private:
 
     Ui::DownloadManager* ui;
     NetworkManager* m_networkManager;
+    DownloadsModel* m_model;
     QBasicTimer m_timer;
 
+    // Statistics of running downloads and their sum, updated with each progress change
+    QHash<DownloadItem*, DownloadStats> m_activeDownloads;
+    DownloadStats m_totalStats;
+    QList<QPointer<DownloadItem> > m_finishedItems;
+
     QString m_lastDownloadPath;
     QString m_downloadPath;
     bool m_useNativeDialog;
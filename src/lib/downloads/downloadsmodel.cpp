@@ -0,0 +1,320 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "downloadsmodel.h"
+#include "mainapplication.h"
+#include "history.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QSet>
+#include <QFileInfo>
+#include <QFileIconProvider>
+
+DownloadsModel::DownloadsModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_saveHistory(!mApp->isPrivate())
+{
+    init();
+
+    // Downloads are cleared together with history
+    if (m_saveHistory) {
+        connect(mApp->history(), SIGNAL(resetHistory()), this, SLOT(historyReset()));
+    }
+}
+
+int DownloadsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_entries.count();
+}
+
+QVariant DownloadsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_entries.count()) {
+        return QVariant();
+    }
+
+    const Entry &entry = m_entries.at(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case FileNameRole:
+        return entry.fileName;
+
+    case Qt::DecorationRole:
+        return fileIcon(entry);
+
+    case Qt::ToolTipRole:
+        return entry.url.toString();
+
+    case PathRole:
+        return entry.path;
+
+    case UrlRole:
+        return entry.url;
+
+    case DownloadPageRole:
+        return entry.downloadPage;
+
+    case DateRole:
+        return entry.date;
+
+    case StateRole:
+        return entry.state;
+
+    case InfoRole:
+        return entry.info;
+
+    default:
+        return QVariant();
+    }
+}
+
+QModelIndex DownloadsModel::addDownload(const QString &path, const QString &fileName, const QUrl &url, const QUrl &downloadPage)
+{
+    Entry entry;
+    entry.id = 0;
+    entry.path = path;
+    entry.fileName = fileName;
+    entry.url = url;
+    entry.downloadPage = downloadPage;
+    entry.date = QDateTime::currentDateTime();
+    entry.state = Downloading;
+
+    if (m_saveHistory) {
+        QSqlQuery query;
+        query.prepare("INSERT INTO downloads (path, filename, url, page, date, state, info) VALUES (?,?,?,?,?,?,?)");
+        query.addBindValue(entry.path);
+        query.addBindValue(entry.fileName);
+        query.addBindValue(entry.url.toEncoded());
+        query.addBindValue(entry.downloadPage.toEncoded());
+        query.addBindValue(entry.date.toMSecsSinceEpoch());
+        query.addBindValue(entry.state);
+        query.addBindValue(entry.info);
+        query.exec();
+
+        entry.id = query.lastInsertId().toLongLong();
+    }
+
+    beginInsertRows(QModelIndex(), m_entries.count(), m_entries.count());
+    m_entries.append(entry);
+    endInsertRows();
+
+    return index(m_entries.count() - 1);
+}
+
+void DownloadsModel::setDownloadState(const QModelIndex &index, DownloadsModel::State state, const QString &info)
+{
+    if (!index.isValid() || index.row() >= m_entries.count()) {
+        return;
+    }
+
+    Entry &entry = m_entries[index.row()];
+    entry.state = state;
+    entry.info = info;
+
+    if (m_saveHistory && entry.id > 0) {
+        QSqlQuery query;
+        query.prepare("UPDATE downloads SET state = ?, info = ? WHERE id = ?");
+        query.addBindValue(entry.state);
+        query.addBindValue(entry.info);
+        query.addBindValue(entry.id);
+        query.exec();
+    }
+
+    emit dataChanged(index, index);
+}
+
+void DownloadsModel::removeDownload(const QModelIndex &index)
+{
+    if (!index.isValid() || index.row() >= m_entries.count()) {
+        return;
+    }
+
+    const int row = index.row();
+
+    if (m_entries.at(row).state == Downloading) {
+        return;
+    }
+
+    if (m_saveHistory) {
+        QSqlQuery query;
+        query.prepare("DELETE FROM downloads WHERE id = ?");
+        query.addBindValue(m_entries.at(row).id);
+        query.exec();
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_entries.remove(row);
+    endRemoveRows();
+}
+
+void DownloadsModel::clearFinished()
+{
+    QStringList runningIds;
+
+    // Remove continuous blocks of finished downloads, rows of running
+    // downloads must stay untouched as they are shown with item widgets
+    int row = m_entries.count() - 1;
+
+    while (row >= 0) {
+        if (m_entries.at(row).state == Downloading) {
+            runningIds.append(QString::number(m_entries.at(row).id));
+            --row;
+            continue;
+        }
+
+        const int last = row;
+
+        while (row >= 0 && m_entries.at(row).state != Downloading) {
+            --row;
+        }
+
+        beginRemoveRows(QModelIndex(), row + 1, last);
+        m_entries.remove(row + 1, last - row);
+        endRemoveRows();
+    }
+
+    if (m_saveHistory) {
+        QSqlQuery query;
+
+        if (runningIds.isEmpty()) {
+            query.exec("DELETE FROM downloads");
+        }
+        else {
+            query.exec(QString("DELETE FROM downloads WHERE id NOT IN (%1)").arg(runningIds.join(QLatin1String(","))));
+        }
+    }
+}
+
+void DownloadsModel::deleteFinished(QSqlDatabase &db, qint64 from, qint64 to)
+{
+    if (!db.tables().contains(QLatin1String("downloads"))) {
+        return;
+    }
+
+    QSqlQuery query(db);
+
+    if (to == 0) {
+        query.prepare("DELETE FROM downloads WHERE state != ?");
+        query.addBindValue(Downloading);
+    }
+    else {
+        query.prepare("DELETE FROM downloads WHERE state != ? AND date BETWEEN ? AND ?");
+        query.addBindValue(Downloading);
+        query.addBindValue(from);
+        query.addBindValue(to);
+    }
+
+    query.exec();
+}
+
+void DownloadsModel::historyReset()
+{
+    QSet<qint64> savedIds;
+
+    QSqlQuery query;
+    query.exec("SELECT id FROM downloads");
+    while (query.next()) {
+        savedIds.insert(query.value(0).toLongLong());
+    }
+
+    // Remove finished downloads that were deleted from database
+    for (int row = m_entries.count() - 1; row >= 0; --row) {
+        const Entry &entry = m_entries.at(row);
+
+        if (entry.state != Downloading && entry.id > 0 && !savedIds.contains(entry.id)) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_entries.remove(row);
+            endRemoveRows();
+        }
+    }
+}
+
+void DownloadsModel::init()
+{
+    if (!m_saveHistory) {
+        return;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database();
+
+    if (!db.tables().contains(QLatin1String("downloads"))) {
+        db.exec("CREATE TABLE downloads (id INTEGER PRIMARY KEY, path TEXT, filename TEXT, url TEXT, "
+                "page TEXT, date NUMERIC, state NUMERIC, info TEXT)");
+        return;
+    }
+
+    QVector<int> interruptedRows;
+
+    QSqlQuery query;
+    query.exec("SELECT id, path, filename, url, page, date, state, info FROM downloads ORDER BY id");
+
+    while (query.next()) {
+        Entry entry;
+        entry.id = query.value(0).toLongLong();
+        entry.path = query.value(1).toString();
+        entry.fileName = query.value(2).toString();
+        entry.url = QUrl::fromEncoded(query.value(3).toByteArray());
+        entry.downloadPage = QUrl::fromEncoded(query.value(4).toByteArray());
+        entry.date = QDateTime::fromMSecsSinceEpoch(query.value(5).toLongLong());
+        entry.state = static_cast<State>(query.value(6).toInt());
+        entry.info = query.value(7).toString();
+
+        // Download was interrupted by quitting the browser
+        if (entry.state == Downloading) {
+            entry.state = Cancelled;
+            entry.info = tr("Cancelled - %1").arg(entry.url.host());
+            interruptedRows.append(m_entries.count());
+        }
+
+        m_entries.append(entry);
+    }
+
+    if (interruptedRows.isEmpty()) {
+        return;
+    }
+
+    // Save the state, so the downloads are not shown as running ones next time
+    db.transaction();
+
+    foreach (int row, interruptedRows) {
+        const Entry &entry = m_entries.at(row);
+
+        QSqlQuery update;
+        update.prepare("UPDATE downloads SET state = ?, info = ? WHERE id = ?");
+        update.addBindValue(entry.state);
+        update.addBindValue(entry.info);
+        update.addBindValue(entry.id);
+        update.exec();
+    }
+
+    db.commit();
+}
+
+QIcon DownloadsModel::fileIcon(const Entry &entry) const
+{
+    // All files of one type share the same icon
+    const QString suffix = QFileInfo(entry.fileName).suffix().toLower();
+
+    if (!m_iconCache.contains(suffix)) {
+        m_iconCache.insert(suffix, QFileIconProvider().icon(QFileInfo(entry.path + entry.fileName)));
+    }
+
+    return m_iconCache.value(suffix);
+}
@@ -0,0 +1,96 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef DOWNLOADSMODEL_H
+#define DOWNLOADSMODEL_H
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QVector>
+#include <QHash>
+#include <QIcon>
+#include <QUrl>
+
+#include "qzcommon.h"
+
+class QSqlDatabase;
+
+class QUPZILLA_EXPORT DownloadsModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        FileNameRole = Qt::UserRole + 1,
+        PathRole = Qt::UserRole + 2,
+        UrlRole = Qt::UserRole + 3,
+        DownloadPageRole = Qt::UserRole + 4,
+        DateRole = Qt::UserRole + 5,
+        StateRole = Qt::UserRole + 6,
+        InfoRole = Qt::UserRole + 7,
+        MaxRole = InfoRole
+    };
+
+    enum State {
+        Downloading = 0,
+        Finished = 1,
+        Cancelled = 2,
+        Error = 3
+    };
+
+    explicit DownloadsModel(QObject* parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+    // Adds new running download and returns its index
+    QModelIndex addDownload(const QString &path, const QString &fileName, const QUrl &url, const QUrl &downloadPage);
+    void setDownloadState(const QModelIndex &index, State state, const QString &info);
+
+    void removeDownload(const QModelIndex &index);
+    // Removes all downloads that are not running
+    void clearFinished();
+
+    // Deletes finished downloads started between from and to (in msecs since epoch)
+    // from database, all of them when to is 0. Can be called from any thread,
+    // models are updated with History::resetHistory().
+    static void deleteFinished(QSqlDatabase &db, qint64 from = 0, qint64 to = 0);
+
+private slots:
+    void historyReset();
+
+private:
+    struct Entry {
+        qint64 id;
+        QString path;
+        QString fileName;
+        QUrl url;
+        QUrl downloadPage;
+        QDateTime date;
+        State state;
+        QString info;
+    };
+
+    void init();
+    QIcon fileIcon(const Entry &entry) const;
+
+    QVector<Entry> m_entries;
+    mutable QHash<QString, QIcon> m_iconCache;
+    bool m_saveHistory;
+};
+
+#endif // DOWNLOADSMODEL_H
@@ -20,6 +20,7 @@
 #include "tabbedwebview.h"
 #include "browserwindow.h"
 #include "iconprovider.h"
+#include "downloadsmodel.h"
 #include "settings.h"
 
 #include <QSqlDatabase>
@@ -139,38 +140,74 @@ void History::deleteHistoryEntry(int index)
 
 void History::deleteHistoryEntry(const QList<int> &list)
 {
+    // Entries are deleted in chunks, each with one statement per table
+    // Number of bound urls must stay below SQLite limit of host parameters
+    const int chunkSize = 500;
+
+    QVector<HistoryEntry> deletedEntries;
+    deletedEntries.reserve(list.size());
+
     QSqlDatabase db = QSqlDatabase::database();
     db.transaction();
 
-    foreach (int index, list) {
+    for (int i = 0; i < list.size(); i += chunkSize) {
+        const QList<int> chunk = list.mid(i, chunkSize);
+
+        QStringList ids;
+        ids.reserve(chunk.size());
+        foreach (int id, chunk) {
+            ids.append(QString::number(id));
+        }
+        const QString idList = ids.join(QL1S(","));
+
         QSqlQuery query;
-        query.prepare("SELECT count, date, url, title FROM history WHERE id=?");
-        query.addBindValue(index);
+        query.exec(QString("SELECT id, count, date, url, title FROM history WHERE id IN (%1)").arg(idList));
+
+        QVariantList iconUrls;
 
-        if (!query.exec() || !query.next()) {
+        while (query.next()) {
+            HistoryEntry entry;
+            entry.id = query.value(0).toInt();
+            entry.count = query.value(1).toInt();
+            entry.date = QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
+            entry.url = query.value(3).toUrl();
+            entry.urlString = entry.url.toEncoded();
+            entry.title = query.value(4).toString();
+
+            deletedEntries.append(entry);
+            iconUrls.append(entry.url.toEncoded(QUrl::RemoveFragment));
+        }
+
+        if (iconUrls.isEmpty()) {
             continue;
         }
 
-        HistoryEntry entry;
-        entry.id = index;
-        entry.count = query.value(0).toInt();
-        entry.date = QDateTime::fromMSecsSinceEpoch(query.value(1).toLongLong());
-        entry.url = query.value(2).toUrl();
-        entry.urlString = entry.url.toEncoded();
-        entry.title = query.value(3).toString();
+        query.exec(QString("DELETE FROM history WHERE id IN (%1)").arg(idList));
 
-        query.prepare("DELETE FROM history WHERE id=?");
-        query.addBindValue(index);
-        query.exec();
+        QStringList placeholders;
+        placeholders.reserve(iconUrls.size());
+        for (int j = 0; j < iconUrls.size(); ++j) {
+            placeholders.append(QL1S("?"));
+        }
 
-        query.prepare("DELETE FROM icons WHERE url=?");
-        query.addBindValue(entry.url.toEncoded(QUrl::RemoveFragment));
+        query.prepare(QString("DELETE FROM icons WHERE url IN (%1)").arg(placeholders.join(QL1S(","))));
+        foreach (const QVariant &url, iconUrls) {
+            query.addBindValue(url);
+        }
         query.exec();
+    }
 
-        emit historyEntryDeleted(entry);
+    if (!deletedEntries.isEmpty()) {
+        // Icon data no longer used by any icon
+        QSqlQuery query;
+        query.exec(QSL("DELETE FROM icon_data WHERE NOT EXISTS (SELECT 1 FROM icons WHERE icons.data_id = icon_data.id)"));
     }
 
     db.commit();
+
+    if (!deletedEntries.isEmpty()) {
+        emit historyEntriesDeleted(deletedEntries);
+    }
 }
 
 void History::deleteHistoryEntry(const QString &url, const QString &title)
@@ -243,6 +280,9 @@ bool History::clearHistory()
 {
     QSqlQuery query;
     if (query.exec("DELETE FROM history")) {
+        QSqlDatabase db = QSqlDatabase::database();
+        DownloadsModel::deleteFinished(db);
+
         emit resetHistory();
         return true;
     }
@@ -250,6 +290,11 @@ bool History::clearHistory()
     return false;
 }
 
+void History::reloadHistory()
+{
+    emit resetHistory();
+}
+
 void History::setSaving(bool state)
 {
     m_isSaving = state;
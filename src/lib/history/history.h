@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QVector>
 #include <QDateTime>
 #include <QUrl>
 
@@ -63,6 +64,8 @@ public:
     QVector<HistoryEntry> mostVisited(int count);
 
     bool clearHistory();
+    // Reloads history views after entries were deleted directly in database
+    void reloadHistory();
     bool optimizeHistory();
     bool isSaving();
     void setSaving(bool state);
@@ -71,7 +74,7 @@ public:
 
 signals:
     void historyEntryAdded(const HistoryEntry &entry);
-    void historyEntryDeleted(const HistoryEntry &entry);
+    void historyEntriesDeleted(const QVector<HistoryEntry> &entries);
     void historyEntryEdited(const HistoryEntry &before, const HistoryEntry &after);
 
     void resetHistory();
@@ -20,6 +20,8 @@
 
 HistoryItem::HistoryItem(HistoryItem* parent)
     : canFetchMore(false)
+    , lastFetchedTimestamp(-1)
+    , lastFetchedId(-1)
     , m_parent(parent)
     , m_iconLoaded(false)
     , m_startTimestamp(0)
@@ -92,6 +94,22 @@ void HistoryItem::removeChild(HistoryItem* child)
     m_children.removeOne(child);
 }
 
+void HistoryItem::removeChildren(int row, int count)
+{
+    if (row < 0 || count <= 0 || row + count > m_children.count()) {
+        return;
+    }
+
+    // Children are detached first, so they don't remove themselves from the list one by one
+    for (int i = row; i < row + count; ++i) {
+        HistoryItem* child = m_children.at(i);
+        child->m_parent = 0;
+        delete child;
+    }
+
+    m_children.erase(m_children.begin() + row, m_children.begin() + row + count);
+}
+
 HistoryItem* HistoryItem::child(int row) const
 {
     if (QzTools::containsIndex(m_children, row)) {
@@ -173,5 +191,9 @@ HistoryItem::~HistoryItem()
         m_parent->removeChild(this);
     }
 
+    foreach (HistoryItem* child, m_children) {
+        child->m_parent = 0;
+    }
+
     qDeleteAll(m_children);
 }
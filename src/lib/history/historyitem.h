@@ -19,6 +19,7 @@
 #define HISTORYITEM_H
 
 #include <QIcon>
+#include <QSet>
 
 #include "qzcommon.h"
 #include "history.h"
@@ -41,6 +42,8 @@ public:
 
     void removeChild(int row);
     void removeChild(HistoryItem* child);
+    // Removes and deletes count children starting at row
+    void removeChildren(int row, int count);
 
     int row();
     int indexOfChild(HistoryItem* child);
@@ -62,6 +65,11 @@ public:
     QString title;
     bool canFetchMore;
 
+    // Top level items: ids of all children and position of the last fetched entry
+    QSet<int> childIds;
+    qint64 lastFetchedTimestamp;
+    int lastFetchedId;
+
 private:
     HistoryItem* m_parent;
     QList<HistoryItem*> m_children;
@@ -18,11 +18,26 @@
 #include "historymodel.h"
 #include "historyitem.h"
 #include "iconprovider.h"
+#include "sqldatabase.h"
 
 #include <QApplication>
 #include <QSqlQuery>
 #include <QDateTime>
 #include <QTimer>
+#include <QHash>
+
+// Number of entries loaded at once into top level item
+static const int s_fetchLimit = 250;
+
+static QString likePattern(const QString &string)
+{
+    QString pattern = string;
+    pattern.replace(QLatin1Char('\\'), QLatin1String("\\\\"));
+    pattern.replace(QLatin1Char('%'), QLatin1String("\\%"));
+    pattern.replace(QLatin1Char('_'), QLatin1String("\\_"));
+
+    return QLatin1Char('%') + pattern + QLatin1Char('%');
+}
 
 static QString dateTimeToString(const QDateTime &dateTime)
 {
@@ -40,11 +55,17 @@ HistoryModel::HistoryModel(History* history)
     , m_todayItem(0)
     , m_history(history)
 {
+    // Index for loading entries by date, fails silently with read-only database.
+    // Creating it for big history takes a while, so it is not done on GUI thread.
+    QSqlQuery query;
+    query.prepare(QSL("CREATE INDEX IF NOT EXISTS historyDate ON history(date)"));
+    SqlDatabase::instance()->execAsync(query);
+
     init();
 
     connect(m_history, SIGNAL(resetHistory()), this, SLOT(resetHistory()));
     connect(m_history, SIGNAL(historyEntryAdded(HistoryEntry)), this, SLOT(historyEntryAdded(HistoryEntry)));
-    connect(m_history, SIGNAL(historyEntryDeleted(HistoryEntry)), this, SLOT(historyEntryDeleted(HistoryEntry)));
+    connect(m_history, SIGNAL(historyEntriesDeleted(QVector<HistoryEntry>)), this, SLOT(historyEntriesDeleted(QVector<HistoryEntry>)));
     connect(m_history, SIGNAL(historyEntryEdited(HistoryEntry,HistoryEntry)), this, SLOT(historyEntryEdited(HistoryEntry,HistoryEntry)));
 }
 
@@ -259,6 +280,22 @@ void HistoryModel::removeTopLevelIndexes(const QList<QPersistentModelIndex> &ind
     }
 }
 
+QString HistoryModel::filterString() const
+{
+    return m_filterString;
+}
+
+void HistoryModel::setFilterString(const QString &string)
+{
+    if (m_filterString == string) {
+        return;
+    }
+
+    m_filterString = string;
+
+    resetHistory();
+}
+
 void HistoryModel::resetHistory()
 {
     beginResetModel();
@@ -289,18 +326,41 @@ void HistoryModel::fetchMore(const QModelIndex &parent)
 
     parentItem->canFetchMore = false;
 
-    QList<int> idList;
-    for (int i = 0; i < parentItem->childCount(); ++i) {
-        idList.append(parentItem->child(i)->historyEntry.id);
+    // Keyset pagination, continue right after the last fetched entry
+    QString queryString = QSL("SELECT id, count, title, url, date FROM history WHERE date BETWEEN ? AND ? ");
+
+    if (parentItem->lastFetchedId != -1) {
+        queryString.append(QSL("AND (date < ? OR (date = ? AND id < ?)) "));
     }
 
+    if (!m_filterString.isEmpty()) {
+        queryString.append(QSL("AND (title LIKE ? ESCAPE '\\' OR url LIKE ? ESCAPE '\\') "));
+    }
+
+    queryString.append(QSL("ORDER BY date DESC, id DESC LIMIT ?"));
+
     QSqlQuery query;
-    query.prepare("SELECT id, count, title, url, date FROM history WHERE date BETWEEN ? AND ? ORDER BY date DESC");
+    query.prepare(queryString);
     query.addBindValue(parentItem->endTimestamp());
     query.addBindValue(parentItem->startTimestamp());
+
+    if (parentItem->lastFetchedId != -1) {
+        query.addBindValue(parentItem->lastFetchedTimestamp);
+        query.addBindValue(parentItem->lastFetchedTimestamp);
+        query.addBindValue(parentItem->lastFetchedId);
+    }
+
+    if (!m_filterString.isEmpty()) {
+        const QString pattern = likePattern(m_filterString);
+        query.addBindValue(pattern);
+        query.addBindValue(pattern);
+    }
+
+    query.addBindValue(s_fetchLimit);
     query.exec();
 
     QVector<HistoryEntry> list;
+    int fetchedCount = 0;
 
     while (query.next()) {
         HistoryEntry entry;
@@ -311,20 +371,29 @@ void HistoryModel::fetchMore(const QModelIndex &parent)
         entry.date = QDateTime::fromMSecsSinceEpoch(query.value(4).toLongLong());
         entry.urlString = entry.url.toEncoded();
 
-        if (!idList.contains(entry.id)) {
+        ++fetchedCount;
+        parentItem->lastFetchedTimestamp = query.value(4).toLongLong();
+        parentItem->lastFetchedId = entry.id;
+
+        // Entries added after the item was created are already in the model
+        if (!parentItem->childIds.contains(entry.id)) {
             list.append(entry);
         }
     }
 
+    parentItem->canFetchMore = fetchedCount == s_fetchLimit;
+
     if (list.isEmpty()) {
         return;
     }
 
-    beginInsertRows(parent, 0, list.size() - 1);
+    const int firstRow = parentItem->childCount();
+    beginInsertRows(parent, firstRow, firstRow + list.size() - 1);
 
     foreach (const HistoryEntry &entry, list) {
         HistoryItem* newItem = new HistoryItem(parentItem);
         newItem->historyEntry = entry;
+        parentItem->childIds.insert(entry.id);
     }
 
     endInsertRows();
@@ -332,6 +401,10 @@ void HistoryModel::fetchMore(const QModelIndex &parent)
 
 void HistoryModel::historyEntryAdded(const HistoryEntry &entry)
 {
+    if (!matchesFilter(entry)) {
+        return;
+    }
+
     if (!m_todayItem) {
         beginInsertRows(QModelIndex(), 0, 0);
 
@@ -351,25 +424,28 @@ void HistoryModel::historyEntryAdded(const HistoryEntry &entry)
     item->historyEntry = entry;
 
     m_todayItem->prependChild(item);
+    m_todayItem->childIds.insert(entry.id);
 
     endInsertRows();
 }
 
-void HistoryModel::historyEntryDeleted(const HistoryEntry &entry)
+void HistoryModel::historyEntriesDeleted(const QVector<HistoryEntry> &entries)
 {
-    HistoryItem* item = findHistoryItem(entry);
-    if (!item) {
-        return;
-    }
+    QHash<HistoryItem*, QSet<int> > deletedIds;
 
-    HistoryItem* parentItem = item->parent();
-    int row = item->row();
+    foreach (const HistoryEntry &entry, entries) {
+        HistoryItem* parentItem = findParentItem(entry);
 
-    beginRemoveRows(createIndex(parentItem->row(), 0, parentItem), row, row);
-    delete item;
-    endRemoveRows();
+        if (parentItem && parentItem->childIds.contains(entry.id)) {
+            deletedIds[parentItem].insert(entry.id);
+        }
+    }
 
-    checkEmptyParentItem(parentItem);
+    QHash<HistoryItem*, QSet<int> >::const_iterator i = deletedIds.constBegin();
+    while (i != deletedIds.constEnd()) {
+        removeChildItems(i.key(), i.value());
+        ++i;
+    }
 }
 
 void HistoryModel::historyEntryEdited(const HistoryEntry &before, const HistoryEntry &after)
@@ -395,36 +471,67 @@ void HistoryModel::historyEntryEdited(const HistoryEntry &before, const HistoryE
         historyEntryAdded(after);
     }
 #endif
-    historyEntryDeleted(before);
+    historyEntriesDeleted(QVector<HistoryEntry>() << before);
     historyEntryAdded(after);
 }
 
-HistoryItem* HistoryModel::findHistoryItem(const HistoryEntry &entry)
+HistoryItem* HistoryModel::findParentItem(const HistoryEntry &entry)
 {
-    HistoryItem* parentItem = 0;
     qint64 timestamp = entry.date.toMSecsSinceEpoch();
 
     for (int i = 0; i < m_rootItem->childCount(); ++i) {
         HistoryItem* item = m_rootItem->child(i);
 
         if (item->endTimestamp() < timestamp) {
-            parentItem = item;
-            break;
+            return item;
         }
     }
 
-    if (!parentItem) {
-        return 0;
+    return 0;
+}
+
+void HistoryModel::removeChildItems(HistoryItem* parentItem, const QSet<int> &ids)
+{
+    foreach (int id, ids) {
+        parentItem->childIds.remove(id);
     }
 
-    for (int i = 0; i < parentItem->childCount(); ++i) {
-        HistoryItem* item = parentItem->child(i);
-        if (item->historyEntry.id == entry.id) {
-            return item;
+    // All children are deleted, remove the whole top level item. When more children
+    // can still be fetched from database, the item must stay.
+    if (ids.count() == parentItem->childCount() && !parentItem->canFetchMore) {
+        int row = parentItem->row();
+
+        beginRemoveRows(QModelIndex(), row, row);
+        delete parentItem;
+        endRemoveRows();
+
+        if (parentItem == m_todayItem) {
+            m_todayItem = 0;
         }
+        return;
     }
 
-    return 0;
+    const QModelIndex parentIndex = createIndex(parentItem->row(), 0, parentItem);
+
+    // Contiguous ranges of rows are removed starting from the end,
+    // so rows of ranges not yet removed stay valid
+    int last = -1;
+
+    for (int row = parentItem->childCount() - 1; row >= -1; --row) {
+        if (row >= 0 && ids.contains(parentItem->child(row)->historyEntry.id)) {
+            if (last == -1) {
+                last = row;
+            }
+            continue;
+        }
+
+        if (last != -1) {
+            beginRemoveRows(parentIndex, row + 1, last);
+            parentItem->removeChildren(row + 1, last - row);
+            endRemoveRows();
+            last = -1;
+        }
+    }
 }
 
 void HistoryModel::checkEmptyParentItem(HistoryItem* item)
@@ -442,6 +549,13 @@ void HistoryModel::checkEmptyParentItem(HistoryItem* item)
     }
 }
 
+bool HistoryModel::matchesFilter(const HistoryEntry &entry) const
+{
+    return m_filterString.isEmpty() ||
+           entry.title.contains(m_filterString, Qt::CaseInsensitive) ||
+           entry.urlString.contains(m_filterString, Qt::CaseInsensitive);
+}
+
 void HistoryModel::init()
 {
     QSqlQuery query;
@@ -491,9 +605,21 @@ void HistoryModel::init()
         }
 
         QSqlQuery query;
-        query.prepare("SELECT id FROM history WHERE date BETWEEN ? AND ? LIMIT 1");
-        query.addBindValue(endTimestamp);
-        query.addBindValue(timestamp);
+
+        if (m_filterString.isEmpty()) {
+            query.prepare("SELECT id FROM history WHERE date BETWEEN ? AND ? LIMIT 1");
+            query.addBindValue(endTimestamp);
+            query.addBindValue(timestamp);
+        }
+        else {
+            const QString pattern = likePattern(m_filterString);
+            query.prepare("SELECT id FROM history WHERE date BETWEEN ? AND ? AND (title LIKE ? ESCAPE '\\' OR url LIKE ? ESCAPE '\\') LIMIT 1");
+            query.addBindValue(endTimestamp);
+            query.addBindValue(timestamp);
+            query.addBindValue(pattern);
+            query.addBindValue(pattern);
+        }
+
         query.exec();
 
         if (query.next()) {
@@ -535,30 +661,21 @@ void HistoryFilterModel::setFilterFixedString(const QString &pattern)
 
 void HistoryFilterModel::startFiltering()
 {
-    if (m_pattern.isEmpty()) {
-        emit collapseAllItems();
-        QSortFilterProxyModel::setFilterFixedString(m_pattern);
-        return;
-    }
+    HistoryModel* model = qobject_cast<HistoryModel*>(sourceModel());
+    Q_ASSERT(model);
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    // Expand all items also calls fetchmore
-    emit expandAllItems();
-
-    QSortFilterProxyModel::setFilterFixedString(m_pattern);
-
-    QApplication::restoreOverrideCursor();
-}
+    // Filtering is done in database, only matching entries are loaded
+    model->setFilterString(m_pattern);
 
-bool HistoryFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
-{
-    const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-
-    if (index.data(HistoryModel::IsTopLevelRole).toBool()) {
-        return true;
+    if (m_pattern.isEmpty()) {
+        emit collapseAllItems();
+    }
+    else {
+        // Expanding items also fetches first matching entries
+        emit expandAllItems();
     }
 
-    return (index.data(HistoryModel::UrlStringRole).toString().contains(m_pattern, Qt::CaseInsensitive) ||
-            index.data(HistoryModel::TitleRole).toString().contains(m_pattern, Qt::CaseInsensitive));
+    QApplication::restoreOverrideCursor();
 }
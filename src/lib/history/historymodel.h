@@ -20,6 +20,7 @@
 
 #include <QAbstractItemModel>
 #include <QSortFilterProxyModel>
+#include <QSet>
 
 #include "qzcommon.h"
 #include "history.h"
@@ -68,23 +69,30 @@ public:
 
     void removeTopLevelIndexes(const QList<QPersistentModelIndex> &indexes);
 
+    // Only entries with title or url containing string are loaded
+    QString filterString() const;
+    void setFilterString(const QString &string);
+
 signals:
 
 private slots:
     void resetHistory();
 
     void historyEntryAdded(const HistoryEntry &entry);
-    void historyEntryDeleted(const HistoryEntry &entry);
+    void historyEntriesDeleted(const QVector<HistoryEntry> &entries);
     void historyEntryEdited(const HistoryEntry &before, const HistoryEntry &after);
 
 private:
-    HistoryItem* findHistoryItem(const HistoryEntry &entry);
+    HistoryItem* findParentItem(const HistoryEntry &entry);
+    void removeChildItems(HistoryItem* parentItem, const QSet<int> &ids);
     void checkEmptyParentItem(HistoryItem* item);
+    bool matchesFilter(const HistoryEntry &entry) const;
     void init();
 
     HistoryItem* m_rootItem;
     HistoryItem* m_todayItem;
     History* m_history;
+    QString m_filterString;
 };
 
 class QUPZILLA_EXPORT HistoryFilterModel : public QSortFilterProxyModel
@@ -100,9 +108,6 @@ signals:
     void expandAllItems();
     void collapseAllItems();
 
-protected:
-    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
-
 private slots:
     void startFiltering();
 
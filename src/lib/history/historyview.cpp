@@ -23,6 +23,7 @@
 #include "iconprovider.h"
 
 #include <QClipboard>
+#include <QScrollBar>
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QMenu>
@@ -61,9 +62,35 @@ HistoryFilterModel* HistoryView::filterModel() const
     return m_filterModel;
 }
 
+void HistoryView::verticalScrollbarValueChanged(int value)
+{
+    QTreeView::verticalScrollbarValueChanged(value);
+
+    // Top level items are loaded in pages, load next page of every
+    // expanded item that was scrolled to the end
+    const QModelIndex bottomIndex = indexAt(QPoint(0, viewport()->height() - 1));
+    const QModelIndex bottomTopLevel = bottomIndex.parent().isValid() ? bottomIndex.parent() : bottomIndex;
+    const int lastRow = bottomTopLevel.isValid() ? bottomTopLevel.row() : model()->rowCount() - 1;
+
+    for (int row = 0; row <= lastRow; ++row) {
+        const QModelIndex index = model()->index(row, 0);
+
+        if (!isExpanded(index) || !model()->canFetchMore(index)) {
+            continue;
+        }
+
+        // Last visible item needs to be scrolled to its last loaded child
+        if (index == bottomTopLevel && (bottomIndex == bottomTopLevel || bottomIndex.row() < model()->rowCount(index) - 1)) {
+            continue;
+        }
+
+        model()->fetchMore(index);
+    }
+}
+
 void HistoryView::removeItems()
 {
-    QList<int> list;
+    QSet<int> ids;
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
     QList<QPersistentModelIndex> topLevelIndexes;
@@ -77,19 +104,18 @@ void HistoryView::removeItems()
             qint64 start = index.data(HistoryModel::TimestampStartRole).toLongLong();
             qint64 end = index.data(HistoryModel::TimestampEndRole).toLongLong();
 
-            list.append(m_history->indexesFromTimeRange(start, end));
+            foreach (int id, m_history->indexesFromTimeRange(start, end)) {
+                ids.insert(id);
+            }
 
             topLevelIndexes.append(index);
         }
         else {
-            int id = index.data(HistoryModel::IdRole).toInt();
-            if (!list.contains(id)) {
-                list.append(id);
-            }
+            ids.insert(index.data(HistoryModel::IdRole).toInt());
         }
     }
 
-    m_history->deleteHistoryEntry(list);
+    m_history->deleteHistoryEntry(ids.toList());
     m_history->model()->removeTopLevelIndexes(topLevelIndexes);
 
     QApplication::restoreOverrideCursor();
@@ -50,6 +50,9 @@ private slots:
     void copyTitle();
     void copyAddress();
 
+protected slots:
+    void verticalScrollbarValueChanged(int value);
+
 protected:
     void contextMenuEvent(QContextMenuEvent* event);
     void keyPressEvent(QKeyEvent* event);
@@ -84,17 +84,23 @@ SOURCES += \
     navigation/locationbarpopup.cpp \
     network/networkmanagerproxy.cpp \
     network/networkmanager.cpp \
+    network/networkcache.cpp \
+    network/networkinstrumentation.cpp \
+    network/requestinfo.cpp \
     other/updater.cpp \
     other/sourceviewer.cpp \
     preferences/preferences.cpp \
     rss/rssmanager.cpp \
+    rss/rssupdater.cpp \
     other/clearprivatedata.cpp \
+    other/clearprivatedatajob.cpp \
     webview/webpage.cpp \
     webview/tabwidget.cpp \
     webview/tabbar.cpp \
     webview/siteinfo.cpp \
     webview/searchtoolbar.cpp \
     app/commandlineoptions.cpp \
+    app/startuptimeline.cpp \
     other/aboutdialog.cpp \
     plugins/plugins.cpp \
     plugins/pluginproxy.cpp \
@@ -151,6 +157,8 @@ SOURCES += \
     tools/qztools.cpp \
     other/pagescreen.cpp \
     downloads/downloadfilehelper.cpp \
+    downloads/downloadsmodel.cpp \
+    downloads/downloaditemdelegate.cpp \
     tools/certificateinfowidget.cpp \
     webview/webinspectordockwidget.cpp \
     preferences/acceptlanguage.cpp \
@@ -171,6 +179,7 @@ SOURCES += \
     tools/followredirectreply.cpp \
     webview/webhistorywrapper.cpp \
     tools/pagethumbnailer.cpp \
+    tools/htmltemplate.cpp \
     plugins/speeddial.cpp \
     tools/enhancedmenu.cpp \
     navigation/siteicon.cpp \
@@ -282,17 +291,23 @@ HEADERS  += \
     navigation/locationbar.h \
     network/networkmanagerproxy.h \
     network/networkmanager.h \
+    network/networkcache.h \
+    network/networkinstrumentation.h \
+    network/requestinfo.h \
     other/updater.h \
     other/sourceviewer.h \
     preferences/preferences.h \
     rss/rssmanager.h \
+    rss/rssupdater.h \
     other/clearprivatedata.h \
+    other/clearprivatedatajob.h \
     webview/webpage.h \
     webview/tabwidget.h \
     webview/tabbar.h \
     webview/siteinfo.h \
     webview/searchtoolbar.h \
     app/commandlineoptions.h \
+    app/startuptimeline.h \
     other/aboutdialog.h \
     plugins/plugininterface.h \
     plugins/plugins.h \
@@ -349,6 +364,8 @@ HEADERS  += \
     tools/qztools.h \
     other/pagescreen.h \
     downloads/downloadfilehelper.h \
+    downloads/downloadsmodel.h \
+    downloads/downloaditemdelegate.h \
     tools/certificateinfowidget.h \
     webview/webinspectordockwidget.h \
     3rdparty/msvc2008.h \
@@ -370,6 +387,7 @@ HEADERS  += \
     tools/followredirectreply.h \
     webview/webhistorywrapper.h \
     tools/pagethumbnailer.h \
+    tools/htmltemplate.h \
     plugins/speeddial.h \
     tools/enhancedmenu.h \
     navigation/siteicon.h \
@@ -36,8 +36,10 @@ LocationCompleter::LocationCompleter(QObject* parent)
     : QObject(parent)
     , m_window(0)
     , m_locationBar(0)
-    , m_lastRefreshTimestamp(0)
     , m_popupClosed(false)
+    , m_refreshJob(0)
+    , m_hasPendingSearch(false)
+    , m_hasPreviousResults(false)
 {
     if (!s_view) {
         s_model = new LocationCompleterModel;
@@ -46,6 +48,16 @@ LocationCompleter::LocationCompleter(QObject* parent)
     }
 }
 
+LocationCompleter::~LocationCompleter()
+{
+    if (m_refreshJob) {
+        // Job deletes itself once it finishes
+        m_refreshJob->cancel();
+        disconnect(m_refreshJob, SIGNAL(finished()), this, SLOT(refreshJobFinished()));
+        connect(m_refreshJob, SIGNAL(finished()), m_refreshJob, SLOT(deleteLater()));
+    }
+}
+
 void LocationCompleter::setMainWindow(BrowserWindow* window)
 {
     m_window = window;
@@ -59,6 +71,12 @@ void LocationCompleter::setLocationBar(LocationBar* locationBar)
 void LocationCompleter::closePopup()
 {
     m_popupClosed = true;
+    m_hasPendingSearch = false;
+
+    if (m_refreshJob) {
+        m_refreshJob->cancel();
+    }
+
     s_view->close();
 }
 
@@ -70,8 +88,15 @@ void LocationCompleter::complete(const QString &string)
     // Eg. popup was not closed yet this completion session
     m_popupClosed = false;
 
-    LocationCompleterRefreshJob* job = new LocationCompleterRefreshJob(trimmedStr);
-    connect(job, SIGNAL(finished()), this, SLOT(refreshJobFinished()));
+    // Running job is canceled and the newest request is started once it finishes
+    if (m_refreshJob) {
+        m_refreshJob->cancel();
+        m_pendingSearchString = trimmedStr;
+        m_hasPendingSearch = true;
+        return;
+    }
+
+    startRefreshJob(trimmedStr);
 }
 
 void LocationCompleter::showMostVisited()
@@ -83,21 +108,37 @@ void LocationCompleter::refreshJobFinished()
 {
     LocationCompleterRefreshJob* job = qobject_cast<LocationCompleterRefreshJob*>(sender());
     Q_ASSERT(job);
+    Q_ASSERT(job == m_refreshJob);
 
-    // Don't show result of older jobs
-    // Also don't open the popup again when it was already closed
-    if (job->timestamp() > m_lastRefreshTimestamp && !m_popupClosed) {
-        s_model->setCompletions(job->completions());
-        m_lastRefreshTimestamp = job->timestamp();
-
-        showPopup();
+    m_refreshJob = 0;
+    job->deleteLater();
 
-        if (qzSettings->useInlineCompletion) {
-            emit showDomainCompletion(job->domainCompletion());
+    // Job is canceled when there is newer request or the popup was closed meanwhile
+    if (job->isCanceled()) {
+        if (m_hasPendingSearch) {
+            m_hasPendingSearch = false;
+            startRefreshJob(m_pendingSearchString);
         }
+        return;
     }
 
-    job->deleteLater();
+    if (job->isHistoryComplete() && !job->searchString().isEmpty()) {
+        m_previousSearchString = job->searchString();
+        m_previousHistory = job->historyEntries();
+        m_previousIcons = job->icons();
+        m_hasPreviousResults = true;
+    }
+    else {
+        clearPreviousResults();
+    }
+
+    s_model->setCompletions(job->completions());
+
+    showPopup();
+
+    if (qzSettings->useInlineCompletion) {
+        emit showDomainCompletion(job->domainCompletion());
+    }
 }
 
 void LocationCompleter::slotPopupClosed()
@@ -109,6 +150,8 @@ void LocationCompleter::slotPopupClosed()
     disconnect(s_view, SIGNAL(indexDeleteRequested(QModelIndex)), this, SLOT(indexDeleteRequested(QModelIndex)));
     disconnect(s_view->selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)), this, SLOT(currentChanged(QModelIndex)));
 
+    clearPreviousResults();
+
     emit popupClosed();
 }
 
@@ -210,6 +253,8 @@ void LocationCompleter::indexDeleteRequested(const QModelIndex &index)
         mApp->history()->deleteHistoryEntry(id);
     }
 
+    clearPreviousResults();
+
     s_view->setUpdatesEnabled(false);
     s_model->removeRow(index.row(), index.parent());
     s_view->setUpdatesEnabled(true);
@@ -257,6 +302,29 @@ void LocationCompleter::loadUrl(const QUrl &url)
     emit loadCompletion();
 }
 
+void LocationCompleter::startRefreshJob(const QString &searchString)
+{
+    Q_ASSERT(!m_refreshJob);
+
+    m_refreshJob = new LocationCompleterRefreshJob(searchString);
+    connect(m_refreshJob, SIGNAL(finished()), this, SLOT(refreshJobFinished()));
+
+    // All history entries matching longer search string are already in previous results
+    if (m_hasPreviousResults && searchString.startsWith(m_previousSearchString, Qt::CaseInsensitive)) {
+        m_refreshJob->setPreviousResults(m_previousHistory, m_previousIcons);
+    }
+
+    m_refreshJob->start();
+}
+
+void LocationCompleter::clearPreviousResults()
+{
+    m_previousSearchString.clear();
+    m_previousHistory.clear();
+    m_previousIcons.clear();
+    m_hasPreviousResults = false;
+}
+
 void LocationCompleter::showPopup()
 {
     Q_ASSERT(m_locationBar);
@@ -21,6 +21,7 @@
 #include <QObject>
 
 #include "qzcommon.h"
+#include "locationcompleterrefreshjob.h"
 
 class QUrl;
 class QModelIndex;
@@ -35,6 +36,7 @@ class QUPZILLA_EXPORT LocationCompleter : public QObject
     Q_OBJECT
 public:
     explicit LocationCompleter(QObject* parent = 0);
+    ~LocationCompleter();
 
     void setMainWindow(BrowserWindow* window);
     void setLocationBar(LocationBar* locationBar);
@@ -67,15 +69,28 @@ private:
     void switchToTab(BrowserWindow* window, int tab);
     void loadUrl(const QUrl &url);
 
+    void startRefreshJob(const QString &searchString);
+    void clearPreviousResults();
+
     void showPopup();
     void adjustPopupSize();
 
     BrowserWindow* m_window;
     LocationBar* m_locationBar;
-    qint64 m_lastRefreshTimestamp;
     QString m_originalText;
     bool m_popupClosed;
 
+    // Only one job is running at a time, newer requests are coalesced
+    LocationCompleterRefreshJob* m_refreshJob;
+    QString m_pendingSearchString;
+    bool m_hasPendingSearch;
+
+    // Complete history results of last job, used to narrow down longer searches
+    QString m_previousSearchString;
+    QVector<LocationCompleterRefreshJob::HistoryEntry> m_previousHistory;
+    QHash<QString, QImage> m_previousIcons;
+    bool m_hasPreviousResults;
+
     static LocationCompleterView* s_view;
     static LocationCompleterModel* s_model;
 };
@@ -106,19 +106,47 @@ QSqlQuery LocationCompleterModel::createDomainQuery(const QString &text)
     return sqlQuery;
 }
 
+static QString escapeLike(const QString &str)
+{
+    QString escaped = str;
+    escaped.replace(QLatin1Char('\\'), QLatin1String("\\\\"));
+    escaped.replace(QLatin1Char('%'), QLatin1String("\\%"));
+    escaped.replace(QLatin1Char('_'), QLatin1String("\\_"));
+    return QString("%%1%").arg(escaped);
+}
+
+static QString foldAsciiCase(const QString &str)
+{
+    QString folded = str;
+
+    for (int i = 0; i < folded.size(); ++i) {
+        const ushort c = folded.at(i).unicode();
+        if (c >= 'A' && c <= 'Z') {
+            folded[i] = QChar(c + ('a' - 'A'));
+        }
+    }
+
+    return folded;
+}
+
+bool LocationCompleterModel::matchesLike(const QString &text, const QString &str)
+{
+    return foldAsciiCase(text).contains(foldAsciiCase(str));
+}
+
 QSqlQuery LocationCompleterModel::createHistoryQuery(const QString &searchString, int limit, bool exactMatch)
 {
     QStringList searchList;
     QString query = QLatin1String("SELECT id, url, title, count FROM history WHERE ");
 
     if (exactMatch) {
-        query.append(QLatin1String("title LIKE ? OR url LIKE ? "));
+        query.append(QLatin1String("title LIKE ? ESCAPE '\\' OR url LIKE ? ESCAPE '\\' "));
     }
     else {
         searchList = searchString.split(QLatin1Char(' '), QString::SkipEmptyParts);
         const int slSize = searchList.size();
         for (int i = 0; i < slSize; ++i) {
-            query.append(QLatin1String("(title LIKE ? OR url LIKE ?) "));
+            query.append(QLatin1String("(title LIKE ? ESCAPE '\\' OR url LIKE ? ESCAPE '\\') "));
             if (i < slSize - 1) {
                 query.append(QLatin1String("AND "));
             }
@@ -130,14 +158,15 @@ QSqlQuery LocationCompleterModel::createHistoryQuery(const QString &searchString
     QSqlQuery sqlQuery;
     sqlQuery.prepare(query);
 
+    // Search string is matched literally, % and _ are not wildcards
     if (exactMatch) {
-        sqlQuery.addBindValue(QString("%%1%").arg(searchString));
-        sqlQuery.addBindValue(QString("%%1%").arg(searchString));
+        sqlQuery.addBindValue(escapeLike(searchString));
+        sqlQuery.addBindValue(escapeLike(searchString));
     }
     else {
         foreach (const QString &str, searchList) {
-            sqlQuery.addBindValue(QString("%%1%").arg(str));
-            sqlQuery.addBindValue(QString("%%1%").arg(str));
+            sqlQuery.addBindValue(escapeLike(str));
+            sqlQuery.addBindValue(escapeLike(str));
         }
     }
 
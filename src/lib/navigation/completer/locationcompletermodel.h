@@ -49,6 +49,10 @@ public:
     static QSqlQuery createHistoryQuery(const QString &searchString, int limit, bool exactMatch = false);
     static QSqlQuery createDomainQuery(const QString &text);
 
+    // Whether text matches search string in the same way as in history query.
+    // SQLite LIKE is case insensitive only for ASCII letters.
+    static bool matchesLike(const QString &text, const QString &str);
+
 private:
     enum Type {
         HistoryAndBookmarks = 0,
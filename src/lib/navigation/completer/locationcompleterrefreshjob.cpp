@@ -18,8 +18,8 @@
 #include "locationcompleterrefreshjob.h"
 #include "locationcompletermodel.h"
 #include "mainapplication.h"
-#include "bookmarkitem.h"
 #include "sqldatabase.h"
+#include "iconprovider.h"
 #include "qzsettings.h"
 #include "bookmarks.h"
 
@@ -35,14 +35,54 @@ LocationCompleterRefreshJob::LocationCompleterRefreshJob(const QString &searchSt
     : QObject()
     , m_timestamp(QDateTime::currentMSecsSinceEpoch())
     , m_searchString(searchString)
+    , m_canceled(0)
+    , m_derived(false)
+    , m_historyComplete(false)
 {
+    // Bookmarks are searched in snapshot, the tree itself may change meanwhile
+    m_bookmarks = mApp->bookmarks()->snapshot();
+
     m_watcher = new QFutureWatcher<void>(this);
     connect(m_watcher, SIGNAL(finished()), this, SLOT(slotFinished()));
+}
+
+LocationCompleterRefreshJob::~LocationCompleterRefreshJob()
+{
+    // Completions of canceled job are never passed to the model
+    if (isCanceled()) {
+        qDeleteAll(m_items);
+    }
+}
 
+void LocationCompleterRefreshJob::setPreviousResults(const QVector<HistoryEntry> &history, const QHash<QString, QImage> &icons)
+{
+    Q_ASSERT(!m_watcher->isRunning());
+
+    m_history = history;
+    m_icons = icons;
+    m_derived = true;
+}
+
+void LocationCompleterRefreshJob::start()
+{
     QFuture<void> future = QtConcurrent::run(this, &LocationCompleterRefreshJob::runJob);
     m_watcher->setFuture(future);
 }
 
+void LocationCompleterRefreshJob::cancel()
+{
+    m_canceled.fetchAndStoreOrdered(1);
+}
+
+bool LocationCompleterRefreshJob::isCanceled() const
+{
+#if QT_VERSION >= 0x050000
+    return m_canceled.load() != 0;
+#else
+    return m_canceled != 0;
+#endif
+}
+
 qint64 LocationCompleterRefreshJob::timestamp() const
 {
     return m_timestamp;
@@ -63,6 +103,21 @@ QString LocationCompleterRefreshJob::domainCompletion() const
     return m_domainCompletion;
 }
 
+bool LocationCompleterRefreshJob::isHistoryComplete() const
+{
+    return m_historyComplete;
+}
+
+QVector<LocationCompleterRefreshJob::HistoryEntry> LocationCompleterRefreshJob::historyEntries() const
+{
+    return m_history;
+}
+
+QHash<QString, QImage> LocationCompleterRefreshJob::icons() const
+{
+    return m_icons;
+}
+
 void LocationCompleterRefreshJob::slotFinished()
 {
     emit finished();
@@ -81,6 +136,11 @@ static bool countBiggerThan(const QStandardItem* i1, const QStandardItem* i2)
     return i1Bookmark;
 }
 
+static QString iconKey(const QUrl &url)
+{
+    return QString::fromUtf8(url.toEncoded(QUrl::RemoveFragment));
+}
+
 void LocationCompleterRefreshJob::runJob()
 {
     if (mApp->isClosing() || !mApp) {
@@ -94,18 +154,14 @@ void LocationCompleterRefreshJob::runJob()
         completeFromHistory();
     }
 
-    // Load all icons into QImage
-    foreach (QStandardItem* item, m_items) {
-        const QUrl url = item->data(LocationCompleterModel::UrlRole).toUrl();
+    if (isCanceled()) {
+        return;
+    }
 
-        QSqlQuery query;
-        query.prepare(QSL("SELECT icon FROM icons WHERE url LIKE ? LIMIT 1"));
-        query.addBindValue(QString(QL1S("%1%")).arg(QString::fromUtf8(url.toEncoded(QUrl::RemoveFragment))));
-        QSqlQuery res = SqlDatabase::instance()->exec(query);
+    loadIcons();
 
-        if (res.next()) {
-            item->setData(QImage::fromData(res.value(0).toByteArray()), LocationCompleterModel::ImageRole);
-        }
+    if (isCanceled()) {
+        return;
     }
 
     // Sort by count
@@ -126,6 +182,32 @@ void LocationCompleterRefreshJob::runJob()
     }
 }
 
+void LocationCompleterRefreshJob::loadIcons()
+{
+    // Load all icons into QImage, icons from previous results are reused
+    foreach (QStandardItem* item, m_items) {
+        if (isCanceled()) {
+            return;
+        }
+
+        const QString key = iconKey(item->data(LocationCompleterModel::UrlRole).toUrl());
+
+        if (!m_icons.contains(key)) {
+            QSqlQuery query;
+            query.prepare(QString(QL1S("SELECT %1 WHERE icons.url LIKE ? LIMIT 1")).arg(IconProvider::iconDataSource()));
+            query.addBindValue(QString(QL1S("%1%")).arg(key));
+            QSqlQuery res = SqlDatabase::instance()->exec(query);
+
+            m_icons.insert(key, res.next() ? QImage::fromData(res.value(0).toByteArray()) : QImage());
+        }
+
+        const QImage image = m_icons.value(key);
+        if (!image.isNull()) {
+            item->setData(image, LocationCompleterModel::ImageRole);
+        }
+    }
+}
+
 void LocationCompleterRefreshJob::completeFromHistory()
 {
     QList<QUrl> urlList;
@@ -134,51 +216,110 @@ void LocationCompleterRefreshJob::completeFromHistory()
     // Search in bookmarks
     if (showType == HistoryAndBookmarks || showType == Bookmarks) {
         const int bookmarksLimit = 10;
-        QList<BookmarkItem*> bookmarks = mApp->bookmarks()->searchBookmarks(m_searchString, bookmarksLimit);
-
-        foreach (BookmarkItem* bookmark, bookmarks) {
-            Q_ASSERT(bookmark->isUrl());
+        const QVector<BookmarksSnapshot::Entry> bookmarks = m_bookmarks->search(m_searchString, bookmarksLimit);
 
+        foreach (const BookmarksSnapshot::Entry &bookmark, bookmarks) {
             QStandardItem* item = new QStandardItem();
-            item->setText(bookmark->url().toEncoded());
+            item->setText(bookmark.url.toEncoded());
             item->setData(-1, LocationCompleterModel::IdRole);
-            item->setData(bookmark->title(), LocationCompleterModel::TitleRole);
-            item->setData(bookmark->url(), LocationCompleterModel::UrlRole);
-            item->setData(bookmark->visitCount(), LocationCompleterModel::CountRole);
+            item->setData(bookmark.title, LocationCompleterModel::TitleRole);
+            item->setData(bookmark.url, LocationCompleterModel::UrlRole);
+            item->setData(bookmark.visitCount, LocationCompleterModel::CountRole);
             item->setData(QVariant(true), LocationCompleterModel::BookmarkRole);
-            item->setData(QVariant::fromValue<void*>(static_cast<void*>(bookmark)), LocationCompleterModel::BookmarkItemRole);
+            item->setData(QVariant::fromValue<void*>(static_cast<void*>(bookmark.item)), LocationCompleterModel::BookmarkItemRole);
             item->setData(m_searchString, LocationCompleterModel::SearchStringRole);
 
-            urlList.append(bookmark->url());
+            urlList.append(bookmark.url);
             m_items.append(item);
         }
     }
 
+    if (isCanceled()) {
+        return;
+    }
+
     // Search in history
     if (showType == HistoryAndBookmarks || showType == History) {
         const int historyLimit = 20;
-        QSqlQuery query = LocationCompleterModel::createHistoryQuery(m_searchString, historyLimit);
-        QSqlQuery res = SqlDatabase::instance()->exec(query);
 
-        while (res.next()) {
-            const QUrl url = res.value(1).toUrl();
+        if (m_derived) {
+            filterHistoryEntries(historyLimit);
+        }
+        else {
+            loadHistoryEntries(historyLimit);
+        }
 
-            if (urlList.contains(url)) {
+        foreach (const HistoryEntry &entry, m_history) {
+            if (urlList.contains(entry.url)) {
                 continue;
             }
 
             QStandardItem* item = new QStandardItem();
-            item->setText(url.toEncoded());
-            item->setData(res.value(0), LocationCompleterModel::IdRole);
-            item->setData(res.value(2), LocationCompleterModel::TitleRole);
-            item->setData(url, LocationCompleterModel::UrlRole);
-            item->setData(res.value(3), LocationCompleterModel::CountRole);
+            item->setText(entry.url.toEncoded());
+            item->setData(entry.id, LocationCompleterModel::IdRole);
+            item->setData(entry.title, LocationCompleterModel::TitleRole);
+            item->setData(entry.url, LocationCompleterModel::UrlRole);
+            item->setData(entry.count, LocationCompleterModel::CountRole);
             item->setData(QVariant(false), LocationCompleterModel::BookmarkRole);
             item->setData(m_searchString, LocationCompleterModel::SearchStringRole);
 
             m_items.append(item);
         }
     }
+    else {
+        m_historyComplete = true;
+    }
+}
+
+void LocationCompleterRefreshJob::loadHistoryEntries(int limit)
+{
+    QSqlQuery query = LocationCompleterModel::createHistoryQuery(m_searchString, limit);
+    QSqlQuery res = SqlDatabase::instance()->exec(query);
+
+    while (res.next()) {
+        HistoryEntry entry;
+        entry.id = res.value(0).toInt();
+        entry.url = res.value(1).toUrl();
+        entry.title = res.value(2).toString();
+        entry.count = res.value(3).toInt();
+        m_history.append(entry);
+    }
+
+    // Query returned less than limit, so there are no more matching entries
+    m_historyComplete = m_history.count() < limit;
+}
+
+void LocationCompleterRefreshJob::filterHistoryEntries(int limit)
+{
+    // Every entry matching the longer search string also matched the previous
+    // (shorter) one, so the complete previous results contain all matches.
+    // Same matching as in LocationCompleterModel::createHistoryQuery
+    const QStringList searchList = m_searchString.split(QLatin1Char(' '), QString::SkipEmptyParts);
+
+    QVector<HistoryEntry> filtered;
+
+    foreach (const HistoryEntry &entry, m_history) {
+        const QString url = entry.url.toString();
+        bool matches = true;
+
+        foreach (const QString &str, searchList) {
+            if (!LocationCompleterModel::matchesLike(entry.title, str) && !LocationCompleterModel::matchesLike(url, str)) {
+                matches = false;
+                break;
+            }
+        }
+
+        if (matches) {
+            filtered.append(entry);
+
+            if (filtered.count() == limit) {
+                break;
+            }
+        }
+    }
+
+    m_history = filtered;
+    m_historyComplete = m_history.count() < limit;
 }
 
 void LocationCompleterRefreshJob::completeMostVisited()
@@ -199,7 +340,6 @@ void LocationCompleterRefreshJob::completeMostVisited()
         m_items.append(item);
     }
 }
-
 QString LocationCompleterRefreshJob::createDomainCompletion(const QString &completion) const
 {
     // Make sure search string and completion matches
@@ -19,8 +19,14 @@
 #define LOCATIONCOMPLETERREFRESHJOB_H
 
 #include <QFutureWatcher>
+#include <QAtomicInt>
+#include <QVector>
+#include <QImage>
+#include <QHash>
+#include <QUrl>
 
 #include "qzcommon.h"
+#include "bookmarks.h"
 
 class QStandardItem;
 
@@ -29,7 +35,25 @@ class QUPZILLA_EXPORT LocationCompleterRefreshJob : public QObject
     Q_OBJECT
 
 public:
+    struct HistoryEntry {
+        int id;
+        QUrl url;
+        QString title;
+        int count;
+    };
+
     explicit LocationCompleterRefreshJob(const QString &searchString);
+    ~LocationCompleterRefreshJob();
+
+    // Results of previous job with shorter search string, history
+    // completions will be filtered from it instead of querying database
+    void setPreviousResults(const QVector<HistoryEntry> &history, const QHash<QString, QImage> &icons);
+
+    void start();
+
+    // Cancellation is checked between individual phases of the job
+    void cancel();
+    bool isCanceled() const;
 
     // Timestamp when the job was created
     qint64 timestamp() const;
@@ -38,6 +62,12 @@ public:
     QList<QStandardItem*> completions() const;
     QString domainCompletion() const;
 
+    // Whether historyEntries() contains all matching entries (not limited)
+    bool isHistoryComplete() const;
+
+    QVector<HistoryEntry> historyEntries() const;
+    QHash<QString, QImage> icons() const;
+
 signals:
     void finished();
 
@@ -55,6 +85,9 @@ private:
     void runJob();
     void completeFromHistory();
     void completeMostVisited();
+    void loadHistoryEntries(int limit);
+    void filterHistoryEntries(int limit);
+    void loadIcons();
 
     QString createDomainCompletion(const QString &completion) const;
 
@@ -63,6 +96,13 @@ private:
     QString m_domainCompletion;
     QList<QStandardItem*> m_items;
     QFutureWatcher<void>* m_watcher;
+    QSharedPointer<const BookmarksSnapshot> m_bookmarks;
+
+    QAtomicInt m_canceled;
+    bool m_derived;
+    bool m_historyComplete;
+    QVector<HistoryEntry> m_history;
+    QHash<QString, QImage> m_icons;
 };
 
 #endif // LOCATIONCOMPLETERREFRESHJOB_H
@@ -0,0 +1,728 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "networkcache.h"
+#include "autosaver.h"
+#include "qztools.h"
+
+#include <QDir>
+#include <QFile>
+#include <QBuffer>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QDirIterator>
+#include <QTemporaryFile>
+#include <QCryptographicHash>
+#include <QDebug>
+
+#define ENTRY_MAGIC quint32(0x51437a45)
+#define INDEX_MAGIC quint32(0x51437a49)
+// Format of index and entry files, entries of other versions are removed when accessed
+#define CACHE_VERSION qint32(2)
+#define STREAM_VERSION QDataStream::Qt_4_8
+
+// Resources up to this size are also kept in memory
+#define MAX_MEMORY_ITEM_SIZE (16 * 1024)
+#define MEMORY_CACHE_SIZE (4 * 1024 * 1024)
+
+NetworkCache::NetworkCache(QObject* parent)
+    : QAbstractNetworkCache(parent)
+    , m_maximumCacheSize(50 * 1024 * 1024)
+    , m_currentCacheSize(0)
+    , m_accessCounter(0)
+    , m_autoSaver(new AutoSaver(this))
+    , m_indexChanged(false)
+    , m_indexOnDisk(false)
+{
+    m_memoryCache.setMaxCost(MEMORY_CACHE_SIZE);
+
+    connect(m_autoSaver, SIGNAL(save()), this, SLOT(saveIndex()));
+}
+
+NetworkCache::~NetworkCache()
+{
+    m_autoSaver->saveIfNecessary();
+
+    // Changes of access order alone are only saved here
+    saveIndex();
+}
+
+QString NetworkCache::cacheDirectory() const
+{
+    return m_cacheDirectory;
+}
+
+void NetworkCache::setCacheDirectory(const QString &path)
+{
+    // Old directory may have been moved away, don't recreate it just to save the index
+    if (m_indexChanged && !m_cacheDirectory.isEmpty() && QDir(m_cacheDirectory).exists()) {
+        saveIndex();
+    }
+
+    m_cacheDirectory = QDir::cleanPath(QDir(path).absolutePath()) + QLatin1Char('/');
+
+    m_index.clear();
+    m_lru.clear();
+    m_memoryCache.clear();
+    m_currentCacheSize = 0;
+    m_accessCounter = 0;
+    m_indexChanged = false;
+    m_indexOnDisk = false;
+
+    QDir().mkpath(m_cacheDirectory + QLatin1String("prepared"));
+
+    loadIndex();
+}
+
+qint64 NetworkCache::maximumCacheSize() const
+{
+    return m_maximumCacheSize;
+}
+
+void NetworkCache::setMaximumCacheSize(qint64 size)
+{
+    m_maximumCacheSize = size;
+
+    expire();
+}
+
+NetworkCache::Statistics NetworkCache::statistics() const
+{
+    Statistics stats = m_stats;
+    stats.entries = m_index.count();
+    stats.size = m_currentCacheSize;
+    stats.memoryEntries = m_memoryCache.count();
+    stats.memorySize = m_memoryCache.totalCost();
+
+    return stats;
+}
+
+QNetworkCacheMetaData NetworkCache::metaData(const QUrl &url)
+{
+    const QByteArray key = cacheKey(url);
+
+    if (MemoryItem* item = m_memoryCache.object(key)) {
+        touchEntry(key);
+        return item->metaData;
+    }
+
+    // Misses are counted here, as every network request looks up metadata first.
+    // Hits are counted in data() which is only called when the entry is used.
+    if (!m_index.contains(key)) {
+        ++m_stats.misses;
+        return QNetworkCacheMetaData();
+    }
+
+    // Data of small entries is most likely going to be requested right after metadata
+    const bool readData = m_index.value(key).size <= MAX_MEMORY_ITEM_SIZE;
+
+    QNetworkCacheMetaData metaData;
+    QByteArray data;
+
+    if (!readEntry(key, &metaData, readData ? &data : 0)) {
+        removeEntry(key);
+        ++m_stats.misses;
+        return QNetworkCacheMetaData();
+    }
+
+    if (readData) {
+        addMemoryItem(key, metaData, data);
+    }
+
+    touchEntry(key);
+    return metaData;
+}
+
+void NetworkCache::updateMetaData(const QNetworkCacheMetaData &metaData)
+{
+    const QByteArray key = cacheKey(metaData.url());
+
+    if (!m_index.contains(key)) {
+        return;
+    }
+
+    if (!metaData.isValid() || !metaData.saveToDisk()) {
+        removeEntry(key);
+        return;
+    }
+
+    MemoryItem* item = m_memoryCache.object(key);
+    QByteArray data;
+
+    if (item) {
+        data = item->data;
+    }
+    else {
+        QNetworkCacheMetaData oldMetaData;
+        if (!readEntry(key, &oldMetaData, &data)) {
+            removeEntry(key);
+            return;
+        }
+    }
+
+    const qint64 size = writeEntry(key, metaData, data);
+    if (size < 0) {
+        removeEntry(key);
+        return;
+    }
+
+    if (item) {
+        item->metaData = metaData;
+    }
+
+    IndexEntry &entry = m_index[key];
+    m_currentCacheSize += size - entry.size;
+    entry.size = size;
+
+    indexChanged(true);
+}
+
+QIODevice* NetworkCache::data(const QUrl &url)
+{
+    const QByteArray key = cacheKey(url);
+
+    if (MemoryItem* item = m_memoryCache.object(key)) {
+        ++m_stats.hits;
+        ++m_stats.memoryHits;
+        m_stats.bytesRead += item->data.size();
+        touchEntry(key);
+
+        QBuffer* buffer = new QBuffer;
+        buffer->setData(item->data);
+        buffer->open(QIODevice::ReadOnly);
+        return buffer;
+    }
+
+    // Miss of entry that is not in index was already counted in metaData()
+    if (!m_index.contains(key)) {
+        return 0;
+    }
+
+    QFile* file = new QFile(entryPath(key));
+    QNetworkCacheMetaData metaData;
+
+    if (!openEntry(file, &metaData)) {
+        delete file;
+        removeEntry(key);
+        ++m_stats.misses;
+        return 0;
+    }
+
+    ++m_stats.hits;
+    touchEntry(key);
+
+    // Small entries are moved to memory, bigger ones are read directly from
+    // the file positioned after metadata. The file is not mapped with QFile::map,
+    // entries are never rewritten in place, so reading isn't affected by updates.
+    if (m_index.value(key).size <= MAX_MEMORY_ITEM_SIZE) {
+        const QByteArray data = file->readAll();
+        delete file;
+
+        addMemoryItem(key, metaData, data);
+        m_stats.bytesRead += data.size();
+
+        QBuffer* buffer = new QBuffer;
+        buffer->setData(data);
+        buffer->open(QIODevice::ReadOnly);
+        return buffer;
+    }
+
+    m_stats.bytesRead += file->size() - file->pos();
+    return file;
+}
+
+bool NetworkCache::remove(const QUrl &url)
+{
+    const QByteArray key = cacheKey(url);
+
+    // Prepared devices of aborted downloads are removed here
+    QMutableHashIterator<QIODevice*, QNetworkCacheMetaData> it(m_preparedItems);
+    while (it.hasNext()) {
+        it.next();
+        if (cacheKey(it.value().url()) == key) {
+            QIODevice* device = it.key();
+            it.remove();
+            delete device;
+        }
+    }
+
+    return removeEntry(key);
+}
+
+qint64 NetworkCache::cacheSize() const
+{
+    return m_currentCacheSize;
+}
+
+QIODevice* NetworkCache::prepare(const QNetworkCacheMetaData &metaData)
+{
+    if (m_cacheDirectory.isEmpty() || !metaData.isValid() || !metaData.url().isValid() || !metaData.saveToDisk()) {
+        return 0;
+    }
+
+    qint64 size = -1;
+
+    foreach (const QNetworkCacheMetaData::RawHeader &header, metaData.rawHeaders()) {
+        if (header.first.toLower() == "content-length") {
+            size = header.second.toLongLong();
+            break;
+        }
+    }
+
+    // Same limit as in QNetworkDiskCache
+    if (size > m_maximumCacheSize * 3 / 4) {
+        return 0;
+    }
+
+    QIODevice* device = 0;
+
+    // Small resources are buffered in memory, bigger ones are written
+    // directly to file that only gets renamed when inserting
+    if (size >= 0 && size <= MAX_MEMORY_ITEM_SIZE) {
+        QBuffer* buffer = new QBuffer(this);
+        buffer->open(QIODevice::ReadWrite);
+        device = buffer;
+    }
+    else {
+        QTemporaryFile* file = new QTemporaryFile(m_cacheDirectory + QLatin1String("prepared/XXXXXX"), this);
+        if (!file->open()) {
+            delete file;
+            return 0;
+        }
+
+        QDataStream stream(file);
+        stream.setVersion(STREAM_VERSION);
+        stream << ENTRY_MAGIC << CACHE_VERSION << metaData;
+        device = file;
+    }
+
+    m_preparedItems.insert(device, metaData);
+    return device;
+}
+
+void NetworkCache::insert(QIODevice* device)
+{
+    if (!m_preparedItems.contains(device)) {
+        return;
+    }
+
+    const QNetworkCacheMetaData metaData = m_preparedItems.take(device);
+    const QByteArray key = cacheKey(metaData.url());
+    qint64 size = -1;
+
+    removeEntry(key);
+
+    if (QBuffer* buffer = qobject_cast<QBuffer*>(device)) {
+        size = writeEntry(key, metaData, buffer->data());
+
+        if (size >= 0) {
+            addMemoryItem(key, metaData, buffer->data());
+        }
+    }
+    else if (QTemporaryFile* file = qobject_cast<QTemporaryFile*>(device)) {
+        const QString path = entryPath(key);
+        const QString tempPath = file->fileName();
+
+        file->setAutoRemove(false);
+        file->close();
+
+        QDir().mkpath(QFileInfo(path).absolutePath());
+
+        if (QFile::rename(tempPath, path)) {
+            size = QFileInfo(path).size();
+        }
+        else {
+            QFile::remove(tempPath);
+        }
+    }
+
+    delete device;
+
+    if (size < 0) {
+        return;
+    }
+
+    addEntry(key, size);
+    m_stats.bytesWritten += size;
+
+    expire();
+}
+
+void NetworkCache::clear()
+{
+    m_index.clear();
+    m_lru.clear();
+    m_memoryCache.clear();
+    m_currentCacheSize = 0;
+
+    if (m_cacheDirectory.isEmpty()) {
+        return;
+    }
+
+    // Everything except files of running downloads is removed, including
+    // files left by other cache implementations
+    QDir dir(m_cacheDirectory);
+    const QFileInfoList list = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+
+    foreach (const QFileInfo &info, list) {
+        if (info.isDir()) {
+            if (info.fileName() != QLatin1String("prepared")) {
+                QzTools::removeDir(info.absoluteFilePath());
+            }
+        }
+        else {
+            QFile::remove(info.absoluteFilePath());
+        }
+    }
+
+    m_indexOnDisk = false;
+    indexChanged(true);
+}
+
+void NetworkCache::saveIndex()
+{
+    if (!m_indexChanged || m_cacheDirectory.isEmpty()) {
+        return;
+    }
+
+    const QString path = indexPath();
+    QFile file(path + QLatin1String(".new"));
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "NetworkCache: Cannot open index file for writing" << file.fileName();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+    stream << INDEX_MAGIC << CACHE_VERSION << m_accessCounter << quint32(m_index.count());
+
+    QHash<QByteArray, IndexEntry>::const_iterator i = m_index.constBegin();
+    while (i != m_index.constEnd()) {
+        stream << i.key() << i.value().size << i.value().lastAccess;
+        ++i;
+    }
+
+    file.close();
+
+    QFile::remove(path);
+    if (file.error() != QFile::NoError || !file.rename(path)) {
+        qWarning() << "NetworkCache: Cannot save index file" << path;
+        file.remove();
+        return;
+    }
+
+    m_indexChanged = false;
+    m_indexOnDisk = true;
+}
+
+QByteArray NetworkCache::cacheKey(const QUrl &url) const
+{
+    QUrl cleanUrl = url;
+    cleanUrl.setPassword(QString());
+    cleanUrl.setFragment(QString());
+
+    return QCryptographicHash::hash(cleanUrl.toEncoded(), QCryptographicHash::Sha1);
+}
+
+QString NetworkCache::entryPath(const QByteArray &key) const
+{
+    const QString name = QString::fromLatin1(key.toHex());
+    return m_cacheDirectory + QLatin1String("entries/") + name.left(2) + QLatin1Char('/') + name;
+}
+
+QString NetworkCache::indexPath() const
+{
+    return m_cacheDirectory + QLatin1String("index");
+}
+
+void NetworkCache::loadIndex()
+{
+    QFile file(indexPath());
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        rebuildIndex();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+    quint32 magic;
+    qint32 version;
+    quint32 count;
+
+    stream >> magic >> version >> m_accessCounter >> count;
+
+    if (stream.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != CACHE_VERSION) {
+        rebuildIndex();
+        return;
+    }
+
+    for (quint32 i = 0; i < count; ++i) {
+        QByteArray key;
+        IndexEntry entry;
+        stream >> key >> entry.size >> entry.lastAccess;
+
+        if (stream.status() != QDataStream::Ok) {
+            rebuildIndex();
+            return;
+        }
+
+        m_index.insert(key, entry);
+        m_lru.insert(entry.lastAccess, key);
+        m_currentCacheSize += entry.size;
+    }
+
+    m_indexOnDisk = true;
+}
+
+void NetworkCache::rebuildIndex()
+{
+    m_index.clear();
+    m_lru.clear();
+    m_currentCacheSize = 0;
+    m_accessCounter = 0;
+
+    // Index file is missing only after crash, so files of unfinished downloads can be removed
+    QDirIterator prepared(m_cacheDirectory + QLatin1String("prepared"), QDir::Files);
+    while (prepared.hasNext()) {
+        QFile::remove(prepared.next());
+    }
+
+    // Files of QNetworkDiskCache (data8/ directory) used with the same cache directory
+    // in older versions would never be expired, so they are removed with everything
+    // else that is not an entry
+    QDir dir(m_cacheDirectory);
+    const QFileInfoList list = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+
+    foreach (const QFileInfo &info, list) {
+        if (info.fileName() == QLatin1String("prepared") || info.fileName() == QLatin1String("entries")) {
+            continue;
+        }
+
+        if (info.isDir()) {
+            QzTools::removeDir(info.absoluteFilePath());
+        }
+        else {
+            QFile::remove(info.absoluteFilePath());
+        }
+    }
+
+    // Modification time is the best guess of last access
+    QMultiMap<qint64, QPair<QByteArray, qint64> > entries;
+
+    QDirIterator it(m_cacheDirectory + QLatin1String("entries"), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        const QByteArray key = QByteArray::fromHex(info.fileName().toLatin1());
+
+        if (key.size() != 20) {
+            QFile::remove(info.absoluteFilePath());
+            continue;
+        }
+
+        entries.insert(info.lastModified().toMSecsSinceEpoch(), qMakePair(key, info.size()));
+    }
+
+    QMultiMap<qint64, QPair<QByteArray, qint64> >::const_iterator i = entries.constBegin();
+    while (i != entries.constEnd()) {
+        IndexEntry entry;
+        entry.size = i.value().second;
+        entry.lastAccess = ++m_accessCounter;
+
+        m_index.insert(i.value().first, entry);
+        m_lru.insert(entry.lastAccess, i.value().first);
+        m_currentCacheSize += entry.size;
+        ++i;
+    }
+
+    if (!m_index.isEmpty()) {
+        indexChanged(false);
+    }
+}
+
+void NetworkCache::indexChanged(bool structural)
+{
+    // Outdated index file is removed, so it gets rebuilt if we crash before saving it
+    if (structural && m_indexOnDisk) {
+        QFile::remove(indexPath());
+        m_indexOnDisk = false;
+    }
+
+    m_indexChanged = true;
+    m_autoSaver->changeOcurred();
+}
+
+bool NetworkCache::openEntry(QFile* file, QNetworkCacheMetaData* metaData)
+{
+    if (!file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(file);
+    stream.setVersion(STREAM_VERSION);
+    quint32 magic;
+    qint32 version;
+
+    stream >> magic >> version;
+
+    if (stream.status() != QDataStream::Ok || magic != ENTRY_MAGIC || version != CACHE_VERSION) {
+        return false;
+    }
+
+    stream >> *metaData;
+
+    return stream.status() == QDataStream::Ok && metaData->isValid();
+}
+
+bool NetworkCache::readEntry(const QByteArray &key, QNetworkCacheMetaData* metaData, QByteArray* data)
+{
+    QFile file(entryPath(key));
+
+    if (!openEntry(&file, metaData)) {
+        return false;
+    }
+
+    if (data) {
+        *data = file.readAll();
+    }
+
+    return true;
+}
+
+qint64 NetworkCache::writeEntry(const QByteArray &key, const QNetworkCacheMetaData &metaData, const QByteArray &data)
+{
+    const QString path = entryPath(key);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // Entry is written to new file and renamed, so devices returned
+    // from data() can still read the old file
+    QTemporaryFile file(m_cacheDirectory + QLatin1String("prepared/XXXXXX"));
+
+    if (!file.open()) {
+        return -1;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+    stream << ENTRY_MAGIC << CACHE_VERSION << metaData;
+    file.write(data);
+
+    const qint64 size = file.size();
+    const QString tempPath = file.fileName();
+
+    file.close();
+
+    if (file.error() != QFile::NoError) {
+        return -1;
+    }
+
+    file.setAutoRemove(false);
+
+    QFile::remove(path);
+    if (!QFile::rename(tempPath, path)) {
+        QFile::remove(tempPath);
+        return -1;
+    }
+
+    return size;
+}
+
+void NetworkCache::addEntry(const QByteArray &key, qint64 size)
+{
+    IndexEntry entry;
+    entry.size = size;
+    entry.lastAccess = ++m_accessCounter;
+
+    m_index.insert(key, entry);
+    m_lru.insert(entry.lastAccess, key);
+    m_currentCacheSize += size;
+
+    indexChanged(true);
+}
+
+bool NetworkCache::removeEntry(const QByteArray &key)
+{
+    m_memoryCache.remove(key);
+
+    QHash<QByteArray, IndexEntry>::iterator it = m_index.find(key);
+    if (it == m_index.end()) {
+        return false;
+    }
+
+    m_currentCacheSize -= it.value().size;
+    m_lru.remove(it.value().lastAccess);
+    m_index.erase(it);
+
+    QFile::remove(entryPath(key));
+
+    indexChanged(true);
+    return true;
+}
+
+void NetworkCache::touchEntry(const QByteArray &key)
+{
+    QHash<QByteArray, IndexEntry>::iterator it = m_index.find(key);
+    if (it == m_index.end()) {
+        return;
+    }
+
+    m_lru.remove(it.value().lastAccess);
+    it.value().lastAccess = ++m_accessCounter;
+    m_lru.insert(it.value().lastAccess, key);
+
+    // Not worth saving the whole index with each hit, access order
+    // is saved together with next structural change or on exit
+    m_indexChanged = true;
+}
+
+void NetworkCache::addMemoryItem(const QByteArray &key, const QNetworkCacheMetaData &metaData, const QByteArray &data)
+{
+    if (data.size() > MAX_MEMORY_ITEM_SIZE) {
+        return;
+    }
+
+    MemoryItem* item = new MemoryItem;
+    item->metaData = metaData;
+    item->data = data;
+
+    // Cost includes rough estimate of metadata size
+    m_memoryCache.insert(key, item, data.size() + 1024);
+}
+
+void NetworkCache::expire()
+{
+    if (m_currentCacheSize <= m_maximumCacheSize) {
+        return;
+    }
+
+    // Some more space is freed, so it doesn't need to expire with each insert
+    const qint64 goal = m_maximumCacheSize * 9 / 10;
+
+    while (m_currentCacheSize > goal && !m_lru.isEmpty()) {
+        const QByteArray key = m_lru.constBegin().value();
+
+        if (!removeEntry(key)) {
+            m_lru.erase(m_lru.begin());
+            continue;
+        }
+
+        ++m_stats.evictions;
+    }
+}
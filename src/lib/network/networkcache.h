@@ -0,0 +1,133 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef NETWORKCACHE_H
+#define NETWORKCACHE_H
+
+#include <QAbstractNetworkCache>
+#include <QCache>
+#include <QHash>
+#include <QMap>
+
+#include "qzcommon.h"
+
+class QFile;
+
+class AutoSaver;
+
+// Disk cache keeping an index of all entries in memory (persisted in index file),
+// so lookups don't touch the filesystem for missing entries and expiring
+// is done in LRU order without scanning the cache directory.
+// Small resources are additionally kept in memory.
+class QUPZILLA_EXPORT NetworkCache : public QAbstractNetworkCache
+{
+    Q_OBJECT
+
+public:
+    struct Statistics {
+        qint64 hits;
+        qint64 memoryHits;
+        qint64 misses;
+        qint64 bytesRead;
+        qint64 bytesWritten;
+        qint64 evictions;
+
+        int entries;
+        qint64 size;
+        int memoryEntries;
+        qint64 memorySize;
+
+        Statistics()
+            : hits(0), memoryHits(0), misses(0), bytesRead(0), bytesWritten(0), evictions(0)
+            , entries(0), size(0), memoryEntries(0), memorySize(0) {
+        }
+    };
+
+    explicit NetworkCache(QObject* parent = 0);
+    ~NetworkCache();
+
+    QString cacheDirectory() const;
+    void setCacheDirectory(const QString &path);
+
+    qint64 maximumCacheSize() const;
+    void setMaximumCacheSize(qint64 size);
+
+    Statistics statistics() const;
+
+    QNetworkCacheMetaData metaData(const QUrl &url);
+    void updateMetaData(const QNetworkCacheMetaData &metaData);
+    QIODevice* data(const QUrl &url);
+    bool remove(const QUrl &url);
+    qint64 cacheSize() const;
+
+    QIODevice* prepare(const QNetworkCacheMetaData &metaData);
+    void insert(QIODevice* device);
+
+public slots:
+    void clear();
+
+private slots:
+    void saveIndex();
+
+private:
+    struct IndexEntry {
+        qint64 size;
+        quint64 lastAccess;
+    };
+
+    struct MemoryItem {
+        QNetworkCacheMetaData metaData;
+        QByteArray data;
+    };
+
+    QByteArray cacheKey(const QUrl &url) const;
+    QString entryPath(const QByteArray &key) const;
+    QString indexPath() const;
+
+    void loadIndex();
+    void rebuildIndex();
+    void indexChanged(bool structural);
+
+    bool openEntry(QFile* file, QNetworkCacheMetaData* metaData);
+    bool readEntry(const QByteArray &key, QNetworkCacheMetaData* metaData, QByteArray* data);
+    qint64 writeEntry(const QByteArray &key, const QNetworkCacheMetaData &metaData, const QByteArray &data);
+
+    void addEntry(const QByteArray &key, qint64 size);
+    bool removeEntry(const QByteArray &key);
+    void touchEntry(const QByteArray &key);
+    void addMemoryItem(const QByteArray &key, const QNetworkCacheMetaData &metaData, const QByteArray &data);
+    void expire();
+
+    QString m_cacheDirectory;
+    qint64 m_maximumCacheSize;
+    qint64 m_currentCacheSize;
+
+    QHash<QByteArray, IndexEntry> m_index;
+    QMap<quint64, QByteArray> m_lru;
+    quint64 m_accessCounter;
+
+    QCache<QByteArray, MemoryItem> m_memoryCache;
+    QHash<QIODevice*, QNetworkCacheMetaData> m_preparedItems;
+
+    AutoSaver* m_autoSaver;
+    bool m_indexChanged;
+    bool m_indexOnDisk;
+
+    Statistics m_stats;
+};
+
+#endif // NETWORKCACHE_H
@@ -0,0 +1,361 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "networkinstrumentation.h"
+#include "webpage.h"
+#include "json.h"
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+// Only the most recent finished requests are kept
+#define MAX_FINISHED_REQUESTS 2000
+
+// Tabs and hosts with the least requests are dropped over this limit
+#define MAX_AGGREGATES 500
+
+// Json can't serialize 64-bit integers
+static QVariant jsonNumber(qint64 value)
+{
+    return QVariant(double(value));
+}
+
+static QVariantMap aggregateToMap(const NetworkInstrumentation::Aggregate &aggregate)
+{
+    QVariantMap map;
+    map.insert(QSL("requests"), aggregate.requests);
+    map.insert(QSL("failed"), aggregate.failed);
+    map.insert(QSL("fromCache"), aggregate.fromCache);
+    map.insert(QSL("bytesReceived"), jsonNumber(aggregate.bytesReceived));
+    map.insert(QSL("bytesSent"), jsonNumber(aggregate.bytesSent));
+    map.insert(QSL("dispatchTime"), jsonNumber(aggregate.dispatchTime));
+    map.insert(QSL("totalTime"), jsonNumber(aggregate.totalTime));
+    map.insert(QSL("responseTime"), jsonNumber(aggregate.responseTime));
+    map.insert(QSL("responses"), aggregate.responses);
+
+    return map;
+}
+
+template <typename Key>
+static NetworkInstrumentation::Aggregate &aggregateFor(QHash<Key, NetworkInstrumentation::Aggregate> &hash, const Key &key)
+{
+    typedef typename QHash<Key, NetworkInstrumentation::Aggregate>::iterator Iterator;
+
+    if (!hash.contains(key) && hash.count() >= MAX_AGGREGATES) {
+        Iterator least = hash.begin();
+        for (Iterator it = hash.begin(); it != hash.end(); ++it) {
+            if (it.value().requests < least.value().requests) {
+                least = it;
+            }
+        }
+        hash.erase(least);
+    }
+
+    return hash[key];
+}
+
+qint64 NetworkInstrumentation::Dispatch::total() const
+{
+    return qMax(schemeHandlers, qint64(0)) + qMax(plugins, qint64(0)) + qMax(adBlock, qint64(0));
+}
+
+NetworkInstrumentation::Request::Request()
+    : pageId(0)
+    , operation(QNetworkAccessManager::GetOperation)
+    , source(NetworkSource)
+    , started(0)
+    , encrypted(-1)
+    , responseHeaders(-1)
+    , firstByte(-1)
+    , finished(-1)
+    , bytesReceived(0)
+    , bytesSent(0)
+    , statusCode(0)
+    , fromCache(false)
+    , failed(false)
+{
+}
+
+NetworkInstrumentation::Aggregate::Aggregate()
+    : requests(0)
+    , failed(0)
+    , fromCache(0)
+    , bytesReceived(0)
+    , bytesSent(0)
+    , dispatchTime(0)
+    , totalTime(0)
+    , responseTime(0)
+    , responses(0)
+{
+}
+
+NetworkInstrumentation::NetworkInstrumentation(QObject* parent)
+    : QObject(parent)
+    , m_enabled(false)
+{
+}
+
+bool NetworkInstrumentation::isEnabled() const
+{
+    return m_enabled;
+}
+
+void NetworkInstrumentation::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+
+    if (m_enabled && !m_timer.isValid()) {
+        m_timer.start();
+    }
+}
+
+void NetworkInstrumentation::reset()
+{
+    m_finished.clear();
+    m_tabs.clear();
+    m_hosts.clear();
+}
+
+void NetworkInstrumentation::addRequest(QNetworkReply* reply, const QNetworkRequest &request, QNetworkAccessManager::Operation op,
+                                        Source source, const Dispatch &dispatch)
+{
+    if (!m_enabled || !reply) {
+        return;
+    }
+
+    Request r;
+    r.url = request.url();
+    r.host = r.url.host().toLower();
+    r.pageId = request.attribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100)).toULongLong();
+    r.operation = op;
+    r.source = source;
+    r.dispatch = dispatch;
+    r.started = elapsed();
+
+    if (WebPage* page = WebPage::fromRequest(request)) {
+        aggregateFor(m_tabs, r.pageId).pageUrl = page->url().toString();
+    }
+
+    m_running.insert(reply, r);
+
+#if QT_VERSION >= 0x050100
+    connect(reply, SIGNAL(encrypted()), this, SLOT(replyEncrypted()));
+#endif
+    connect(reply, SIGNAL(metaDataChanged()), this, SLOT(replyMetaDataChanged()));
+    connect(reply, SIGNAL(readyRead()), this, SLOT(replyReadyRead()));
+    connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(replyDownloadProgress(qint64,qint64)));
+    connect(reply, SIGNAL(uploadProgress(qint64,qint64)), this, SLOT(replyUploadProgress(qint64,qint64)));
+    connect(reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+    connect(reply, SIGNAL(destroyed(QObject*)), this, SLOT(replyDestroyed(QObject*)));
+}
+
+QList<NetworkInstrumentation::Request> NetworkInstrumentation::requests() const
+{
+    return m_finished;
+}
+
+QHash<quint64, NetworkInstrumentation::Aggregate> NetworkInstrumentation::tabStatistics() const
+{
+    return m_tabs;
+}
+
+QHash<QString, NetworkInstrumentation::Aggregate> NetworkInstrumentation::hostStatistics() const
+{
+    return m_hosts;
+}
+
+QString NetworkInstrumentation::toJson() const
+{
+    QVariantList tabs;
+    QHash<quint64, Aggregate>::const_iterator tab = m_tabs.constBegin();
+    while (tab != m_tabs.constEnd()) {
+        QVariantMap map = aggregateToMap(tab.value());
+        map.insert(QSL("id"), jsonNumber(tab.key()));
+        map.insert(QSL("url"), tab.value().pageUrl);
+        tabs.append(map);
+        ++tab;
+    }
+
+    QVariantList hosts;
+    QHash<QString, Aggregate>::const_iterator host = m_hosts.constBegin();
+    while (host != m_hosts.constEnd()) {
+        QVariantMap map = aggregateToMap(host.value());
+        map.insert(QSL("host"), host.key());
+        hosts.append(map);
+        ++host;
+    }
+
+    QVariantList requests;
+    foreach (const Request &r, m_finished) {
+        QVariantMap map;
+        map.insert(QSL("url"), r.url.toString());
+        map.insert(QSL("host"), r.host);
+        map.insert(QSL("tab"), jsonNumber(r.pageId));
+        map.insert(QSL("source"), sourceToString(r.source));
+        map.insert(QSL("schemeHandlersTime"), jsonNumber(r.dispatch.schemeHandlers));
+        map.insert(QSL("pluginsTime"), jsonNumber(r.dispatch.plugins));
+        map.insert(QSL("adBlockTime"), jsonNumber(r.dispatch.adBlock));
+        map.insert(QSL("started"), jsonNumber(r.started));
+        map.insert(QSL("encrypted"), jsonNumber(r.encrypted));
+        map.insert(QSL("responseHeaders"), jsonNumber(r.responseHeaders));
+        map.insert(QSL("firstByte"), jsonNumber(r.firstByte));
+        map.insert(QSL("finished"), jsonNumber(r.finished));
+        map.insert(QSL("bytesReceived"), jsonNumber(r.bytesReceived));
+        map.insert(QSL("bytesSent"), jsonNumber(r.bytesSent));
+        map.insert(QSL("statusCode"), r.statusCode);
+        map.insert(QSL("fromCache"), r.fromCache);
+        map.insert(QSL("failed"), r.failed);
+        requests.append(map);
+    }
+
+    QVariantMap map;
+    map.insert(QSL("enabled"), m_enabled);
+    map.insert(QSL("elapsed"), jsonNumber(elapsed()));
+    map.insert(QSL("tabs"), tabs);
+    map.insert(QSL("hosts"), hosts);
+    map.insert(QSL("requests"), requests);
+
+    Json json;
+    return json.serialize(map);
+}
+
+QString NetworkInstrumentation::sourceToString(Source source)
+{
+    switch (source) {
+    case SchemeHandlerSource:
+        return QSL("scheme");
+    case PluginSource:
+        return QSL("plugin");
+    case AdBlockSource:
+        return QSL("adblock");
+    default:
+        return QSL("network");
+    }
+}
+
+qint64 NetworkInstrumentation::lap(QElapsedTimer &timer)
+{
+    const qint64 time = timer.nsecsElapsed() / 1000;
+    timer.start();
+    return time;
+}
+
+void NetworkInstrumentation::replyEncrypted()
+{
+    if (Request* r = runningRequest(sender())) {
+        r->encrypted = elapsed() - r->started;
+    }
+}
+
+void NetworkInstrumentation::replyMetaDataChanged()
+{
+    Request* r = runningRequest(sender());
+
+    if (r && r->responseHeaders < 0) {
+        r->responseHeaders = elapsed() - r->started;
+    }
+}
+
+void NetworkInstrumentation::replyReadyRead()
+{
+    if (Request* r = runningRequest(sender())) {
+        r->firstByte = elapsed() - r->started;
+    }
+
+    // Only first chunk is interesting
+    disconnect(sender(), SIGNAL(readyRead()), this, SLOT(replyReadyRead()));
+}
+
+void NetworkInstrumentation::replyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    Q_UNUSED(bytesTotal)
+
+    if (Request* r = runningRequest(sender())) {
+        r->bytesReceived = bytesReceived;
+    }
+}
+
+void NetworkInstrumentation::replyUploadProgress(qint64 bytesSent, qint64 bytesTotal)
+{
+    Q_UNUSED(bytesTotal)
+
+    if (Request* r = runningRequest(sender())) {
+        r->bytesSent = bytesSent;
+    }
+}
+
+void NetworkInstrumentation::replyFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply || !m_running.contains(reply)) {
+        return;
+    }
+
+    Request r = m_running.take(reply);
+    reply->disconnect(this);
+
+    r.finished = elapsed() - r.started;
+    r.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    r.fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    r.failed = reply->error() != QNetworkReply::NoError;
+
+    m_finished.append(r);
+    if (m_finished.count() > MAX_FINISHED_REQUESTS) {
+        m_finished.removeFirst();
+    }
+
+    addToAggregate(aggregateFor(m_tabs, r.pageId), r);
+    addToAggregate(aggregateFor(m_hosts, r.host), r);
+}
+
+void NetworkInstrumentation::replyDestroyed(QObject* object)
+{
+    m_running.remove(object);
+}
+
+qint64 NetworkInstrumentation::elapsed() const
+{
+    return m_timer.isValid() ? m_timer.nsecsElapsed() / 1000 : 0;
+}
+
+NetworkInstrumentation::Request* NetworkInstrumentation::runningRequest(QObject* reply)
+{
+    QHash<QObject*, Request>::iterator it = m_running.find(reply);
+    return it == m_running.end() ? 0 : &it.value();
+}
+
+void NetworkInstrumentation::addToAggregate(Aggregate &aggregate, const Request &request)
+{
+    ++aggregate.requests;
+
+    if (request.failed) {
+        ++aggregate.failed;
+    }
+    if (request.fromCache) {
+        ++aggregate.fromCache;
+    }
+
+    aggregate.bytesReceived += request.bytesReceived;
+    aggregate.bytesSent += request.bytesSent;
+    aggregate.dispatchTime += request.dispatch.total();
+    aggregate.totalTime += request.finished;
+
+    if (request.responseHeaders >= 0) {
+        aggregate.responseTime += request.responseHeaders;
+        ++aggregate.responses;
+    }
+}
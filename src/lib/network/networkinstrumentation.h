@@ -0,0 +1,150 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef NETWORKINSTRUMENTATION_H
+#define NETWORKINSTRUMENTATION_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QHash>
+#include <QList>
+#include <QUrl>
+
+#include "qzcommon.h"
+
+class QNetworkReply;
+class QNetworkRequest;
+
+// Records timings of requests created by NetworkManager, it is disabled by default.
+// All times are in microseconds.
+class QUPZILLA_EXPORT NetworkInstrumentation : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Which part of NetworkManager::createRequest created the reply
+    enum Source {
+        SchemeHandlerSource = 0,
+        PluginSource = 1,
+        AdBlockSource = 2,
+        NetworkSource = 3
+    };
+
+    // Time spent in each dispatch step, -1 when the step was not reached
+    struct Dispatch {
+        qint64 schemeHandlers;
+        qint64 plugins;
+        qint64 adBlock;
+
+        Dispatch() : schemeHandlers(-1), plugins(-1), adBlock(-1) { }
+
+        qint64 total() const;
+    };
+
+    struct Request {
+        QUrl url;
+        QString host;
+        quint64 pageId;
+        QNetworkAccessManager::Operation operation;
+        Source source;
+        Dispatch dispatch;
+
+        // Since instrumentation was enabled
+        qint64 started;
+
+        // Since request was created, -1 when it didn't happen
+        qint64 encrypted;
+        qint64 responseHeaders;
+        qint64 firstByte;
+        qint64 finished;
+
+        qint64 bytesReceived;
+        qint64 bytesSent;
+        int statusCode;
+        bool fromCache;
+        bool failed;
+
+        Request();
+    };
+
+    struct Aggregate {
+        // Url of page for tabs, empty for hosts
+        QString pageUrl;
+
+        int requests;
+        int failed;
+        int fromCache;
+        qint64 bytesReceived;
+        qint64 bytesSent;
+
+        qint64 dispatchTime;
+        qint64 totalTime;
+        qint64 responseTime;
+        int responses;
+
+        Aggregate();
+    };
+
+    explicit NetworkInstrumentation(QObject* parent = 0);
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    // Removes recorded data, running requests are still recorded when finished
+    void reset();
+
+    void addRequest(QNetworkReply* reply, const QNetworkRequest &request, QNetworkAccessManager::Operation op,
+                    Source source, const Dispatch &dispatch);
+
+    // Finished requests, only the most recent are kept
+    QList<Request> requests() const;
+
+    QHash<quint64, Aggregate> tabStatistics() const;
+    QHash<QString, Aggregate> hostStatistics() const;
+
+    QString toJson() const;
+
+    static QString sourceToString(Source source);
+
+    // Returns microseconds since last start and restarts the timer
+    static qint64 lap(QElapsedTimer &timer);
+
+private slots:
+    void replyEncrypted();
+    void replyMetaDataChanged();
+    void replyReadyRead();
+    void replyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void replyUploadProgress(qint64 bytesSent, qint64 bytesTotal);
+    void replyFinished();
+    void replyDestroyed(QObject* object);
+
+private:
+    qint64 elapsed() const;
+    Request* runningRequest(QObject* reply);
+    void addToAggregate(Aggregate &aggregate, const Request &request);
+
+    bool m_enabled;
+    QElapsedTimer m_timer;
+
+    QHash<QObject*, Request> m_running;
+    QList<Request> m_finished;
+    QHash<quint64, Aggregate> m_tabs;
+    QHash<QString, Aggregate> m_hosts;
+};
+
+#endif // NETWORKINSTRUMENTATION_H
@@ -20,11 +20,14 @@
 #include "autofill.h"
 #include "networkmanagerproxy.h"
 #include "mainapplication.h"
+#include "networkcache.h"
 #include "webpage.h"
 #include "tabbedwebview.h"
 #include "pluginproxy.h"
 #include "adblockmanager.h"
 #include "networkproxyfactory.h"
+#include "networkinstrumentation.h"
+#include "requestinfo.h"
 #include "certificateinfowidget.h"
 #include "qztools.h"
 #include "acceptlanguage.h"
@@ -43,7 +46,6 @@
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QDialogButtonBox>
-#include <QNetworkDiskCache>
 #include <QDir>
 #include <QSslSocket>
 #include <QSslConfiguration>
@@ -51,6 +53,7 @@
 #include <QMessageBox>
 #include <QAuthenticator>
 #include <QDirIterator>
+#include <QElapsedTimer>
 
 static QString fileNameForCert(const QSslCertificate &cert)
 {
@@ -84,6 +87,11 @@ NetworkManager::NetworkManager(QObject* parent)
     m_proxyFactory = new NetworkProxyFactory();
     setProxyFactory(m_proxyFactory);
 
+    // Instrumentation can also be enabled from qupzilla:network page
+    Settings settings;
+    m_instrumentation = new NetworkInstrumentation(this);
+    m_instrumentation->setEnabled(settings.value("Web-Browser-Settings/NetworkInstrumentation", false).toBool());
+
     loadSettings();
 }
 
@@ -92,7 +100,7 @@ void NetworkManager::loadSettings()
     Settings settings;
 
     if (settings.value("Web-Browser-Settings/AllowLocalCache", true).toBool() && !mApp->isPrivate()) {
-        QNetworkDiskCache* cache = mApp->networkCache();
+        NetworkCache* cache = mApp->networkCache();
         cache->setMaximumCacheSize(settings.value("MaximumCacheSize", 50).toInt() * 1024 * 1024); //MegaBytes
         setCache(cache);
     }
@@ -108,6 +116,11 @@ void NetworkManager::loadSettings()
     m_sslv3Sites = settings.value("SSLv3Sites", sslv3Sites).toStringList();
     settings.endGroup();
 
+    m_sslv3Hosts.clear();
+    foreach (const QString &site, m_sslv3Sites) {
+        m_sslv3Hosts.insert(site.toLower());
+    }
+
     m_acceptLanguage = AcceptLanguage::generateHeader(settings.value("Language/acceptLanguage", AcceptLanguage::defaultLanguage()).toStringList());
 
 #if defined(Q_OS_WIN) || defined(Q_OS_HAIKU) || defined(Q_OS_OS2)
@@ -147,9 +160,8 @@ void NetworkManager::setSSLConfiguration(QNetworkReply* reply)
         }
 
         QNetworkRequest request = reply->request();
-        QVariant v = request.attribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100));
-        WebPage* webPage = static_cast<WebPage*>(v.value<void*>());
-        if (!WebPage::isPointerSafeToUse(webPage)) {
+        WebPage* webPage = WebPage::fromRequest(request);
+        if (!webPage) {
             return;
         }
 
@@ -172,9 +184,8 @@ void NetworkManager::sslError(QNetworkReply* reply, QList<QSslError> errors)
     }
 
     QNetworkRequest request = reply->request();
-    QVariant v = request.attribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100));
-    WebPage* webPage = static_cast<WebPage*>(v.value<void*>());
-    if (!WebPage::isPointerSafeToUse(webPage)) {
+    WebPage* webPage = WebPage::fromRequest(request);
+    if (!webPage) {
         return;
     }
 
@@ -504,7 +515,10 @@ void NetworkManager::proxyAuthentication(const QNetworkProxy &proxy, QAuthentica
 
 QNetworkReply* NetworkManager::createRequest(QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice* outgoingData)
 {
-    if (op == PostOperation && outgoingData) {
+    const RequestInfo info(request.url());
+
+    // Only forms submitted over http(s) are saved
+    if (op == PostOperation && outgoingData && info.isHttp()) {
         QByteArray outgoingDataByteArray = outgoingData->peek(1024 * 1024);
         mApp->autoFill()->post(request, outgoingDataByteArray);
     }
@@ -512,13 +526,21 @@ QNetworkReply* NetworkManager::createRequest(QNetworkAccessManager::Operation op
     QNetworkRequest req = request;
     QNetworkReply* reply = 0;
 
+    const bool instrumented = m_instrumentation->isEnabled();
+    NetworkInstrumentation::Dispatch dispatch;
+    QElapsedTimer timer;
+
+    if (instrumented) {
+        timer.start();
+    }
+
     // SchemeHandlers
-    if (m_schemeHandlers.contains(req.url().scheme())) {
-        reply = m_schemeHandlers[req.url().scheme()]->createRequest(op, req, outgoingData);
+    QHash<QString, SchemeHandler*>::const_iterator handler = m_schemeHandlers.constFind(info.schemeString());
+    if (handler != m_schemeHandlers.constEnd()) {
+        reply = handler.value()->createRequest(op, req, outgoingData);
         if (reply) {
-            if (req.url().scheme() == "ftp") {
-                QVariant v = req.attribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100));
-                WebPage* webPage = static_cast<WebPage*>(v.value<void*>());
+            if (info.scheme() == RequestInfo::FtpScheme) {
+                WebPage* webPage = WebPage::fromRequest(req);
                 if (webPage) {
                     connect(reply, SIGNAL(downloadRequest(QNetworkRequest)),
                             webPage, SLOT(downloadRequested(QNetworkRequest)));
@@ -526,12 +548,26 @@ QNetworkReply* NetworkManager::createRequest(QNetworkAccessManager::Operation op
                 connect(reply, SIGNAL(ftpAuthenticationRequierd(QUrl,QAuthenticator*)),
                         this, SLOT(ftpAuthentication(QUrl,QAuthenticator*)));
             }
-            return reply;
         }
     }
 
+    if (instrumented) {
+        dispatch.schemeHandlers = NetworkInstrumentation::lap(timer);
+        m_instrumentation->addRequest(reply, request, op, NetworkInstrumentation::SchemeHandlerSource, dispatch);
+    }
+
+    if (reply) {
+        return reply;
+    }
+
     // Plugins
     reply = mApp->plugins()->createRequest(op, request, outgoingData);
+
+    if (instrumented) {
+        dispatch.plugins = NetworkInstrumentation::lap(timer);
+        m_instrumentation->addRequest(reply, request, op, NetworkInstrumentation::PluginSource, dispatch);
+    }
+
     if (reply) {
         return reply;
     }
@@ -562,25 +598,32 @@ QNetworkReply* NetworkManager::createRequest(QNetworkAccessManager::Operation op
         if (!m_adblockManager) {
             m_adblockManager = AdBlockManager::instance();
         }
-        reply = m_adblockManager->block(req);
+        reply = m_adblockManager->block(req, info);
+
+        if (instrumented) {
+            dispatch.adBlock = NetworkInstrumentation::lap(timer);
+            m_instrumentation->addRequest(reply, request, op, NetworkInstrumentation::AdBlockSource, dispatch);
+        }
+
         if (reply) {
             return reply;
         }
     }
 
     // Force SSLv3 for servers that doesn't understand TLSv1 handshake
-    if (req.url().scheme() == QLatin1String("https")) {
-        foreach (const QString &host, m_sslv3Sites) {
-            if (QzTools::matchDomain(host, req.url().host())) {
-                QSslConfiguration conf = req.sslConfiguration();
-                conf.setProtocol(QSsl::SslV3);
-                req.setSslConfiguration(conf);
-                break;
-            }
-        }
+    if (info.scheme() == RequestInfo::HttpsScheme && info.hostMatchesDomains(m_sslv3Hosts)) {
+        QSslConfiguration conf = req.sslConfiguration();
+        conf.setProtocol(QSsl::SslV3);
+        req.setSslConfiguration(conf);
     }
 
-    return QNetworkAccessManager::createRequest(op, req, outgoingData);
+    reply = QNetworkAccessManager::createRequest(op, req, outgoingData);
+
+    if (instrumented) {
+        m_instrumentation->addRequest(reply, request, op, NetworkInstrumentation::NetworkSource, dispatch);
+    }
+
+    return reply;
 }
 
 void NetworkManager::removeLocalCertificate(const QSslCertificate &cert)
@@ -660,23 +703,33 @@ NetworkProxyFactory* NetworkManager::proxyFactory() const
     return m_proxyFactory;
 }
 
+NetworkInstrumentation* NetworkManager::instrumentation() const
+{
+    return m_instrumentation;
+}
+
 bool NetworkManager::registerSchemeHandler(const QString &scheme, SchemeHandler* handler)
 {
-    if (m_schemeHandlers.contains(scheme)) {
+    // Handlers are looked up by lower-cased scheme of request
+    const QString key = scheme.toLower();
+
+    if (m_schemeHandlers.contains(key)) {
         return false;
     }
 
-    m_schemeHandlers[scheme] = handler;
+    m_schemeHandlers[key] = handler;
     return true;
 }
 
 bool NetworkManager::unregisterSchemeHandler(const QString &scheme, SchemeHandler* handler)
 {
-    if (!m_schemeHandlers.contains(scheme) || m_schemeHandlers[scheme] != handler) {
+    const QString key = scheme.toLower();
+
+    if (!m_schemeHandlers.contains(key) || m_schemeHandlers[key] != handler) {
         return false;
     }
 
-    return m_schemeHandlers.remove(scheme) == 1;
+    return m_schemeHandlers.remove(key) == 1;
 }
 
 void NetworkManager::saveSettings()
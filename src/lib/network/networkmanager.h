@@ -20,12 +20,14 @@
 
 #include <QSslError>
 #include <QStringList>
+#include <QSet>
 
 #include "qzcommon.h"
 #include "networkmanagerproxy.h"
 
 class AdBlockManager;
 class NetworkProxyFactory;
+class NetworkInstrumentation;
 class QupZillaSchemeHandler;
 class SchemeHandler;
 
@@ -53,9 +55,11 @@ public:
     bool isIgnoringAllWarnings();
 
     NetworkProxyFactory* proxyFactory() const;
+    NetworkInstrumentation* instrumentation() const;
 
     bool registerSchemeHandler(const QString &scheme, SchemeHandler* handler);
     bool unregisterSchemeHandler(const QString &scheme, SchemeHandler* handler);
+    QStringList registeredSchemes() const { return m_schemeHandlers.keys(); }
 
 signals:
     void sslDialogClosed();
@@ -70,8 +74,10 @@ private slots:
 private:
     AdBlockManager* m_adblockManager;
     NetworkProxyFactory* m_proxyFactory;
+    NetworkInstrumentation* m_instrumentation;
 
     QStringList m_sslv3Sites;
+    QSet<QString> m_sslv3Hosts;
     QStringList m_certPaths;
     QList<QSslCertificate> m_caCerts;
     QList<QSslCertificate> m_localCerts;
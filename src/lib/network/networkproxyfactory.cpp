@@ -57,7 +57,198 @@ bool WildcardMatcher::match(const QString &str) const
         return str.contains(m_pattern, Qt::CaseInsensitive);
     }
 
-    return m_regExp->indexIn(str) > -1;
+    return m_regExp->matches(str);
+}
+
+// Dotted hostname with alphabetic top-level label, eg. "example.com" but not "10.0" or "192.168."
+static bool isDomainName(const QString &name)
+{
+    const QStringList labels = name.split(QLatin1Char('.'));
+    if (labels.count() < 2) {
+        return false;
+    }
+
+    foreach (const QString &label, labels) {
+        if (label.isEmpty()) {
+            return false;
+        }
+
+        foreach (const QChar &c, label) {
+            if (!c.isLetterOrNumber() && c != QLatin1Char('-')) {
+                return false;
+            }
+        }
+    }
+
+    foreach (const QChar &c, labels.last()) {
+        if (c.isLetter()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ProxyExceptions::ProxyExceptions()
+    : m_domains(new DomainNode)
+{
+}
+
+void ProxyExceptions::setExceptions(const QStringList &exceptions)
+{
+    clear();
+
+    foreach (const QString &e, exceptions) {
+        const QString exception = e.trimmed().toLower();
+
+        if (exception.isEmpty()) {
+            continue;
+        }
+
+        const bool hasWildcard = exception.contains(QLatin1Char('*')) || exception.contains(QLatin1Char('?'));
+
+        if (!hasWildcard && exception.contains(QLatin1Char('/'))) {
+            QPair<QHostAddress, int> subnet = QHostAddress::parseSubnet(exception);
+            if (!subnet.first.isNull()) {
+                m_subnets.append(subnet);
+                continue;
+            }
+        }
+
+        if (!hasWildcard) {
+            QHostAddress address(exception);
+            if (!address.isNull()) {
+                m_exactHosts.insert(address.toString().toLower());
+                continue;
+            }
+
+            const QString domain = exception.startsWith(QLatin1Char('.')) ? exception.mid(1) : exception;
+            if (isDomainName(domain)) {
+                addDomain(domain);
+                continue;
+            }
+
+            // Partial addresses ("192.168.", "10.0") and single-label names ("intranet")
+            // keep the substring matching they always had
+            m_wildcards.append(new WildcardMatcher(exception));
+            continue;
+        }
+
+        if (exception.startsWith(QLatin1String("*.")) && exception.count(QLatin1Char('*')) == 1 && !exception.contains(QLatin1Char('?'))) {
+            addDomain(exception.mid(2));
+            continue;
+        }
+
+        m_wildcards.append(new WildcardMatcher(exception));
+    }
+}
+
+void ProxyExceptions::clear()
+{
+    m_exactHosts.clear();
+    m_subnets.clear();
+
+    delete m_domains;
+    m_domains = new DomainNode;
+
+    qDeleteAll(m_wildcards);
+    m_wildcards.clear();
+}
+
+bool ProxyExceptions::isEmpty() const
+{
+    return m_exactHosts.isEmpty() && m_domains->children.isEmpty() && m_subnets.isEmpty() && m_wildcards.isEmpty();
+}
+
+bool ProxyExceptions::match(const QString &host) const
+{
+    if (host.isEmpty()) {
+        return false;
+    }
+
+    QString h = host.toLower();
+    if (h.endsWith(QLatin1Char('.'))) {
+        h.chop(1);
+    }
+
+    if (m_exactHosts.contains(h) || matchDomain(h)) {
+        return true;
+    }
+
+    if (!m_subnets.isEmpty()) {
+        QHostAddress address(h);
+
+        if (!address.isNull()) {
+            for (int i = 0; i < m_subnets.size(); ++i) {
+                if (address.isInSubnet(m_subnets.at(i))) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    foreach (WildcardMatcher* m, m_wildcards) {
+        if (m->match(h)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ProxyExceptions::addDomain(const QString &domain)
+{
+    const QStringList labels = domain.split(QLatin1Char('.'), QString::SkipEmptyParts);
+
+    if (labels.isEmpty()) {
+        return;
+    }
+
+    // Domains are stored reversed by labels, so "mail.example.com" becomes com -> example -> mail
+    DomainNode* node = m_domains;
+
+    for (int i = labels.size() - 1; i >= 0; --i) {
+        DomainNode* child = node->children.value(labels.at(i));
+        if (!child) {
+            child = new DomainNode;
+            node->children.insert(labels.at(i), child);
+        }
+        node = child;
+    }
+
+    node->terminal = true;
+}
+
+bool ProxyExceptions::matchDomain(const QString &host) const
+{
+    if (m_domains->children.isEmpty()) {
+        return false;
+    }
+
+    const DomainNode* node = m_domains;
+    int end = host.size();
+
+    while (end > 0) {
+        const int dot = host.lastIndexOf(QLatin1Char('.'), end - 1);
+        node = node->children.value(host.mid(dot + 1, end - dot - 1));
+
+        if (!node) {
+            return false;
+        }
+        if (node->terminal) {
+            return true;
+        }
+
+        end = dot;
+    }
+
+    return false;
+}
+
+ProxyExceptions::~ProxyExceptions()
+{
+    delete m_domains;
+    qDeleteAll(m_wildcards);
 }
 
 NetworkProxyFactory::NetworkProxyFactory()
@@ -92,12 +283,7 @@ void NetworkProxyFactory::loadSettings()
     QStringList exceptions = settings.value("ProxyExceptions", QStringList() << "localhost" << "127.0.0.1").toStringList();
     settings.endGroup();
 
-    qDeleteAll(m_proxyExceptions);
-    m_proxyExceptions.clear();
-
-    foreach (const QString &exception, exceptions) {
-        m_proxyExceptions.append(new WildcardMatcher(exception.trimmed()));
-    }
+    m_proxyExceptions.setExceptions(exceptions);
 
     m_pacManager->loadSettings();
 }
@@ -121,12 +307,9 @@ QList<QNetworkProxy> NetworkProxyFactory::queryProxy(const QNetworkProxyQuery &q
         return proxyList;
     }
 
-    const QString urlHost = query.url().host();
-    foreach (WildcardMatcher* m, m_proxyExceptions) {
-        if (m->match(urlHost)) {
-            proxyList.append(QNetworkProxy::NoProxy);
-            return proxyList;
-        }
+    if (!m_proxyExceptions.isEmpty() && m_proxyExceptions.match(query.url().host())) {
+        proxyList.append(QNetworkProxy::NoProxy);
+        return proxyList;
     }
 
     switch (m_proxyPreference) {
@@ -176,5 +359,4 @@ QList<QNetworkProxy> NetworkProxyFactory::queryProxy(const QNetworkProxyQuery &q
 
 NetworkProxyFactory::~NetworkProxyFactory()
 {
-    qDeleteAll(m_proxyExceptions);
 }
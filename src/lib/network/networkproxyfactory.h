@@ -19,7 +19,10 @@
 #define NETWORKPROXYFACTORY_H
 
 #include <QNetworkProxyFactory>
+#include <QHostAddress>
 #include <QStringList>
+#include <QHash>
+#include <QSet>
 
 #include "qzcommon.h"
 #include "qzregexp.h"
@@ -42,6 +45,44 @@ private:
     QzRegExp* m_regExp;
 };
 
+class QUPZILLA_EXPORT ProxyExceptions
+{
+public:
+    explicit ProxyExceptions();
+    ~ProxyExceptions();
+
+    // Exceptions are compiled into buckets, ordered from the cheapest lookup:
+    //  - exact hosts (IP addresses): "127.0.0.1", "::1"
+    //  - domains, matching also all subdomains: "example.com", ".example.com", "*.example.com"
+    //  - subnets in CIDR notation: "192.168.0.0/16", "fe80::/10"
+    //  - everything else is matched with WildcardMatcher as before, that is wildcard
+    //    patterns and substrings: "*intranet*", "10.0.*", "192.168.", "localhost"
+    void setExceptions(const QStringList &exceptions);
+    void clear();
+
+    bool isEmpty() const;
+    bool match(const QString &host) const;
+
+private:
+    Q_DISABLE_COPY(ProxyExceptions)
+
+    struct DomainNode {
+        DomainNode() : terminal(false) { }
+        ~DomainNode() { qDeleteAll(children); }
+
+        QHash<QString, DomainNode*> children;
+        bool terminal;
+    };
+
+    void addDomain(const QString &domain);
+    bool matchDomain(const QString &host) const;
+
+    QSet<QString> m_exactHosts;
+    DomainNode* m_domains;
+    QList<QPair<QHostAddress, int> > m_subnets;
+    QList<WildcardMatcher*> m_wildcards;
+};
+
 class QUPZILLA_EXPORT NetworkProxyFactory : public QNetworkProxyFactory
 {
 public:
@@ -73,7 +114,7 @@ private:
     QString m_httpsUsername;
     QString m_httpsPassword;
 
-    QList<WildcardMatcher*> m_proxyExceptions;
+    ProxyExceptions m_proxyExceptions;
     bool m_useDifferentProxyForHttps;
 };
 
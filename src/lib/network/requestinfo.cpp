@@ -0,0 +1,152 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "requestinfo.h"
+
+RequestInfo::RequestInfo(const QUrl &url)
+    : m_url(url)
+    , m_schemeString(url.scheme().toLower())
+    , m_host(url.host().toLower())
+    , m_registrableDomainComputed(false)
+{
+    m_scheme = schemeFromString(m_schemeString);
+}
+
+const QUrl &RequestInfo::url() const
+{
+    return m_url;
+}
+
+RequestInfo::Scheme RequestInfo::scheme() const
+{
+    return m_scheme;
+}
+
+bool RequestInfo::isHttp() const
+{
+    return m_scheme == HttpScheme || m_scheme == HttpsScheme;
+}
+
+const QString &RequestInfo::schemeString() const
+{
+    return m_schemeString;
+}
+
+const QString &RequestInfo::host() const
+{
+    return m_host;
+}
+
+const QString &RequestInfo::registrableDomain() const
+{
+    if (!m_registrableDomainComputed) {
+        m_registrableDomain = registrableDomainForUrl(m_url);
+        m_registrableDomainComputed = true;
+    }
+
+    return m_registrableDomain;
+}
+
+bool RequestInfo::hostMatchesDomains(const QSet<QString> &domains) const
+{
+    if (m_host.isEmpty() || domains.isEmpty()) {
+        return false;
+    }
+
+    // Host itself and then all its parent domains
+    int index = 0;
+
+    forever {
+        if (domains.contains(m_host.mid(index))) {
+            return true;
+        }
+
+        index = m_host.indexOf(QLatin1Char('.'), index) + 1;
+
+        if (index == 0) {
+            return false;
+        }
+    }
+}
+
+RequestInfo::Scheme RequestInfo::schemeFromString(const QString &scheme)
+{
+    if (scheme == QLatin1String("http")) {
+        return HttpScheme;
+    }
+    if (scheme == QLatin1String("https")) {
+        return HttpsScheme;
+    }
+    if (scheme == QLatin1String("ftp")) {
+        return FtpScheme;
+    }
+    if (scheme == QLatin1String("file")) {
+        return FileScheme;
+    }
+    if (scheme == QLatin1String("data")) {
+        return DataScheme;
+    }
+    if (scheme == QLatin1String("qrc")) {
+        return QrcScheme;
+    }
+    if (scheme == QLatin1String("qupzilla")) {
+        return QupZillaScheme;
+    }
+    if (scheme == QLatin1String("abp")) {
+        return AdBlockScheme;
+    }
+
+    return OtherScheme;
+}
+
+// Version for Qt < 4.8 has one issue, it will wrongly
+// count .co.uk (and others) as second-level domain
+QString RequestInfo::registrableDomainForUrl(const QUrl &url)
+{
+#if QT_VERSION >= 0x040800
+    const QString topLevelDomain = url.topLevelDomain();
+    const QString urlHost = url.host();
+
+    if (topLevelDomain.isEmpty() || urlHost.isEmpty()) {
+        return QString();
+    }
+
+    QString domain = urlHost.left(urlHost.size() - topLevelDomain.size());
+
+    if (domain.count(QLatin1Char('.')) == 0) {
+        return urlHost;
+    }
+
+    while (domain.count(QLatin1Char('.')) != 0) {
+        domain = domain.mid(domain.indexOf(QLatin1Char('.')) + 1);
+    }
+
+    return domain + topLevelDomain;
+#else
+    QString domain = url.host();
+
+    if (domain.count(QLatin1Char('.')) == 0) {
+        return QString();
+    }
+
+    while (domain.count(QLatin1Char('.')) != 1) {
+        domain = domain.mid(domain.indexOf(QLatin1Char('.')) + 1);
+    }
+
+    return domain;
+#endif
+}
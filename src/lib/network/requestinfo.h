@@ -0,0 +1,75 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef REQUESTINFO_H
+#define REQUESTINFO_H
+
+#include <QString>
+#include <QSet>
+#include <QUrl>
+
+#include "qzcommon.h"
+
+// Classification of network request. It is created once in NetworkManager::createRequest
+// and passed to scheme handlers dispatch, AdBlock and other consumers, so the scheme
+// and host strings are not extracted from url again.
+class QUPZILLA_EXPORT RequestInfo
+{
+public:
+    enum Scheme {
+        OtherScheme = 0,
+        HttpScheme,
+        HttpsScheme,
+        FtpScheme,
+        FileScheme,
+        DataScheme,
+        QrcScheme,
+        QupZillaScheme,
+        AdBlockScheme
+    };
+
+    explicit RequestInfo(const QUrl &url);
+
+    const QUrl &url() const;
+
+    Scheme scheme() const;
+    bool isHttp() const;
+
+    // Lower-cased
+    const QString &schemeString() const;
+    const QString &host() const;
+
+    // Second-level domain (eg. example.co.uk), computed on first use
+    const QString &registrableDomain() const;
+
+    // Returns true if host is one of domains or its subdomain
+    bool hostMatchesDomains(const QSet<QString> &domains) const;
+
+    static Scheme schemeFromString(const QString &scheme);
+    static QString registrableDomainForUrl(const QUrl &url);
+
+private:
+    QUrl m_url;
+    Scheme m_scheme;
+    QString m_schemeString;
+    QString m_host;
+
+    mutable QString m_registrableDomain;
+    mutable bool m_registrableDomainComputed;
+};
+
+#endif // REQUESTINFO_H
@@ -25,12 +25,17 @@
 #include <QFileIconProvider>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QDirIterator>
 #include <QDesktopServices>
 #include <QTextStream>
 #include <QDateTime>
 #include <QTimer>
 #include <QDir>
 
+#if QT_VERSION >= 0x050000
+#include <QMimeDatabase>
+#endif
+
 FileSchemeHandler::FileSchemeHandler()
 {
 }
@@ -93,7 +98,7 @@ void FileSchemeHandler::handleUrl(const QUrl &url)
     else if (status == 2) {
         // Save
         const QString savePath = QzTools::getSaveFileName("FileSchemeHandler-Save", mApp->getWindow(),
-                                 QObject::tr("Save file as..."),
+                                 FileSchemeReply::tr("Save file as..."),
                                  QDir::homePath() + QDir::separator() + QzTools::getFileNameFromUrl(url));
 
         if (!savePath.isEmpty()) {
@@ -102,80 +107,237 @@ void FileSchemeHandler::handleUrl(const QUrl &url)
     }
 }
 
+// Entries are listed and written in chunks so that big directories
+// don't block the event loop and WebKit can render the page progressively
+static const int s_listChunkSize = 1000;
+static const int s_writeChunkSize = 250;
+
+static bool entryLessThan(const QFileInfo &a, const QFileInfo &b)
+{
+    // Same order as QDir::Name | QDir::DirsFirst | QDir::IgnoreCase
+    const bool aDir = a.isDir();
+    const bool bDir = b.isDir();
+
+    if (aDir != bDir) {
+        return aDir;
+    }
+
+    return a.fileName().compare(b.fileName(), Qt::CaseInsensitive) < 0;
+}
+
+static QString iconCacheKey(const QFileInfo &info)
+{
+    if (info.isRoot()) {
+        return QL1S("root:") + info.absoluteFilePath();
+    }
+
+    if (info.isDir()) {
+        return QSL("inode/directory");
+    }
+
+#if QT_VERSION >= 0x050000
+    static QMimeDatabase db;
+    return db.mimeTypeForFile(info, QMimeDatabase::MatchExtension).name();
+#else
+    const QString suffix = info.suffix().toLower();
+    return QL1S("suffix:") + (suffix.isEmpty() && info.isExecutable() ? QSL("*x") : suffix);
+#endif
+}
+
 FileSchemeReply::FileSchemeReply(const QNetworkRequest &req, QObject* parent)
     : QNetworkReply(parent)
+    , m_bytesWritten(0)
+    , m_iterator(0)
+    , m_position(0)
+    , m_hasHiddenEntries(false)
+    , m_aborted(false)
 {
     setOperation(QNetworkAccessManager::GetOperation);
     setRequest(req);
     setUrl(req.url());
 
-    m_buffer.open(QIODevice::ReadWrite);
     setError(QNetworkReply::NoError, tr("No Error"));
     open(QIODevice::ReadOnly);
 
     QTimer::singleShot(0, this, SLOT(loadPage()));
 }
 
+FileSchemeReply::~FileSchemeReply()
+{
+    delete m_iterator;
+}
+
 qint64 FileSchemeReply::bytesAvailable() const
 {
-    return m_buffer.bytesAvailable() + QNetworkReply::bytesAvailable();
+    return m_data.size() + QNetworkReply::bytesAvailable();
 }
 
 qint64 FileSchemeReply::readData(char* data, qint64 maxSize)
 {
-    return m_buffer.read(data, maxSize);
+    const qint64 len = qMin(qint64(m_data.size()), maxSize);
+
+    if (len > 0) {
+        memcpy(data, m_data.constData(), len);
+        m_data.remove(0, len);
+    }
+
+    return len;
 }
 
-void FileSchemeReply::loadPage()
+void FileSchemeReply::abort()
 {
-    QTextStream stream(&m_buffer);
-    stream.setCodec("UTF-8");
+    if (m_aborted || isFinished()) {
+        return;
+    }
+
+    m_aborted = true;
 
-    stream << loadDirectory();
+    delete m_iterator;
+    m_iterator = 0;
+    m_entries.clear();
+    m_data.clear();
 
-    stream.flush();
-    m_buffer.reset();
+    setError(QNetworkReply::OperationCanceledError, tr("Operation canceled"));
+    setFinished(true);
 
+    emit error(QNetworkReply::OperationCanceledError);
+    emit finished();
+}
+
+void FileSchemeReply::loadPage()
+{
+    if (m_aborted) {
+        return;
+    }
+
+    // Size of the listing is not known yet, so no Content-Length header
     setHeader(QNetworkRequest::ContentTypeHeader, QByteArray("text/html"));
-    setHeader(QNetworkRequest::ContentLengthHeader, m_buffer.bytesAvailable());
     setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
     setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, QByteArray("Ok"));
     emit metaDataChanged();
-    emit downloadProgress(m_buffer.size(), m_buffer.size());
 
+    appendData(pageHeader());
+
+    m_iterator = new QDirIterator(request().url().toLocalFile(), QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot);
+
+    loadNextChunk();
+}
+
+void FileSchemeReply::loadNextChunk()
+{
+    if (m_aborted) {
+        return;
+    }
+
+    if (m_iterator) {
+        for (int i = 0; i < s_listChunkSize && m_iterator->hasNext(); ++i) {
+            m_iterator->next();
+            m_entries.append(m_iterator->fileInfo());
+        }
+
+        if (m_iterator->hasNext()) {
+            QTimer::singleShot(0, this, SLOT(loadNextChunk()));
+            return;
+        }
+
+        delete m_iterator;
+        m_iterator = 0;
+
+        qSort(m_entries.begin(), m_entries.end(), entryLessThan);
+    }
+
+    QString styles;
+    QString rows;
+    const int end = qMin(m_position + s_writeChunkSize, m_entries.size());
+
+    for (; m_position < end; ++m_position) {
+        rows.append(entryRow(m_entries.at(m_position), styles));
+    }
+
+    if (!styles.isEmpty()) {
+        // <style> is allowed inside <tbody> and applies to the whole document
+        appendData(QL1S("<style>") + styles + QL1S("</style>\n") + rows);
+    }
+    else if (!rows.isEmpty()) {
+        appendData(rows);
+    }
+
+    if (m_position < m_entries.size()) {
+        QTimer::singleShot(0, this, SLOT(loadNextChunk()));
+        return;
+    }
+
+    finishPage();
+}
+
+void FileSchemeReply::appendData(const QString &data)
+{
+    const QByteArray bytes = data.toUtf8();
+
+    m_data.append(bytes);
+    m_bytesWritten += bytes.size();
+
+    emit downloadProgress(m_bytesWritten, -1);
     emit readyRead();
-    emit finished();
 }
 
-QString FileSchemeReply::loadDirectory()
+void FileSchemeReply::finishPage()
 {
-    const QDir dir = QDir(request().url().toLocalFile());
-    const QFileInfoList list = dir.entryInfoList(QDir::AllEntries | QDir::Hidden,
-                               QDir::Name | QDir::DirsFirst | QDir::IgnoreCase);
+    QString footer;
+
+    if (m_entries.isEmpty()) {
+        footer = QString("<tr><td colspan='4'>%1</td></tr>").arg(tr("Folder is empty."));
+    }
+
+    footer.append(pageFooter());
+    appendData(footer);
 
-    static QString sPage;
+    m_entries.clear();
+    m_iconClasses.clear();
 
-    if (sPage.isEmpty()) {
-        sPage = QzTools::readAllFileContents(":/html/dirlist.html");
-        sPage.replace(QLatin1String("%BOX-BORDER%"), QLatin1String("qrc:html/box-border.png"));
-        sPage.replace(QLatin1String("%UP-IMG%"), QzTools::pixmapToByteArray(IconProvider::standardIcon(QStyle::SP_FileDialogToParent).pixmap(22)));
-        sPage.replace(QLatin1String("%UP-DIR-TEXT%"), tr("Up to higher level directory"));
-        sPage.replace(QLatin1String("%SHOW-HIDDEN-TEXT%"), tr("Show hidden files"));
-        sPage.replace(QLatin1String("%NAME%"), tr("Name"));
-        sPage.replace(QLatin1String("%SIZE%"), tr("Size"));
-        sPage.replace(QLatin1String("%MODIFIED%"), tr("Last modified"));
-        sPage = QzTools::applyDirectionToPage(sPage);
+    setFinished(true);
+    emit downloadProgress(m_bytesWritten, m_bytesWritten);
+    emit finished();
+}
+
+static QString s_pageHeader;
+static QString s_pageFooter;
+
+static void loadPageTemplate()
+{
+    if (!s_pageHeader.isEmpty()) {
+        return;
     }
 
-    QString page = sPage;
+    QString page = QzTools::readAllFileContents(":/html/dirlist.html");
+    page.replace(QLatin1String("%BOX-BORDER%"), QLatin1String("qrc:html/box-border.png"));
+    page.replace(QLatin1String("%UP-IMG%"), QzTools::pixmapToByteArray(IconProvider::standardIcon(QStyle::SP_FileDialogToParent).pixmap(22)));
+    page.replace(QLatin1String("%UP-DIR-TEXT%"), FileSchemeReply::tr("Up to higher level directory"));
+    page.replace(QLatin1String("%SHOW-HIDDEN-TEXT%"), FileSchemeReply::tr("Show hidden files"));
+    page.replace(QLatin1String("%NAME%"), FileSchemeReply::tr("Name"));
+    page.replace(QLatin1String("%SIZE%"), FileSchemeReply::tr("Size"));
+    page.replace(QLatin1String("%MODIFIED%"), FileSchemeReply::tr("Last modified"));
+    page = QzTools::applyDirectionToPage(page);
+
+    const QString bodyMarker = QLatin1String("%T-BODY%");
+    const int pos = page.indexOf(bodyMarker);
+    s_pageHeader = page.left(pos);
+    s_pageFooter = page.mid(pos + bodyMarker.size());
+}
+
+QString FileSchemeReply::pageHeader()
+{
+    loadPageTemplate();
+
+    const QDir dir = QDir(request().url().toLocalFile());
+
+    QString page = s_pageHeader;
     QString title = request().url().toLocalFile();
     title.replace(QLatin1Char('/'), QDir::separator());
     page.replace(QLatin1String("%TITLE%"), tr("Index for %1").arg(title));
     page.replace(QLatin1String("%CLICKABLE-TITLE%"), tr("Index for %1").arg(clickableSections(title)));
 
     QString upDirDisplay = QLatin1String("none");
-    QString showHiddenDisplay = QLatin1String("none");
-    QString tBody;
 
     if (!dir.isRoot()) {
         QDir upDir = dir;
@@ -185,45 +347,75 @@ QString FileSchemeReply::loadDirectory()
         page.replace(QLatin1String("%UP-DIR-LINK%"), QUrl::fromLocalFile(upDir.absolutePath()).toEncoded());
     }
 
-    foreach (const QFileInfo &info, list) {
-        if (info.fileName() == QLatin1String(".") || info.fileName() == QLatin1String("..")) {
-            continue;
-        }
+    page.replace(QLatin1String("%UP-DIR-DISPLAY%"), upDirDisplay);
+    // Shown later together with the first hidden entry
+    page.replace(QLatin1String("%SHOW-HIDDEN-DISPLAY%"), QLatin1String("none"));
+
+    return page;
+}
 
-        QString line = QLatin1String("<tr");
+QString FileSchemeReply::pageFooter()
+{
+    loadPageTemplate();
 
-        if (info.isHidden()) {
-            showHiddenDisplay = "inline";
-            line += " class=\"tr-hidden\"";
+    return s_pageFooter;
+}
+
+QString FileSchemeReply::entryRow(const QFileInfo &info, QString &styles)
+{
+    QString line = QLatin1String("<tr");
+
+    if (info.isHidden()) {
+        if (!m_hasHiddenEntries) {
+            m_hasHiddenEntries = true;
+            styles.append(QLatin1String(".show-hidden{display:inline !important;}"));
         }
 
-        line += QLatin1String("><td class=\"td-name\" style=\"background-image:url(data:image/png;base64,");
-        line += QzTools::pixmapToByteArray(QFileIconProvider().icon(info).pixmap(16));
-        line += QLatin1String(");\">");
-        line += QLatin1String("<a href=\"");
-        line += QUrl::fromLocalFile(info.absoluteFilePath()).toEncoded();
-        line += QLatin1String("\">");
-        line += info.fileName();
-        line += QLatin1String("</a></td><td class=\"td-size\">");
-        line += info.isDir() ? QString() : QzTools::fileSizeToString(info.size());
-        line += QLatin1String("</td><td>");
-        line += info.lastModified().toString("dd.MM.yyyy");
-        line += QLatin1String("</td><td>");
-        line += info.lastModified().toString("hh:mm:ss");
-        line += QLatin1String("</td></tr>\n");
+        line += QLatin1String(" class=\"tr-hidden\"");
+    }
+
+    line += QLatin1String("><td class=\"td-name ");
+    line += iconClass(info, styles);
+    line += QLatin1String("\"><a href=\"");
+    line += QUrl::fromLocalFile(info.absoluteFilePath()).toEncoded();
+    line += QLatin1String("\">");
+    line += QzTools::escape(info.fileName());
+    line += QLatin1String("</a></td><td class=\"td-size\">");
+    line += info.isDir() ? QString() : QzTools::fileSizeToString(info.size());
+    line += QLatin1String("</td><td>");
+    line += info.lastModified().toString("dd.MM.yyyy");
+    line += QLatin1String("</td><td>");
+    line += info.lastModified().toString("hh:mm:ss");
+    line += QLatin1String("</td></tr>\n");
+
+    return line;
+}
+
+QString FileSchemeReply::iconClass(const QFileInfo &info, QString &styles)
+{
+    // Icons are shared by all entries of the same type, both in the page
+    // (one CSS class per type) and across all directory listings
+    static QHash<QString, QByteArray> s_iconCache;
+
+    const QString key = iconCacheKey(info);
 
-        tBody.append(line);
+    if (m_iconClasses.contains(key)) {
+        return m_iconClasses.value(key);
     }
 
-    if (tBody.isEmpty()) {
-        tBody = QString("<tr><td colspan='4'>%1</td></tr>").arg(tr("Folder is empty."));
+    if (!s_iconCache.contains(key)) {
+        s_iconCache.insert(key, QzTools::pixmapToByteArray(QFileIconProvider().icon(info).pixmap(16)));
     }
 
-    page.replace(QLatin1String("%T-BODY%"), tBody);
-    page.replace(QLatin1String("%UP-DIR-DISPLAY%"), upDirDisplay);
-    page.replace(QLatin1String("%SHOW-HIDDEN-DISPLAY%"), showHiddenDisplay);
+    const QString className = QString("icon-%1").arg(m_iconClasses.count());
+    m_iconClasses.insert(key, className);
 
-    return page;
+    styles.append(QLatin1Char('.') + className);
+    styles.append(QLatin1String("{background-image:url(data:image/png;base64,"));
+    styles.append(QString::fromLatin1(s_iconCache.value(key)));
+    styles.append(QLatin1String(");}"));
+
+    return className;
 }
 
 QString FileSchemeReply::clickableSections(const QString &path)
@@ -19,11 +19,14 @@
 #define FILESCHEMEHANDLER_H
 
 #include <QNetworkReply>
-#include <QBuffer>
+#include <QFileInfo>
+#include <QHash>
 
 #include "schemehandler.h"
 #include "qzcommon.h"
 
+class QDirIterator;
+
 class QUPZILLA_EXPORT FileSchemeHandler : public SchemeHandler
 {
 public:
@@ -39,22 +42,38 @@ class QUPZILLA_EXPORT FileSchemeReply : public QNetworkReply
     Q_OBJECT
 public:
     explicit FileSchemeReply(const QNetworkRequest &req, QObject* parent = 0);
+    ~FileSchemeReply();
 
     qint64 bytesAvailable() const;
 
 protected:
     qint64 readData(char* data, qint64 maxSize);
-    void abort() { }
+    void abort();
 
 private slots:
     void loadPage();
+    void loadNextChunk();
 
 private:
-    QString loadDirectory();
+    QString pageHeader();
+    QString pageFooter();
+    QString entryRow(const QFileInfo &info, QString &styles);
+    QString iconClass(const QFileInfo &info, QString &styles);
     QString clickableSections(const QString &path);
 
-    QBuffer m_buffer;
-    QString m_pageName;
+    void appendData(const QString &data);
+    void finishPage();
+
+    QByteArray m_data;
+    qint64 m_bytesWritten;
+
+    QDirIterator* m_iterator;
+    QFileInfoList m_entries;
+    int m_position;
+
+    QHash<QString, QString> m_iconClasses;
+    bool m_hasHiddenEntries;
+    bool m_aborted;
 };
 
 
@@ -27,6 +27,10 @@
 #include "settings.h"
 #include "datapaths.h"
 #include "iconprovider.h"
+#include "htmltemplate.h"
+#include "networkmanager.h"
+#include "networkcache.h"
+#include "networkinstrumentation.h"
 
 #include <QTextStream>
 #include <QTimer>
@@ -37,6 +41,7 @@
 #include "qwebkitversion.h"
 #else
 #include <QWebPage>
+#include <QUrlQuery>
 #endif
 
 static QString authorString(const char* name, const QString &mail)
@@ -52,24 +57,27 @@ QNetworkReply* QupZillaSchemeHandler::createRequest(QNetworkAccessManager::Opera
 {
     Q_UNUSED(outgoingData)
 
-    if (op != QNetworkAccessManager::GetOperation) {
+    // Actions of network page are only accepted in POST requests, so they can't be triggered by links
+    const bool networkAction = op == QNetworkAccessManager::PostOperation && request.url().path() == QLatin1String("network");
+
+    if (op != QNetworkAccessManager::GetOperation && !networkAction) {
         return 0;
     }
 
-    QupZillaSchemeReply* reply = new QupZillaSchemeReply(request);
+    QupZillaSchemeReply* reply = new QupZillaSchemeReply(request, op);
     return reply;
 }
 
-QupZillaSchemeReply::QupZillaSchemeReply(const QNetworkRequest &req, QObject* parent)
+QupZillaSchemeReply::QupZillaSchemeReply(const QNetworkRequest &req, QNetworkAccessManager::Operation op, QObject* parent)
     : QNetworkReply(parent)
 {
-    setOperation(QNetworkAccessManager::GetOperation);
+    setOperation(op);
     setRequest(req);
     setUrl(req.url());
     m_pageName = req.url().path();
 
     QStringList knownPages;
-    knownPages << "about" << "reportbug" << "start" << "speeddial" << "config" << "restore";
+    knownPages << "about" << "reportbug" << "start" << "speeddial" << "config" << "restore" << "cache" << "network";
 
     if (knownPages.contains(m_pageName)) {
         m_buffer.open(QIODevice::ReadWrite);
@@ -90,6 +98,8 @@ void QupZillaSchemeReply::loadPage()
     QTextStream stream(&m_buffer);
     stream.setCodec("UTF-8");
 
+    QByteArray contentType("text/html");
+
     if (m_pageName == QLatin1String("about")) {
         stream << aboutPage();
     }
@@ -108,11 +118,41 @@ void QupZillaSchemeReply::loadPage()
     else if (m_pageName == QLatin1String("restore")) {
         stream << restorePage();
     }
+    else if (m_pageName == QLatin1String("cache")) {
+        stream << cachePage();
+    }
+    else if (m_pageName == QLatin1String("network")) {
+#if QT_VERSION >= 0x050000
+        const QUrlQuery query(url());
+#else
+        const QUrl query = url();
+#endif
+        NetworkInstrumentation* instrumentation = mApp->networkManager()->instrumentation();
+        const QString action = operation() == QNetworkAccessManager::PostOperation ? query.queryItemValue(QSL("action")) : QString();
+
+        if (action == QLatin1String("enable")) {
+            instrumentation->setEnabled(true);
+        }
+        else if (action == QLatin1String("disable")) {
+            instrumentation->setEnabled(false);
+        }
+        else if (action == QLatin1String("reset")) {
+            instrumentation->reset();
+        }
+
+        if (query.queryItemValue(QSL("format")) == QLatin1String("json")) {
+            contentType = "application/json";
+            stream << instrumentation->toJson();
+        }
+        else {
+            stream << networkPage();
+        }
+    }
 
     stream.flush();
     m_buffer.reset();
 
-    setHeader(QNetworkRequest::ContentTypeHeader, QByteArray("text/html"));
+    setHeader(QNetworkRequest::ContentTypeHeader, contentType);
     setHeader(QNetworkRequest::ContentLengthHeader, m_buffer.bytesAvailable());
     setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
     setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, QByteArray("Ok"));
@@ -283,9 +323,12 @@ QString QupZillaSchemeReply::aboutPage()
 
 QString QupZillaSchemeReply::speeddialPage()
 {
-    static QString dPage;
+    static HtmlTemplate dTemplate;
+    static QString renderedPage;
+    static int renderedRevision = -1;
 
-    if (dPage.isEmpty()) {
+    if (dTemplate.isEmpty()) {
+        QString dPage;
         dPage.append(QzTools::readAllFileContents(":html/speeddial.html"));
         dPage.replace(QLatin1String("%FAVICON%"), QLatin1String("qrc:icons/qupzilla.png"));
         dPage.replace(QLatin1String("%IMG_PLUS%"), QLatin1String("qrc:html/plus.png"));
@@ -323,19 +366,30 @@ QString QupZillaSchemeReply::speeddialPage()
         dPage.replace(QLatin1String("%TXT_SDSIZE%"), tr("Change size of pages:"));
         dPage.replace(QLatin1String("%TXT_CNTRDLS%"), tr("Center speed dials"));
         dPage = QzTools::applyDirectionToPage(dPage);
+
+        // Only the dynamic parts are replaced on every request
+        dTemplate.setSource(dPage);
     }
 
-    QString page = dPage;
     SpeedDial* dial = mApp->plugins()->speedDial();
 
-    page.replace(QLatin1String("%INITIAL-SCRIPT%"), dial->initialScript());
-    page.replace(QLatin1String("%IMG_BACKGROUND%"), dial->backgroundImage());
-    page.replace(QLatin1String("%B_SIZE%"), dial->backgroundImageSize());
-    page.replace(QLatin1String("%ROW-PAGES%"), QString::number(dial->pagesInRow()));
-    page.replace(QLatin1String("%SD-SIZE%"), QString::number(dial->sdSize()));
-    page.replace(QLatin1String("%SD-CNTR%"), QString::number(dial->sdCntr()));
+    // Rendered page is cached until the speed dial changes
+    if (renderedRevision == dial->revision()) {
+        return renderedPage;
+    }
+
+    QHash<QString, QString> values;
+    values[QSL("INITIAL-SCRIPT")] = dial->initialScript();
+    values[QSL("IMG_BACKGROUND")] = dial->backgroundImage();
+    values[QSL("B_SIZE")] = dial->backgroundImageSize();
+    values[QSL("ROW-PAGES")] = QString::number(dial->pagesInRow());
+    values[QSL("SD-SIZE")] = QString::number(dial->sdSize());
+    values[QSL("SD-CNTR")] = QString::number(dial->sdCntr());
+
+    renderedPage = dTemplate.render(values);
+    renderedRevision = dial->revision();
 
-    return page;
+    return renderedPage;
 }
 
 QString QupZillaSchemeReply::restorePage()
@@ -360,9 +414,10 @@ QString QupZillaSchemeReply::restorePage()
 
 QString QupZillaSchemeReply::configPage()
 {
-    static QString cPage;
+    static HtmlTemplate cTemplate;
 
-    if (cPage.isEmpty()) {
+    if (cTemplate.isEmpty()) {
+        QString cPage;
         cPage.append(QzTools::readAllFileContents(":html/config.html"));
         cPage.replace(QLatin1String("%FAVICON%"), QLatin1String("qrc:icons/qupzilla.png"));
         cPage.replace(QLatin1String("%BOX-BORDER%"), QLatin1String("qrc:html/box-border.png"));
@@ -438,25 +493,40 @@ QString QupZillaSchemeReply::configPage()
                       QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Portable build"), portableBuild));
 
         cPage = QzTools::applyDirectionToPage(cPage);
+
+        cTemplate.setSource(cPage);
     }
 
-    QString page = cPage;
-    page.replace(QLatin1String("%USER-AGENT%"), mApp->getWindow()->weView()->page()->userAgentForUrl(QUrl()));
+    QHash<QString, QString> values;
+    values[QSL("USER-AGENT")] = mApp->getWindow()->weView()->page()->userAgentForUrl(QUrl());
 
     QString pluginsString;
     const QList<Plugins::Plugin> &availablePlugins = mApp->plugins()->getAvailablePlugins();
 
+    const QHash<PluginInterface*, PluginProxy::HandlerStatistics> handlerStatistics = mApp->plugins()->handlerStatistics();
+
     foreach (const Plugins::Plugin &plugin, availablePlugins) {
         PluginSpec spec = plugin.pluginSpec;
+        QString description = spec.description;
+
+        // Time spent in event handlers helps to identify slow plugins
+        if (plugin.isLoaded() && handlerStatistics.contains(plugin.instance)) {
+            const PluginProxy::HandlerStatistics stats = handlerStatistics.value(plugin.instance);
+            description.append(QString("<br/><small>%1</small>").arg(tr("Event handlers: %1 calls, average %2 ms, maximum %3 ms").arg(
+                                   QString::number(stats.calls),
+                                   QString::number(stats.totalTime / 1000000.0 / qMax(stats.calls, 1), 'f', 3),
+                                   QString::number(stats.maxTime / 1000000.0, 'f', 3))));
+        }
+
         pluginsString.append(QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td></tr>").arg(
-                                 spec.name, spec.version, QzTools::escape(spec.author), spec.description));
+                                 spec.name, spec.version, QzTools::escape(spec.author), description));
     }
 
     if (pluginsString.isEmpty()) {
         pluginsString = QString("<tr><td colspan=4 class=\"no-available-plugins\">%1</td></tr>").arg(tr("No available extensions."));
     }
 
-    page.replace(QLatin1String("%PLUGINS-INFO%"), pluginsString);
+    values[QSL("PLUGINS-INFO")] = pluginsString;
 
     QString allGroupsString;
     QSettings* settings = Settings::globalSettings();
@@ -498,7 +568,198 @@ QString QupZillaSchemeReply::configPage()
         allGroupsString.append(groupString);
     }
 
-    page.replace(QLatin1String("%PREFS-INFO%"), allGroupsString);
+    values[QSL("PREFS-INFO")] = allGroupsString;
+
+    return cTemplate.render(values);
+}
+
+QString QupZillaSchemeReply::cachePage()
+{
+    static HtmlTemplate cTemplate;
+
+    if (cTemplate.isEmpty()) {
+        QString cPage;
+        cPage.append(QzTools::readAllFileContents(":html/cache.html"));
+        cPage.replace(QLatin1String("%FAVICON%"), QLatin1String("qrc:icons/qupzilla.png"));
+        cPage.replace(QLatin1String("%BOX-BORDER%"), QLatin1String("qrc:html/box-border.png"));
+        cPage.replace(QLatin1String("%ABOUT-IMG%"), QLatin1String("qrc:icons/other/about.png"));
+
+        cPage.replace(QLatin1String("%TITLE%"), tr("Network Cache"));
+        cPage.replace(QLatin1String("%CACHE%"), tr("Network Cache"));
+        cPage.replace(QLatin1String("%STORAGE%"), tr("Storage"));
+        cPage.replace(QLatin1String("%STATISTICS%"), tr("Statistics"));
+        cPage.replace(QLatin1String("%CACHE-ABOUT%"), tr("Statistics are counted since QupZilla was started. "
+                      "Small resources are kept also in memory, so they can be loaded without accessing the disk."));
+        cPage = QzTools::applyDirectionToPage(cPage);
+
+        cTemplate.setSource(cPage);
+    }
+
+    // Disk cache is not created just to show the page (eg. in private mode)
+    NetworkCache* cache = qobject_cast<NetworkCache*>(mApp->networkManager()->cache());
+
+    QHash<QString, QString> values;
+
+    if (!cache) {
+        values[QSL("STORAGE-INFO")] = QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Disk cache"), tr("Disabled"));
+        values[QSL("STATISTICS-INFO")] = QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Statistics"), tr("Not available"));
+        return cTemplate.render(values);
+    }
+
+    const NetworkCache::Statistics stats = cache->statistics();
+
+    const qint64 lookups = stats.hits + stats.misses;
+    const QString hitRate = lookups > 0 ? QString("%1 %").arg(QString::number(stats.hits * 100.0 / lookups, 'f', 1)) : tr("Not available");
+
+    values[QSL("STORAGE-INFO")] =
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Disk cache"), tr("<b>Enabled</b>")) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Location"), QzTools::escape(cache->cacheDirectory())) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Entries"), QString::number(stats.entries)) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Size"), tr("%1 of %2").arg(QzTools::fileSizeToString(stats.size),
+                QzTools::fileSizeToString(cache->maximumCacheSize()))) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Memory"), tr("%1 entries, %2").arg(QString::number(stats.memoryEntries),
+                QzTools::fileSizeToString(stats.memorySize)));
+
+    values[QSL("STATISTICS-INFO")] =
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Hits"), tr("%1 (%2 from memory)").arg(QString::number(stats.hits),
+                QString::number(stats.memoryHits))) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Misses"), QString::number(stats.misses)) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Hit rate"), hitRate) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Read from cache"), QzTools::fileSizeToString(stats.bytesRead)) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Written to cache"), QzTools::fileSizeToString(stats.bytesWritten)) +
+        QString("<dt>%1</dt><dd>%2<dd>").arg(tr("Evicted entries"), QString::number(stats.evictions));
+
+    return cTemplate.render(values);
+}
+
+static QString formatTime(qint64 usecs)
+{
+    if (usecs < 0) {
+        return QSL("-");
+    }
+
+    return QString::number(usecs / 1000.0, 'f', 1);
+}
+
+static QString aggregateRow(const QString &name, const NetworkInstrumentation::Aggregate &aggregate)
+{
+    const int requests = qMax(aggregate.requests, 1);
+
+    return QString("<tr><td title=\"%1\">%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td><td>%8</td></tr>").arg(
+               QzTools::escape(name),
+               QString::number(aggregate.requests),
+               QString::number(aggregate.failed),
+               QString::number(aggregate.fromCache),
+               QzTools::fileSizeToString(aggregate.bytesReceived),
+               formatTime(aggregate.dispatchTime / requests),
+               aggregate.responses > 0 ? formatTime(aggregate.responseTime / aggregate.responses) : formatTime(-1),
+               formatTime(aggregate.totalTime / requests));
+}
+
+QString QupZillaSchemeReply::networkPage()
+{
+    static HtmlTemplate nTemplate;
+
+    if (nTemplate.isEmpty()) {
+        QString nPage;
+        nPage.append(QzTools::readAllFileContents(":html/network.html"));
+        nPage.replace(QLatin1String("%FAVICON%"), QLatin1String("qrc:icons/qupzilla.png"));
+        nPage.replace(QLatin1String("%BOX-BORDER%"), QLatin1String("qrc:html/box-border.png"));
+        nPage.replace(QLatin1String("%ABOUT-IMG%"), QLatin1String("qrc:icons/other/about.png"));
+
+        nPage.replace(QLatin1String("%TITLE%"), tr("Network Requests"));
+        nPage.replace(QLatin1String("%NETWORK%"), tr("Network Requests"));
+        nPage.replace(QLatin1String("%TABS%"), tr("Tabs"));
+        nPage.replace(QLatin1String("%HOSTS%"), tr("Hosts"));
+        nPage.replace(QLatin1String("%REQUESTS%"), tr("Recent requests"));
+        nPage.replace(QLatin1String("%AGGREGATE-HEADER%"), QString("<tr><th>%1</th><th>%2</th><th>%3</th><th>%4</th><th>%5</th><th>%6</th><th>%7</th><th>%8</th></tr>").arg(
+                          tr("Name"), tr("Requests"), tr("Failed"), tr("From cache"), tr("Received"),
+                          tr("Avg. dispatch [ms]"), tr("Avg. response [ms]"), tr("Avg. total [ms]")));
+        nPage.replace(QLatin1String("%RQ-URL%"), tr("Address"));
+        nPage.replace(QLatin1String("%RQ-SOURCE%"), tr("Source"));
+        nPage.replace(QLatin1String("%RQ-STATUS%"), tr("Status"));
+        nPage.replace(QLatin1String("%RQ-DISPATCH%"), tr("Dispatch [ms]"));
+        nPage.replace(QLatin1String("%RQ-TLS%"), tr("Encrypted [ms]"));
+        nPage.replace(QLatin1String("%RQ-RESPONSE%"), tr("Response [ms]"));
+        nPage.replace(QLatin1String("%RQ-TOTAL%"), tr("Total [ms]"));
+        nPage.replace(QLatin1String("%RQ-BYTES%"), tr("Received"));
+        nPage.replace(QLatin1String("%NETWORK-ABOUT%"), tr("Dispatch is the time spent by deciding whether scheme handlers, extensions or AdBlock handle the request. "
+                      "Other times are counted from creating the request: encrypted connection established, response headers received and request finished. "
+                      "Instrumentation can be enabled on startup with NetworkInstrumentation option in Web-Browser-Settings."));
+        nPage = QzTools::applyDirectionToPage(nPage);
+
+        nTemplate.setSource(nPage);
+    }
+
+    const NetworkInstrumentation* instrumentation = mApp->networkManager()->instrumentation();
+    const QString noData = QString("<tr><td colspan=8 class=\"no-data\">%1</td></tr>").arg(tr("No requests recorded."));
+
+    QHash<QString, QString> values;
+
+    if (instrumentation->isEnabled()) {
+        values[QSL("STATUS")] = tr("Recording of network requests is <b>enabled</b>.");
+        values[QSL("ACTIONS")] = QString("<form method=\"post\" action=\"qupzilla:network?action=disable\"><input type=\"submit\" value=\"%1\"></form>").arg(tr("Disable"));
+    }
+    else {
+        values[QSL("STATUS")] = tr("Recording of network requests is disabled.");
+        values[QSL("ACTIONS")] = QString("<form method=\"post\" action=\"qupzilla:network?action=enable\"><input type=\"submit\" value=\"%1\"></form>").arg(tr("Enable"));
+    }
+
+    values[QSL("ACTIONS")].append(QString("<form method=\"post\" action=\"qupzilla:network?action=reset\"><input type=\"submit\" value=\"%1\"></form>").arg(tr("Reset")));
+    values[QSL("ACTIONS")].append(QString("<a href=\"qupzilla:network\">%1</a>").arg(tr("Refresh")));
+    values[QSL("ACTIONS")].append(QString("<a href=\"qupzilla:network?format=json\">%1</a>").arg(tr("Export as JSON")));
+
+    QString tabsString;
+    const QHash<quint64, NetworkInstrumentation::Aggregate> tabs = instrumentation->tabStatistics();
+    QHash<quint64, NetworkInstrumentation::Aggregate>::const_iterator tab = tabs.constBegin();
+    while (tab != tabs.constEnd()) {
+        if (tab.value().requests > 0) {
+            const QString name = tab.key() == 0 ? tr("Without tab") : tab.value().pageUrl;
+            tabsString.append(aggregateRow(name, tab.value()));
+        }
+        ++tab;
+    }
+
+    values[QSL("TABS-INFO")] = tabsString.isEmpty() ? noData : tabsString;
+
+    // Hosts with most requests first
+    const QHash<QString, NetworkInstrumentation::Aggregate> hosts = instrumentation->hostStatistics();
+    QMultiMap<int, QString> sortedHosts;
+    QHash<QString, NetworkInstrumentation::Aggregate>::const_iterator host = hosts.constBegin();
+    while (host != hosts.constEnd()) {
+        sortedHosts.insert(host.value().requests, host.key());
+        ++host;
+    }
+
+    QString hostsString;
+    QMapIterator<int, QString> sortedHost(sortedHosts);
+    sortedHost.toBack();
+    while (sortedHost.hasPrevious()) {
+        sortedHost.previous();
+        hostsString.append(aggregateRow(sortedHost.value(), hosts.value(sortedHost.value())));
+    }
+
+    values[QSL("HOSTS-INFO")] = hostsString.isEmpty() ? noData : hostsString;
+
+    // Only the latest requests, full list can be exported as JSON
+    QString requestsString;
+    const QList<NetworkInstrumentation::Request> requests = instrumentation->requests();
+    for (int i = requests.count() - 1; i >= 0 && i >= requests.count() - 100; --i) {
+        const NetworkInstrumentation::Request &r = requests.at(i);
+        const QString url = r.url.toString();
+
+        requestsString.append(QString("<tr><td title=\"%1\">%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td><td>%8</td></tr>").arg(
+                                  QzTools::escape(url),
+                                  NetworkInstrumentation::sourceToString(r.source),
+                                  r.failed ? tr("Failed") : QString::number(r.statusCode),
+                                  formatTime(r.dispatch.total()),
+                                  formatTime(r.encrypted),
+                                  formatTime(r.responseHeaders),
+                                  formatTime(r.finished),
+                                  QzTools::fileSizeToString(r.bytesReceived)));
+    }
+
+    values[QSL("REQUESTS-INFO")] = requestsString.isEmpty() ? noData : requestsString;
 
-    return page;
+    return nTemplate.render(values);
 }
@@ -36,7 +36,8 @@ class QUPZILLA_EXPORT QupZillaSchemeReply : public QNetworkReply
 {
     Q_OBJECT
 public:
-    explicit QupZillaSchemeReply(const QNetworkRequest &req, QObject* parent = 0);
+    explicit QupZillaSchemeReply(const QNetworkRequest &req, QNetworkAccessManager::Operation op = QNetworkAccessManager::GetOperation,
+                                 QObject* parent = 0);
 
     qint64 bytesAvailable() const;
 
@@ -55,6 +56,8 @@ private:
     QString speeddialPage();
     QString restorePage();
     QString configPage();
+    QString cachePage();
+    QString networkPage();
 
     QBuffer m_buffer;
     QString m_pageName;
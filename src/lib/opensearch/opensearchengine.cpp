@@ -47,6 +47,7 @@
 #include <qscriptengine.h>
 #include <qscriptvalue.h>
 #include <qstringlist.h>
+#include <qtimer.h>
 
 #if QT_VERSION >= 0x050000
 #include <QUrlQuery>
@@ -108,12 +109,18 @@ OpenSearchEngine::OpenSearchEngine(QObject* parent)
     , m_searchMethod(QLatin1String("get"))
     , m_suggestionsMethod(QLatin1String("get"))
     , m_networkAccessManager(0)
-    , m_suggestionsReply(0)
+    , m_suggestionsCache(50)
+    , m_maximumSuggestionsRequests(2)
     , m_scriptEngine(0)
     , m_delegate(0)
 {
     m_requestMethods.insert(QLatin1String("get"), QNetworkAccessManager::GetOperation);
     m_requestMethods.insert(QLatin1String("post"), QNetworkAccessManager::PostOperation);
+
+    m_suggestionsTimer = new QTimer(this);
+    m_suggestionsTimer->setSingleShot(true);
+    m_suggestionsTimer->setInterval(150);
+    connect(m_suggestionsTimer, SIGNAL(timeout()), this, SLOT(startSuggestionsRequest()));
 }
 
 /*!
@@ -121,6 +128,10 @@ OpenSearchEngine::OpenSearchEngine(QObject* parent)
 */
 OpenSearchEngine::~OpenSearchEngine()
 {
+    while (!m_suggestionsRequests.isEmpty()) {
+        abortSuggestionsRequest(0);
+    }
+
     if (m_scriptEngine) {
         m_scriptEngine->deleteLater();
     }
@@ -303,6 +314,7 @@ QString OpenSearchEngine::suggestionsUrlTemplate() const
 void OpenSearchEngine::setSuggestionsUrlTemplate(const QString &suggestionsUrlTemplate)
 {
     m_suggestionsUrlTemplate = suggestionsUrlTemplate;
+    clearSuggestionsCache();
 }
 
 /*!
@@ -382,6 +394,7 @@ OpenSearchEngine::Parameters OpenSearchEngine::suggestionsParameters() const
 void OpenSearchEngine::setSuggestionsParameters(const Parameters &suggestionsParameters)
 {
     m_suggestionsParameters = suggestionsParameters;
+    clearSuggestionsCache();
 }
 
 /*!
@@ -420,6 +433,7 @@ void OpenSearchEngine::setSuggestionsMethod(const QString &method)
     }
 
     m_suggestionsMethod = requestMethod;
+    clearSuggestionsCache();
 }
 
 /*!
@@ -546,11 +560,13 @@ bool OpenSearchEngine::operator<(const OpenSearchEngine &other) const
 void OpenSearchEngine::setSuggestionsParameters(const QByteArray &parameters)
 {
     m_preparedSuggestionsParameters = parameters;
+    clearSuggestionsCache();
 }
 
 void OpenSearchEngine::setSuggestionsUrl(const QString &string)
 {
     m_preparedSuggestionsUrl = string;
+    clearSuggestionsCache();
 }
 
 QString OpenSearchEngine::getSuggestionsUrl()
@@ -584,16 +600,47 @@ void OpenSearchEngine::requestSuggestions(const QString &searchTerm)
         return;
     }
 
-    if (m_suggestionsReply) {
-        m_suggestionsReply->disconnect(this);
-        m_suggestionsReply->abort();
-        m_suggestionsReply->deleteLater();
-        m_suggestionsReply = 0;
+    m_suggestionsSearchTerm = searchTerm;
+
+    QStringList list;
+    if (cachedSuggestions(searchTerm, list)) {
+        m_suggestionsTimer->stop();
+        if (!list.isEmpty()) {
+            emit suggestions(list);
+        }
+        return;
+    }
+
+    // Wait until user stops typing
+    m_suggestionsTimer->start();
+}
+
+void OpenSearchEngine::startSuggestionsRequest()
+{
+    const QString searchTerm = m_suggestionsSearchTerm;
+
+    if (searchTerm.isEmpty()) {
+        return;
+    }
+
+    foreach (const SuggestionsRequest &request, m_suggestionsRequests) {
+        if (request.searchTerm == searchTerm) {
+            return;
+        }
+    }
+
+    // Abort the oldest requests, their results are least likely to be needed
+    while (!m_suggestionsRequests.isEmpty() && m_suggestionsRequests.count() >= m_maximumSuggestionsRequests) {
+        abortSuggestionsRequest(0);
     }
 
+    SuggestionsRequest request;
+    request.searchTerm = searchTerm;
+    request.timer.start();
+
     Q_ASSERT(m_requestMethods.contains(m_suggestionsMethod));
     if (m_suggestionsMethod == QLatin1String("get")) {
-        m_suggestionsReply = m_networkAccessManager->get(QNetworkRequest(suggestionsUrl(searchTerm)));
+        request.reply = m_networkAccessManager->get(QNetworkRequest(suggestionsUrl(searchTerm)));
     }
     else {
         QStringList parameters;
@@ -604,10 +651,105 @@ void OpenSearchEngine::requestSuggestions(const QString &searchTerm)
         }
 
         QByteArray data = parameters.join(QLatin1String("&")).toUtf8();
-        m_suggestionsReply = m_networkAccessManager->post(QNetworkRequest(suggestionsUrl(searchTerm)), data);
+        request.reply = m_networkAccessManager->post(QNetworkRequest(suggestionsUrl(searchTerm)), data);
+    }
+
+    connect(request.reply, SIGNAL(finished()), this, SLOT(suggestionsObtained()));
+
+    m_suggestionsRequests.append(request);
+    m_suggestionsStats.requests++;
+}
+
+bool OpenSearchEngine::cachedSuggestions(const QString &searchTerm, QStringList &suggestions)
+{
+    const QString term = searchTerm.toLower();
+
+    if (QStringList* list = m_suggestionsCache.object(term)) {
+        suggestions = *list;
+        m_suggestionsStats.cacheHits++;
+        return true;
+    }
+
+    // Engines usually return up to 10 suggestions, if they returned less for
+    // a prefix, the list is complete and can be filtered for longer terms.
+    // Otherwise filtered list is used only if it contains enough suggestions.
+    const int completeCount = 10;
+    const int enoughCount = 6;
+
+    for (int length = term.length() - 1; length > 0; --length) {
+        QStringList* list = m_suggestionsCache.object(term.left(length));
+
+        // Empty list says nothing about longer terms
+        if (!list || list->isEmpty()) {
+            continue;
+        }
+
+        QStringList filtered;
+        foreach (const QString &suggestion, *list) {
+            if (suggestion.startsWith(searchTerm, Qt::CaseInsensitive)) {
+                filtered.append(suggestion);
+            }
+        }
+
+        if (list->count() < completeCount || filtered.count() >= enoughCount) {
+            suggestions = filtered;
+            m_suggestionsStats.prefixHits++;
+            return true;
+        }
+
+        return false;
     }
 
-    connect(m_suggestionsReply, SIGNAL(finished()), this, SLOT(suggestionsObtained()));
+    return false;
+}
+
+void OpenSearchEngine::abortSuggestionsRequest(int index)
+{
+    SuggestionsRequest request = m_suggestionsRequests.takeAt(index);
+
+    request.reply->disconnect(this);
+    request.reply->abort();
+    request.reply->deleteLater();
+
+    m_suggestionsStats.aborted++;
+}
+
+/*!
+    Returns the delay in milliseconds after the last requestSuggestions()
+    call before the suggestions are requested from the network.
+*/
+int OpenSearchEngine::suggestionsDelay() const
+{
+    return m_suggestionsTimer->interval();
+}
+
+void OpenSearchEngine::setSuggestionsDelay(int msec)
+{
+    m_suggestionsTimer->setInterval(msec);
+}
+
+/*!
+    Returns the maximum number of suggestions requests running at the same time.
+*/
+int OpenSearchEngine::maximumSuggestionsRequests() const
+{
+    return m_maximumSuggestionsRequests;
+}
+
+void OpenSearchEngine::setMaximumSuggestionsRequests(int count)
+{
+    m_maximumSuggestionsRequests = qMax(1, count);
+}
+
+OpenSearchEngine::SuggestionsStats OpenSearchEngine::suggestionsStats() const
+{
+    return m_suggestionsStats;
+}
+
+void OpenSearchEngine::clearSuggestionsCache()
+{
+    m_suggestionsCache.clear();
+    m_suggestionsSearchTerm.clear();
 }
 
 /*!
@@ -648,40 +790,83 @@ void OpenSearchEngine::requestSearchResults(const QString &searchTerm)
 
 void OpenSearchEngine::suggestionsObtained()
 {
-    QString response(QString::fromUtf8(m_suggestionsReply->readAll()));
-    response = response.trimmed();
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    int index = -1;
 
-    m_suggestionsReply->close();
-    m_suggestionsReply->deleteLater();
-    m_suggestionsReply = 0;
+    for (int i = 0; i < m_suggestionsRequests.count(); ++i) {
+        if (m_suggestionsRequests.at(i).reply == reply) {
+            index = i;
+            break;
+        }
+    }
 
-    if (response.isEmpty()) {
+    if (index == -1) {
         return;
     }
 
-    if (!response.startsWith(QLatin1Char('[')) || !response.endsWith(QLatin1Char(']'))) {
+    const SuggestionsRequest request = m_suggestionsRequests.takeAt(index);
+
+    const QByteArray data = reply->readAll();
+    const bool error = reply->error() != QNetworkReply::NoError;
+
+    reply->close();
+    reply->deleteLater();
+
+    if (error) {
+        m_suggestionsStats.failed++;
+        return;
+    }
+
+    // Unparsable response is not cached, so it is requested again
+    QStringList suggestionsList;
+    if (!parseSuggestions(data, suggestionsList)) {
+        m_suggestionsStats.failed++;
         return;
     }
 
+    const qint64 latency = request.timer.elapsed();
+    m_suggestionsStats.totalLatency += latency;
+    m_suggestionsStats.maxLatency = qMax(m_suggestionsStats.maxLatency, latency);
+
+    m_suggestionsCache.insert(request.searchTerm.toLower(), new QStringList(suggestionsList));
+
+    // Don't show suggestions for outdated search term
+    if (request.searchTerm == m_suggestionsSearchTerm && !suggestionsList.isEmpty()) {
+        emit suggestions(suggestionsList);
+    }
+}
+
+bool OpenSearchEngine::parseSuggestions(const QByteArray &data, QStringList &suggestions)
+{
+    QString response(QString::fromUtf8(data));
+    response = response.trimmed();
+
+    if (response.isEmpty()) {
+        return false;
+    }
+
+    if (!response.startsWith(QLatin1Char('[')) || !response.endsWith(QLatin1Char(']'))) {
+        return false;
+    }
+
     if (!m_scriptEngine) {
         m_scriptEngine = new QScriptEngine();
     }
 
     // Evaluate the JSON response using QtScript.
     if (!m_scriptEngine->canEvaluate(response)) {
-        return;
+        return false;
     }
 
     QScriptValue responseParts = m_scriptEngine->evaluate(response);
 
     if (!responseParts.property(1).isArray()) {
-        return;
+        return false;
     }
 
-    QStringList suggestionsList;
-    qScriptValueToSequence(responseParts.property(1), suggestionsList);
+    qScriptValueToSequence(responseParts.property(1), suggestions);
 
-    emit suggestions(suggestionsList);
+    return true;
 }
 
 /*!
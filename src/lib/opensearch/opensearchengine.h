@@ -42,10 +42,13 @@
 #include <qpair.h>
 #include <qimage.h>
 #include <qmap.h>
+#include <qcache.h>
+#include <qelapsedtimer.h>
 #include <qnetworkaccessmanager.h>
 #include <qstring.h>
 #include <qurl.h>
 
+class QTimer;
 class QNetworkReply;
 class QScriptEngine;
 
@@ -62,6 +65,24 @@ public:
     typedef QPair<QString, QString> Parameter;
     typedef QList<Parameter> Parameters;
 
+    struct SuggestionsStats {
+        SuggestionsStats() : requests(0), cacheHits(0), prefixHits(0), aborted(0), failed(0), totalLatency(0), maxLatency(0) { }
+
+        // Latencies are in milliseconds, measured only for finished requests
+        qint64 averageLatency() const {
+            const int finished = requests - aborted - failed;
+            return finished > 0 ? totalLatency / finished : 0;
+        }
+
+        int requests;
+        int cacheHits;
+        int prefixHits;
+        int aborted;
+        int failed;
+        qint64 totalLatency;
+        qint64 maxLatency;
+    };
+
     Q_PROPERTY(QString name READ name WRITE setName)
     Q_PROPERTY(QString description READ description WRITE setDescription)
     Q_PROPERTY(QString searchUrlTemplate READ searchUrlTemplate WRITE setSearchUrlTemplate)
@@ -127,6 +148,15 @@ public:
     OpenSearchEngineDelegate* delegate() const;
     void setDelegate(OpenSearchEngineDelegate* delegate);
 
+    int suggestionsDelay() const;
+    void setSuggestionsDelay(int msec);
+
+    int maximumSuggestionsRequests() const;
+    void setMaximumSuggestionsRequests(int count);
+
+    SuggestionsStats suggestionsStats() const;
+    void clearSuggestionsCache();
+
     bool operator==(const OpenSearchEngine &other) const;
     bool operator<(const OpenSearchEngine &other) const;
 
@@ -141,8 +171,19 @@ protected:
 private slots:
     void imageObtained();
     void suggestionsObtained();
+    void startSuggestionsRequest();
 
 private:
+    struct SuggestionsRequest {
+        QNetworkReply* reply;
+        QString searchTerm;
+        QElapsedTimer timer;
+    };
+
+    bool cachedSuggestions(const QString &searchTerm, QStringList &suggestions);
+    bool parseSuggestions(const QByteArray &data, QStringList &suggestions);
+    void abortSuggestionsRequest(int index);
+
     QString m_name;
     QString m_description;
 
@@ -162,7 +203,15 @@ private:
     QMap<QString, QNetworkAccessManager::Operation> m_requestMethods;
 
     QNetworkAccessManager* m_networkAccessManager;
-    QNetworkReply* m_suggestionsReply;
+
+    // Suggestions are debounced, cached by lowercase search term and
+    // filtered locally from shorter cached prefixes when possible
+    QTimer* m_suggestionsTimer;
+    QString m_suggestionsSearchTerm;
+    QList<SuggestionsRequest> m_suggestionsRequests;
+    QCache<QString, QStringList> m_suggestionsCache;
+    int m_maximumSuggestionsRequests;
+    SuggestionsStats m_suggestionsStats;
 
     QScriptEngine* m_scriptEngine;
 
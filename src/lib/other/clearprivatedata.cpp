@@ -23,6 +23,7 @@
 #include "settings.h"
 #include "datapaths.h"
 #include "mainapplication.h"
+#include "networkcache.h"
 #include "networkmanager.h"
 #include "clickablelabel.h"
 #include "ui_clearprivatedata.h"
@@ -33,18 +34,22 @@
 #include <QMessageBox>
 #include <QWebDatabase>
 #include <QWebSettings>
-#include <QNetworkDiskCache>
 #include <QDateTime>
 #include <QSqlQuery>
 #include <QCloseEvent>
 #include <QFileInfo>
+#include <QPushButton>
 
 ClearPrivateData::ClearPrivateData(QWidget* parent)
     : QDialog(parent)
     , ui(new Ui::ClearPrivateData)
+    , m_job(0)
+    , m_closeAfterJob(false)
 {
     ui->setupUi(this);
     ui->buttonBox->setFocus();
+    ui->progressLabel->hide();
+    ui->progressBar->hide();
     connect(ui->history, SIGNAL(clicked(bool)), this, SLOT(historyClicked(bool)));
     connect(ui->buttonBox, SIGNAL(accepted()), this, SLOT(dialogAccepted()));
     connect(ui->optimizeDb, SIGNAL(clicked(QPoint)), this, SLOT(optimizeDb()));
@@ -92,8 +97,27 @@ void ClearPrivateData::clearIcons()
     IconProvider::instance()->clearIconsDatabase();
 }
 
+void ClearPrivateData::reject()
+{
+    if (m_job) {
+        m_job->cancel();
+        m_closeAfterJob = true;
+        ui->progressLabel->setText(tr("Canceling..."));
+        return;
+    }
+
+    QDialog::reject();
+}
+
 void ClearPrivateData::closeEvent(QCloseEvent* e)
 {
+    if (m_job) {
+        m_job->cancel();
+        m_closeAfterJob = true;
+        e->ignore();
+        return;
+    }
+
     Settings settings;
     settings.beginGroup("ClearPrivateData");
     settings.setValue("state", saveState());
@@ -112,11 +136,12 @@ void ClearPrivateData::dialogAccepted()
         return;
     }
 
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    ClearPrivateDataJob::Tasks tasks = ClearPrivateDataJob::NoTask;
+    qint64 start = QDateTime::currentMSecsSinceEpoch();
+    qint64 end = 0;
 
     if (ui->history->isChecked()) {
-        qint64 start = QDateTime::currentMSecsSinceEpoch();
-        qint64 end = 0;
+        tasks |= ClearPrivateDataJob::ClearHistory;
 
         const QDate today = QDate::currentDate();
         const QDate week = today.addDays(1 - today.dayOfWeek());
@@ -135,14 +160,6 @@ void ClearPrivateData::dialogAccepted()
         case 3: //All
             break;
         }
-
-        if (end == 0) {
-            mApp->history()->clearHistory();
-        }
-        else {
-            const QList<int> &indexes = mApp->history()->indexesFromTimeRange(start, end);
-            mApp->history()->deleteHistoryEntry(indexes);
-        }
     }
 
     if (ui->cookies->isChecked()) {
@@ -150,40 +167,111 @@ void ClearPrivateData::dialogAccepted()
     }
 
     if (ui->cache->isChecked()) {
-        clearCache();
+        tasks |= ClearPrivateDataJob::ClearCache;
     }
 
     if (ui->databases->isChecked()) {
-        clearWebDatabases();
+        tasks |= ClearPrivateDataJob::ClearWebDatabases;
     }
 
     if (ui->localStorage->isChecked()) {
-        clearLocalStorage();
+        tasks |= ClearPrivateDataJob::ClearLocalStorage;
     }
 
     if (ui->icons->isChecked()) {
-        clearIcons();
+        tasks |= ClearPrivateDataJob::ClearIcons;
     }
 
-    QApplication::restoreOverrideCursor();
+    if (tasks == ClearPrivateDataJob::NoTask) {
+        close();
+        return;
+    }
 
-    close();
+    // Dialog is closed when the job finishes
+    m_closeAfterJob = true;
+
+    ClearPrivateDataJob* job = new ClearPrivateDataJob(tasks, this);
+    job->setHistoryRange(start, end);
+    startJob(job);
 }
 
 void ClearPrivateData::optimizeDb()
 {
-    mApp->setOverrideCursor(Qt::WaitCursor);
+    if (m_job) {
+        return;
+    }
 
     const QString profilePath = DataPaths::currentProfilePath();
-    QString sizeBefore = QzTools::fileSizeToString(QFileInfo(profilePath + "/browsedata.db").size());
+    m_sizeBefore = QzTools::fileSizeToString(QFileInfo(profilePath + "/browsedata.db").size());
 
-    mApp->history()->optimizeHistory();
+    startJob(new ClearPrivateDataJob(ClearPrivateDataJob::OptimizeDatabase, this));
+}
 
-    QString sizeAfter = QzTools::fileSizeToString(QFileInfo(profilePath + "/browsedata.db").size());
+void ClearPrivateData::startJob(ClearPrivateDataJob* job)
+{
+    m_job = job;
 
-    mApp->restoreOverrideCursor();
+    connect(m_job, SIGNAL(progressChanged(QString,int,int)), this, SLOT(jobProgressChanged(QString,int,int)));
+    connect(m_job, SIGNAL(finished()), this, SLOT(jobFinished()));
 
-    QMessageBox::information(this, tr("Database Optimized"), tr("Database successfully optimized.<br/><br/><b>Database Size Before: </b>%1<br/><b>Database Size After: </b>%2").arg(sizeBefore, sizeAfter));
+    setControlsEnabled(false);
+    ui->progressLabel->show();
+    ui->progressBar->show();
+    ui->progressBar->setRange(0, 0);
+
+    m_job->start();
+}
+
+void ClearPrivateData::jobProgressChanged(const QString &text, int value, int maximum)
+{
+    if (!m_job || m_job->isCanceled()) {
+        return;
+    }
+
+    ui->progressLabel->setText(text);
+    ui->progressBar->setRange(0, maximum);
+    ui->progressBar->setValue(value);
+}
+
+void ClearPrivateData::jobFinished()
+{
+    ClearPrivateDataJob* job = m_job;
+    m_job = 0;
+    job->deleteLater();
+
+    // History was deleted directly in database
+    if (job->tasks() & ClearPrivateDataJob::ClearHistory) {
+        mApp->history()->reloadHistory();
+    }
+
+    if (m_closeAfterJob) {
+        close();
+        return;
+    }
+
+    setControlsEnabled(true);
+    ui->progressLabel->hide();
+    ui->progressBar->hide();
+
+    if (job->tasks() & ClearPrivateDataJob::OptimizeDatabase) {
+        const QString profilePath = DataPaths::currentProfilePath();
+        const QString sizeAfter = QzTools::fileSizeToString(QFileInfo(profilePath + "/browsedata.db").size());
+
+        QMessageBox::information(this, tr("Database Optimized"), tr("Database successfully optimized.<br/><br/><b>Database Size Before: </b>%1<br/><b>Database Size After: </b>%2").arg(m_sizeBefore, sizeAfter));
+    }
+}
+
+void ClearPrivateData::setControlsEnabled(bool enabled)
+{
+    ui->history->setEnabled(enabled);
+    ui->historyLength->setEnabled(enabled && ui->history->isChecked());
+    ui->databases->setEnabled(enabled);
+    ui->localStorage->setEnabled(enabled);
+    ui->cache->setEnabled(enabled);
+    ui->cookies->setEnabled(enabled);
+    ui->icons->setEnabled(enabled);
+    ui->optimizeDb->setEnabled(enabled);
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(enabled);
 }
 
 static const int stateDataVersion = 0x0001;
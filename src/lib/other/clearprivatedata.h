@@ -21,6 +21,7 @@
 #include <QDialog>
 
 #include "qzcommon.h"
+#include "clearprivatedatajob.h"
 
 namespace Ui
 {
@@ -43,13 +44,23 @@ private slots:
     void dialogAccepted();
     void optimizeDb();
 
+    void jobProgressChanged(const QString &text, int value, int maximum);
+    void jobFinished();
+
 private:
+    void reject();
     void closeEvent(QCloseEvent* e);
 
+    void startJob(ClearPrivateDataJob* job);
+    void setControlsEnabled(bool enabled);
+
     void restoreState(const QByteArray &state);
     QByteArray saveState();
 
     Ui::ClearPrivateData* ui;
+    ClearPrivateDataJob* m_job;
+    QString m_sizeBefore;
+    bool m_closeAfterJob;
 
 };
 
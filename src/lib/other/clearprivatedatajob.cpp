@@ -0,0 +1,332 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "clearprivatedatajob.h"
+#include "mainapplication.h"
+#include "networkcache.h"
+#include "iconprovider.h"
+#include "downloadsmodel.h"
+#include "sqldatabase.h"
+#include "datapaths.h"
+#include "qztools.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QUrl>
+#include <QThread>
+#include <QDateTime>
+#include <QDirIterator>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QWebSettings>
+#include <QWebDatabase>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrentRun>
+#else
+#include <QtConcurrentRun>
+#endif
+
+// Number of history entries deleted in one transaction
+static const int s_historyBatchSize = 500;
+// Number of pages freed by one incremental vacuum step
+static const int s_vacuumPages = 256;
+
+ClearPrivateDataJob::ClearPrivateDataJob(Tasks tasks, QObject* parent)
+    : QObject(parent)
+    , m_tasks(tasks)
+    , m_historyStart(0)
+    , m_historyEnd(0)
+    , m_profilePath(DataPaths::currentProfilePath())
+    , m_canceled(0)
+{
+    m_watcher = new QFutureWatcher<void>(this);
+    connect(m_watcher, SIGNAL(finished()), this, SLOT(slotFinished()));
+}
+
+ClearPrivateDataJob::~ClearPrivateDataJob()
+{
+    // Background part of the job uses members of this object
+    cancel();
+    m_watcher->waitForFinished();
+}
+
+void ClearPrivateDataJob::setHistoryRange(qint64 start, qint64 end)
+{
+    m_historyStart = start;
+    m_historyEnd = end;
+}
+
+void ClearPrivateDataJob::start()
+{
+    Q_ASSERT(!m_watcher->isRunning());
+
+    if (m_tasks & ClearCache) {
+        QWebSettings::globalSettings()->clearMemoryCaches();
+
+        // Cache directory is only detached here and its files are removed in background.
+        // Directories left by canceled jobs are removed with the next one.
+        NetworkCache* cache = mApp->networkCache();
+        m_cacheBasePath = QDir(cache->cacheDirectory()).absolutePath();
+
+        const QString removedPath = m_cacheBasePath + QL1S(".removed-") + QString::number(QDateTime::currentMSecsSinceEpoch());
+        if (QDir().rename(m_cacheBasePath, removedPath)) {
+            cache->setCacheDirectory(m_cacheBasePath);
+        }
+
+        cache->clear();
+    }
+
+    if (m_tasks & ClearWebDatabases) {
+        QWebDatabase::removeAllDatabases();
+    }
+
+    if (m_tasks & ClearIcons) {
+        QWebSettings::globalSettings()->clearIconDatabase();
+    }
+
+    // Icons not yet written would be saved again after they were deleted
+    if ((m_tasks & ClearIcons) || ((m_tasks & ClearHistory) && m_historyEnd == 0)) {
+        IconProvider::instance()->clearIconsBuffer();
+    }
+
+    QFuture<void> future = QtConcurrent::run(this, &ClearPrivateDataJob::runJob);
+    m_watcher->setFuture(future);
+}
+
+bool ClearPrivateDataJob::isRunning() const
+{
+    return m_watcher->isRunning();
+}
+
+void ClearPrivateDataJob::cancel()
+{
+    m_canceled.fetchAndStoreOrdered(1);
+}
+
+bool ClearPrivateDataJob::isCanceled() const
+{
+#if QT_VERSION >= 0x050000
+    return m_canceled.load() != 0;
+#else
+    return m_canceled != 0;
+#endif
+}
+
+ClearPrivateDataJob::Tasks ClearPrivateDataJob::tasks() const
+{
+    return m_tasks;
+}
+
+void ClearPrivateDataJob::slotFinished()
+{
+    emit finished();
+}
+
+void ClearPrivateDataJob::runJob()
+{
+    QSqlDatabase db = SqlDatabase::instance()->databaseForThread(QThread::currentThread());
+
+    if ((m_tasks & ClearHistory) && !isCanceled()) {
+        clearHistory(db);
+    }
+
+    if ((m_tasks & ClearCache) && !isCanceled()) {
+        emit progressChanged(tr("Deleting cache..."), 0, 0);
+
+        const QFileInfo info(m_cacheBasePath);
+        const QString removedPrefix = info.fileName() + QL1S(".removed-");
+        const QStringList removed = info.dir().entryList(QStringList(removedPrefix + QLatin1Char('*')), QDir::Dirs | QDir::NoDotAndDotDot);
+
+        foreach (const QString &dir, removed) {
+            removeDirectory(info.dir().absoluteFilePath(dir));
+        }
+
+        QFile::remove(m_profilePath + QL1S("/ApplicationCache.db"));
+    }
+
+    if ((m_tasks & ClearWebDatabases) && !isCanceled()) {
+        emit progressChanged(tr("Deleting web databases..."), 0, 0);
+        removeDirectory(m_profilePath + QL1S("/Databases"));
+    }
+
+    if ((m_tasks & ClearLocalStorage) && !isCanceled()) {
+        emit progressChanged(tr("Deleting local storage..."), 0, 0);
+        removeDirectory(m_profilePath + QL1S("/LocalStorage"));
+    }
+
+    if ((m_tasks & ClearIcons) && !isCanceled()) {
+        clearIcons(db);
+    }
+
+    if (!isCanceled()) {
+        if (m_tasks & OptimizeDatabase) {
+            vacuumDatabase(db, true);
+        }
+        else if (m_tasks & (ClearHistory | ClearIcons)) {
+            vacuumDatabase(db, false);
+        }
+    }
+}
+
+void ClearPrivateDataJob::clearHistory(QSqlDatabase &db)
+{
+    const QString text = tr("Deleting history...");
+    QSqlQuery query(db);
+
+    // Whole history together with icons of all visited pages and finished downloads.
+    // Model of download manager is updated with History::resetHistory() after the job.
+    if (m_historyEnd == 0) {
+        emit progressChanged(text, 0, 0);
+
+        db.transaction();
+        query.exec(QSL("DELETE FROM history"));
+        query.exec(QSL("DELETE FROM icons"));
+
+        if (db.tables().contains(QL1S("icon_data"))) {
+            query.exec(QSL("DELETE FROM icon_data"));
+        }
+
+        DownloadsModel::deleteFinished(db);
+        db.commit();
+        return;
+    }
+
+    DownloadsModel::deleteFinished(db, m_historyEnd, m_historyStart);
+
+    query.prepare(QSL("SELECT COUNT(*) FROM history WHERE date BETWEEN ? AND ?"));
+    query.addBindValue(m_historyEnd);
+    query.addBindValue(m_historyStart);
+    query.exec();
+
+    const int total = query.next() ? query.value(0).toInt() : 0;
+    int deleted = 0;
+
+    emit progressChanged(text, 0, total);
+
+    while (deleted < total && !isCanceled()) {
+        query.prepare(QSL("SELECT id, url FROM history WHERE date BETWEEN ? AND ? LIMIT ?"));
+        query.addBindValue(m_historyEnd);
+        query.addBindValue(m_historyStart);
+        query.addBindValue(s_historyBatchSize);
+        query.exec();
+
+        QVariantList ids;
+        QVariantList urls;
+
+        while (query.next()) {
+            ids.append(query.value(0));
+            urls.append(query.value(1).toUrl().toEncoded(QUrl::RemoveFragment));
+        }
+
+        if (ids.isEmpty()) {
+            break;
+        }
+
+        db.transaction();
+
+        QSqlQuery deleteQuery(db);
+        deleteQuery.prepare(QSL("DELETE FROM history WHERE id = ?"));
+        deleteQuery.addBindValue(ids);
+        deleteQuery.execBatch();
+
+        deleteQuery.prepare(QSL("DELETE FROM icons WHERE url = ?"));
+        deleteQuery.addBindValue(urls);
+        deleteQuery.execBatch();
+
+        db.commit();
+
+        deleted += ids.count();
+        emit progressChanged(text, deleted, total);
+    }
+
+    if (db.tables().contains(QL1S("icon_data"))) {
+        query.exec(QSL("DELETE FROM icon_data WHERE id NOT IN (SELECT data_id FROM icons WHERE data_id IS NOT NULL)"));
+    }
+}
+
+void ClearPrivateDataJob::clearIcons(QSqlDatabase &db)
+{
+    emit progressChanged(tr("Deleting icons..."), 0, 0);
+
+    QSqlQuery query(db);
+    query.exec(QSL("DELETE FROM icons"));
+
+    if (db.tables().contains(QL1S("icon_data"))) {
+        query.exec(QSL("DELETE FROM icon_data"));
+    }
+}
+
+void ClearPrivateDataJob::removeDirectory(const QString &path)
+{
+    QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::System, QDirIterator::Subdirectories);
+
+    while (it.hasNext()) {
+        if (isCanceled()) {
+            return;
+        }
+
+        QFile::remove(it.next());
+    }
+
+    // Only empty directories are left
+    QzTools::removeDir(path);
+}
+
+void ClearPrivateDataJob::vacuumDatabase(QSqlDatabase &db, bool full)
+{
+    const QString text = tr("Optimizing database...");
+    QSqlQuery query(db);
+
+    query.exec(QSL("PRAGMA auto_vacuum"));
+    const bool incremental = query.next() && query.value(0).toInt() == 2;
+
+    if (!incremental) {
+        // Space of deleted rows is reused by SQLite, so full VACUUM is only done
+        // when explicitly requested. It also switches database to incremental
+        // vacuum, so next optimizations don't need to rebuild whole database.
+        if (full) {
+            emit progressChanged(text, 0, 0);
+            query.exec(QSL("PRAGMA auto_vacuum = INCREMENTAL"));
+            query.exec(QSL("VACUUM"));
+        }
+        return;
+    }
+
+    query.exec(QSL("PRAGMA freelist_count"));
+    const int total = query.next() ? query.value(0).toInt() : 0;
+    int remaining = total;
+
+    while (remaining > 0 && !isCanceled()) {
+        emit progressChanged(text, total - remaining, total);
+
+        // Each result row means one freed page
+        query.exec(QString("PRAGMA incremental_vacuum(%1)").arg(s_vacuumPages));
+        while (query.next()) {
+        }
+
+        query.exec(QSL("PRAGMA freelist_count"));
+        const int freePages = query.next() ? query.value(0).toInt() : 0;
+
+        if (freePages >= remaining) {
+            break;
+        }
+
+        remaining = freePages;
+    }
+}
@@ -0,0 +1,92 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef CLEARPRIVATEDATAJOB_H
+#define CLEARPRIVATEDATAJOB_H
+
+#include <QFutureWatcher>
+#include <QAtomicInt>
+
+#include "qzcommon.h"
+
+class QSqlDatabase;
+
+class QUPZILLA_EXPORT ClearPrivateDataJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Task {
+        NoTask = 0,
+        ClearHistory = 1 << 0,
+        ClearCache = 1 << 1,
+        ClearWebDatabases = 1 << 2,
+        ClearLocalStorage = 1 << 3,
+        ClearIcons = 1 << 4,
+        OptimizeDatabase = 1 << 5
+    };
+    Q_DECLARE_FLAGS(Tasks, Task)
+
+    explicit ClearPrivateDataJob(Tasks tasks, QObject* parent = 0);
+    // Cancels the job and waits for the currently running step to finish
+    ~ClearPrivateDataJob();
+
+    // Deletes history entries visited between end and start (in msecs since epoch)
+    // Whole history is deleted when end is 0
+    void setHistoryRange(qint64 start, qint64 end);
+
+    // Parts that must run on main thread are done right away, rest of the job
+    // runs on one thread from QThreadPool
+    void start();
+    bool isRunning() const;
+
+    // Cancellation is checked between individual steps of the job,
+    // data already deleted at that point stays deleted
+    void cancel();
+    bool isCanceled() const;
+
+    Tasks tasks() const;
+
+signals:
+    // Maximum is 0 when progress of current step is unknown
+    void progressChanged(const QString &text, int value, int maximum);
+    void finished();
+
+private slots:
+    void slotFinished();
+
+private:
+    void runJob();
+
+    void clearHistory(QSqlDatabase &db);
+    void clearIcons(QSqlDatabase &db);
+    void removeDirectory(const QString &path);
+    void vacuumDatabase(QSqlDatabase &db, bool full);
+
+    Tasks m_tasks;
+    qint64 m_historyStart;
+    qint64 m_historyEnd;
+    QString m_profilePath;
+    QString m_cacheBasePath;
+
+    QAtomicInt m_canceled;
+    QFutureWatcher<void>* m_watcher;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ClearPrivateDataJob::Tasks)
+
+#endif // CLEARPRIVATEDATAJOB_H
@@ -19,6 +19,7 @@
 #include "ui_iconchooser.h"
 #include "mainapplication.h"
 #include "proxystyle.h"
+#include "iconprovider.h"
 #include "qztools.h"
 
 #include <QFileDialog>
@@ -65,7 +66,7 @@ void IconChooser::searchIcon(const QString &string)
     ui->iconList->clear();
 
     QSqlQuery query;
-    query.prepare("SELECT icon FROM icons WHERE url LIKE ? LIMIT 20");
+    query.prepare(QString("SELECT DISTINCT %1 WHERE icons.url LIKE ? LIMIT 20").arg(IconProvider::iconDataSource()));
     query.bindValue(0, QString("%%1%").arg(string));
     query.exec();
 
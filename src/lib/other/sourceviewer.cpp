@@ -32,6 +32,7 @@
 #include <QInputDialog>
 #include <QWebFrame>
 #include <QTimer>
+#include <QScrollBar>
 
 SourceViewer::SourceViewer(QWebFrame* frame, const QString &selectedHtml)
     : QWidget(0)
@@ -62,7 +63,7 @@ SourceViewer::SourceViewer(QWebFrame* frame, const QString &selectedHtml)
     font.setPointSize(10);
 
     m_sourceEdit->setFont(font);
-    new HtmlHighlighter(m_sourceEdit->document());
+    m_highlighter = new HtmlHighlighter(m_sourceEdit->document());
 
     resize(650, 600);
     QzTools::centerWidgetToParent(this, frame->page()->view());
@@ -106,6 +107,7 @@ SourceViewer::SourceViewer(QWebFrame* frame, const QString &selectedHtml)
     connect(m_sourceEdit, SIGNAL(redoAvailable(bool)), this, SLOT(redoAvailable(bool)));
     connect(m_sourceEdit, SIGNAL(undoAvailable(bool)), this, SLOT(undoAvailable(bool)));
     connect(menuEdit, SIGNAL(aboutToShow()), this, SLOT(pasteAvailable()));
+    connect(m_sourceEdit->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(highlightVisibleBlocks()));
 
     QTimer::singleShot(0, this, SLOT(loadSource()));
 }
@@ -151,9 +153,12 @@ void SourceViewer::loadSource()
     m_actionPaste->setEnabled(false);
 
     QString html = m_frame.data()->toHtml();
-    // Remove AdBlock element hiding rules
-    html.remove(QzRegExp("<style type=\"text/css\">\n/\\* AdBlock for QupZilla \\*/\n.*\\{display:none !important;\\}[\n]*</style>"));
+    removeAdBlockStyles(html);
+
+    // Only visible blocks are highlighted right away, the rest is highlighted in background
+    m_highlighter->resetHighlighting();
     m_sourceEdit->setPlainText(html);
+    highlightVisibleBlocks();
 
     // Highlight selectedHtml
     if (!m_selectedHtml.isEmpty()) {
@@ -163,6 +168,30 @@ void SourceViewer::loadSource()
     m_sourceEdit->setShowingCursor(true);
 }
 
+void SourceViewer::removeAdBlockStyles(QString &html) const
+{
+    // Element hiding rules are added by WebPage::cleanBlockedObjects()
+    const QString start = QLatin1String("<style type=\"text/css\">\n/* AdBlock for QupZilla */\n");
+    const QString end = QLatin1String("</style>");
+
+    int index = html.indexOf(start);
+    while (index != -1) {
+        const int endIndex = html.indexOf(end, index + start.length());
+        if (endIndex == -1) {
+            break;
+        }
+
+        html.remove(index, endIndex + end.length() - index);
+        index = html.indexOf(start, index);
+    }
+}
+
+void SourceViewer::highlightVisibleBlocks()
+{
+    const QTextCursor cursor = m_sourceEdit->cursorForPosition(QPoint(0, m_sourceEdit->viewport()->height()));
+    m_highlighter->highlightToBlock(cursor.blockNumber());
+}
+
 void SourceViewer::save()
 {
     QString filePath = QzTools::getSaveFileName("SourceViewer-Save", this, tr("Save file..."), QDir::homePath() + "/source_code.html");
@@ -24,6 +24,7 @@
 #include "qzcommon.h"
 
 class PlainEditWithLines;
+class HtmlHighlighter;
 
 class QBoxLayout;
 class QStatusBar;
@@ -51,9 +52,14 @@ private slots:
     void setTextWordWrap();
     void goToLine();
 
+    void highlightVisibleBlocks();
+
 private:
+    void removeAdBlockStyles(QString &html) const;
+
     QBoxLayout* m_layout;
     PlainEditWithLines* m_sourceEdit;
+    HtmlHighlighter* m_highlighter;
     QPointer<QWebFrame> m_frame;
     QStatusBar* m_statusBar;
 
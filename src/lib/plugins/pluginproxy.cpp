@@ -21,72 +21,137 @@
 #include "settings.h"
 
 #include <QMenu>
+#include <QElapsedTimer>
 
 PluginProxy::PluginProxy()
     : Plugins()
 {
+    // Measuring handlers adds overhead to every event, so it is only enabled on request
+    Settings settings;
+    m_profileHandlers = settings.value("Plugin-Settings/ProfileEventHandlers", false).toBool();
+
     connect(this, SIGNAL(pluginUnloaded(PluginInterface*)), this, SLOT(pluginUnloaded(PluginInterface*)));
 }
 
 void PluginProxy::registerAppEventHandler(const PluginProxy::EventHandlerType &type, PluginInterface* obj)
 {
-    switch (type) {
-    case MouseDoubleClickHandler:
-        if (!m_mouseDoubleClickHandlers.contains(obj)) {
-            m_mouseDoubleClickHandlers.append(obj);
-        }
-        break;
+    addRegistration(type, obj, -1);
+}
 
-    case MousePressHandler:
-        if (!m_mousePressHandlers.contains(obj)) {
-            m_mousePressHandlers.append(obj);
-        }
-        break;
+void PluginProxy::registerAppEventHandler(const PluginProxy::EventHandlerType &type, PluginInterface* obj, Qz::ObjectName objectName)
+{
+    addRegistration(type, obj, objectName);
+}
 
-    case MouseReleaseHandler:
-        if (!m_mouseReleaseHandlers.contains(obj)) {
-            m_mouseReleaseHandlers.append(obj);
-        }
-        break;
+QHash<PluginInterface*, PluginProxy::HandlerStatistics> PluginProxy::handlerStatistics() const
+{
+    return m_handlerStatistics;
+}
 
-    case MouseMoveHandler:
-        if (!m_mouseMoveHandlers.contains(obj)) {
-            m_mouseMoveHandlers.append(obj);
+void PluginProxy::addRegistration(const PluginProxy::EventHandlerType &type, PluginInterface* obj, int objectName)
+{
+    if (type < 0 || type >= HandlerTypesCount) {
+        qWarning("PluginProxy::registerAppEventHandler registering unknown event handler type");
+        return;
+    }
+
+    foreach (const Registration &reg, m_registrations) {
+        if (reg.type == type && reg.plugin == obj && (reg.objectName == -1 || reg.objectName == objectName)) {
+            return;
         }
-        break;
+    }
+
+    Registration reg;
+    reg.type = type;
+    reg.plugin = obj;
+    reg.objectName = objectName;
+    m_registrations.append(reg);
+
+    rebuildDispatchTable();
+}
 
-    case KeyPressHandler:
-        if (!m_keyPressHandlers.contains(obj)) {
-            m_keyPressHandlers.append(obj);
+void PluginProxy::rebuildDispatchTable()
+{
+    for (int type = 0; type < HandlerTypesCount; ++type) {
+        for (int name = 0; name < ObjectNamesCount; ++name) {
+            QVector<PluginInterface*> &handlers = m_dispatchTable[type][name];
+            handlers.clear();
+
+            foreach (const Registration &reg, m_registrations) {
+                if (reg.type == type && (reg.objectName == -1 || reg.objectName == name) && !handlers.contains(reg.plugin)) {
+                    handlers.append(reg.plugin);
+                }
+            }
         }
-        break;
+    }
+}
+
+template <typename Event>
+bool PluginProxy::dispatchEvent(EventHandlerType type, const Qz::ObjectName &objectName, QObject* obj, Event* event,
+                                bool (PluginInterface::*handler)(const Qz::ObjectName &, QObject*, Event*))
+{
+    Q_ASSERT(objectName >= 0 && objectName < ObjectNamesCount);
+
+    // Copy, the table may be rebuilt when handler unloads plugin
+    const QVector<PluginInterface*> handlers = m_dispatchTable[type][objectName];
+    if (handlers.isEmpty()) {
+        return false;
+    }
 
-    case KeyReleaseHandler:
-        if (!m_keyReleaseHandlers.contains(obj)) {
-            m_keyReleaseHandlers.append(obj);
+    bool accepted = false;
+
+    if (!m_profileHandlers) {
+        for (int i = 0; i < handlers.size(); ++i) {
+            if ((handlers.at(i)->*handler)(objectName, obj, event)) {
+                accepted = true;
+            }
         }
-        break;
 
-    case WheelEventHandler:
-        if (!m_wheelEventHandlers.contains(obj)) {
-            m_wheelEventHandlers.append(obj);
+        return accepted;
+    }
+
+    QElapsedTimer timer;
+
+    for (int i = 0; i < handlers.size(); ++i) {
+        PluginInterface* iPlugin = handlers.at(i);
+
+        timer.start();
+        if ((iPlugin->*handler)(objectName, obj, event)) {
+            accepted = true;
         }
-        break;
+        const qint64 elapsed = timer.nsecsElapsed();
 
-    default:
-        qWarning("PluginProxy::registerAppEventHandler registering unknown event handler type");
-        break;
+        HandlerStatistics &stats = m_handlerStatistics[iPlugin];
+        ++stats.calls;
+        stats.totalTime += elapsed;
+        stats.maxTime = qMax(stats.maxTime, elapsed);
     }
+
+    return accepted;
+}
+
+int PluginProxy::startupRegistrationsCount()
+{
+    return Plugins::startupRegistrationsCount() +
+           receivers(SIGNAL(webPageCreated(WebPage*))) +
+           m_registrations.count();
 }
 
 void PluginProxy::pluginUnloaded(PluginInterface* plugin)
 {
-    m_mousePressHandlers.removeOne(plugin);
-    m_mouseReleaseHandlers.removeOne(plugin);
-    m_mouseMoveHandlers.removeOne(plugin);
+    QList<Registration>::iterator it = m_registrations.begin();
+    while (it != m_registrations.end()) {
+        if (it->plugin == plugin) {
+            it = m_registrations.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    m_handlerStatistics.remove(plugin);
 
-    m_keyPressHandlers.removeOne(plugin);
-    m_keyReleaseHandlers.removeOne(plugin);
+    rebuildDispatchTable();
 }
 
 void PluginProxy::populateWebViewMenu(QMenu* menu, WebView* view, const QWebHitTestResult &r)
@@ -102,93 +167,37 @@ void PluginProxy::populateWebViewMenu(QMenu* menu, WebView* view, const QWebHitT
 
 bool PluginProxy::processMouseDoubleClick(const Qz::ObjectName &type, QObject* obj, QMouseEvent* event)
 {
-    bool accepted = false;
-
-    foreach (PluginInterface* iPlugin, m_mouseDoubleClickHandlers) {
-        if (iPlugin->mouseDoubleClick(type, obj, event)) {
-            accepted = true;
-        }
-    }
-
-    return accepted;
+    return dispatchEvent(MouseDoubleClickHandler, type, obj, event, &PluginInterface::mouseDoubleClick);
 }
 
 bool PluginProxy::processMousePress(const Qz::ObjectName &type, QObject* obj, QMouseEvent* event)
 {
-    bool accepted = false;
-
-    foreach (PluginInterface* iPlugin, m_mousePressHandlers) {
-        if (iPlugin->mousePress(type, obj, event)) {
-            accepted = true;
-        }
-    }
-
-    return accepted;
+    return dispatchEvent(MousePressHandler, type, obj, event, &PluginInterface::mousePress);
 }
 
 bool PluginProxy::processMouseRelease(const Qz::ObjectName &type, QObject* obj, QMouseEvent* event)
 {
-    bool accepted = false;
-
-    foreach (PluginInterface* iPlugin, m_mouseReleaseHandlers) {
-        if (iPlugin->mouseRelease(type, obj, event)) {
-            accepted = true;
-        }
-    }
-
-    return accepted;
+    return dispatchEvent(MouseReleaseHandler, type, obj, event, &PluginInterface::mouseRelease);
 }
 
 bool PluginProxy::processMouseMove(const Qz::ObjectName &type, QObject* obj, QMouseEvent* event)
 {
-    bool accepted = false;
-
-    foreach (PluginInterface* iPlugin, m_mouseMoveHandlers) {
-        if (iPlugin->mouseMove(type, obj, event)) {
-            accepted = true;
-        }
-    }
-
-    return accepted;
+    return dispatchEvent(MouseMoveHandler, type, obj, event, &PluginInterface::mouseMove);
 }
 
 bool PluginProxy::processWheelEvent(const Qz::ObjectName &type, QObject* obj, QWheelEvent* event)
 {
-    bool accepted = false;
-
-    foreach (PluginInterface* iPlugin, m_wheelEventHandlers) {
-        if (iPlugin->wheelEvent(type, obj, event)) {
-            accepted = true;
-        }
-    }
-
-    return accepted;
+    return dispatchEvent(WheelEventHandler, type, obj, event, &PluginInterface::wheelEvent);
 }
 
 bool PluginProxy::processKeyPress(const Qz::ObjectName &type, QObject* obj, QKeyEvent* event)
 {
-    bool accepted = false;
-
-    foreach (PluginInterface* iPlugin, m_keyPressHandlers) {
-        if (iPlugin->keyPress(type, obj, event)) {
-            accepted = true;
-        }
-    }
-
-    return accepted;
+    return dispatchEvent(KeyPressHandler, type, obj, event, &PluginInterface::keyPress);
 }
 
 bool PluginProxy::processKeyRelease(const Qz::ObjectName &type, QObject* obj, QKeyEvent* event)
 {
-    bool accepted = false;
-
-    foreach (PluginInterface* iPlugin, m_keyReleaseHandlers) {
-        if (iPlugin->keyRelease(type, obj, event)) {
-            accepted = true;
-        }
-    }
-
-    return accepted;
+    return dispatchEvent(KeyReleaseHandler, type, obj, event, &PluginInterface::keyRelease);
 }
 
 QNetworkReply* PluginProxy::createRequest(QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice* outgoingData)
@@ -196,6 +205,7 @@ QNetworkReply* PluginProxy::createRequest(QNetworkAccessManager::Operation op, c
     foreach (PluginInterface* iPlugin, m_loadedPlugins) {
         QNetworkReply* reply = iPlugin->createRequest(op, request, outgoingData);
         if (reply) {
+            setCreatesRequests(iPlugin);
             return reply;
         }
     }
@@ -18,6 +18,9 @@
 #ifndef PLUGINPROXY_H
 #define PLUGINPROXY_H
 
+#include <QVector>
+#include <QHash>
+
 #include "plugins.h"
 #include "qzcommon.h"
 
@@ -33,9 +36,29 @@ public:
                             WheelEventHandler
                           };
 
+    // Time spent in event handlers of one plugin, recorded only
+    // with ProfileEventHandlers option in Plugin-Settings
+    struct HandlerStatistics {
+        int calls;
+        // Nanoseconds
+        qint64 totalTime;
+        qint64 maxTime;
+
+        HandlerStatistics() {
+            calls = 0;
+            totalTime = 0;
+            maxTime = 0;
+        }
+    };
+
     explicit PluginProxy();
 
+    // Handler is called for events of all object types
     void registerAppEventHandler(const EventHandlerType &type, PluginInterface* obj);
+    // Handler is called only for events of objectName type
+    void registerAppEventHandler(const EventHandlerType &type, PluginInterface* obj, Qz::ObjectName objectName);
+
+    QHash<PluginInterface*, HandlerStatistics> handlerStatistics() const;
 
     void populateWebViewMenu(QMenu* menu, WebView* view, const QWebHitTestResult &r);
 
@@ -64,19 +87,34 @@ signals:
     void mainWindowCreated(BrowserWindow* window);
     void mainWindowDeleted(BrowserWindow* window);
 
+protected:
+    int startupRegistrationsCount();
+
 private slots:
     void pluginUnloaded(PluginInterface* plugin);
 
 private:
-    QList<PluginInterface*> m_mouseDoubleClickHandlers;
-    QList<PluginInterface*> m_mousePressHandlers;
-    QList<PluginInterface*> m_mouseReleaseHandlers;
-    QList<PluginInterface*> m_mouseMoveHandlers;
-
-    QList<PluginInterface*> m_wheelEventHandlers;
-
-    QList<PluginInterface*> m_keyPressHandlers;
-    QList<PluginInterface*> m_keyReleaseHandlers;
+    struct Registration {
+        EventHandlerType type;
+        PluginInterface* plugin;
+        // -1 for all object types
+        int objectName;
+    };
+
+    enum { HandlerTypesCount = WheelEventHandler + 1, ObjectNamesCount = Qz::ON_BrowserWindow + 1 };
+
+    void addRegistration(const EventHandlerType &type, PluginInterface* obj, int objectName);
+    void rebuildDispatchTable();
+
+    template <typename Event>
+    bool dispatchEvent(EventHandlerType type, const Qz::ObjectName &objectName, QObject* obj, Event* event,
+                       bool (PluginInterface::*handler)(const Qz::ObjectName &, QObject*, Event*));
+
+    QList<Registration> m_registrations;
+    // Handlers for each event type and object type, rebuilt on every registration change
+    QVector<PluginInterface*> m_dispatchTable[HandlerTypesCount][ObjectNamesCount];
+    QHash<PluginInterface*, HandlerStatistics> m_handlerStatistics;
+    bool m_profileHandlers;
 };
 
 #include "mainapplication.h"
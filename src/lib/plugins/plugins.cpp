@@ -21,13 +21,28 @@
 #include "speeddial.h"
 #include "settings.h"
 #include "datapaths.h"
+#include "autofill.h"
+#include "passwordmanager.h"
+#include "networkmanager.h"
+#include "startuptimeline.h"
 
 #include <iostream>
 #include <QPluginLoader>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QTimer>
 #include <QDir>
 
+// Increase when format of plugins cache changes
+static const int s_cacheVersion = 2;
+
+// Same serialization format with Qt 4 and Qt 5 builds
+static const QDataStream::Version s_streamVersion = QDataStream::Qt_4_8;
+
 Plugins::Plugins(QObject* parent)
     : QObject(parent)
+    , m_cacheLoaded(false)
+    , m_cacheChanged(false)
     , m_pluginsLoaded(false)
     , m_speedDial(new SpeedDial(this))
 {
@@ -36,6 +51,7 @@ Plugins::Plugins(QObject* parent)
 
 QList<Plugins::Plugin> Plugins::getAvailablePlugins()
 {
+    loadDeferredPlugins();
     loadAvailablePlugins();
 
     return m_availablePlugins;
@@ -53,10 +69,17 @@ bool Plugins::loadPlugin(Plugins::Plugin* plugin)
         return false;
     }
 
+    const int registrations = startupRegistrationsCount();
+
     m_availablePlugins.removeOne(*plugin);
     plugin->instance = initPlugin(PluginInterface::LateInitState, iPlugin, plugin->pluginLoader);
     m_availablePlugins.prepend(*plugin);
 
+    if (plugin->isLoaded()) {
+        cacheInitializedPlugin(*plugin, startupRegistrationsCount() != registrations);
+        saveCache();
+    }
+
     refreshLoadedPlugins();
 
     return plugin->isLoaded();
@@ -68,6 +91,9 @@ void Plugins::unloadPlugin(Plugins::Plugin* plugin)
         return;
     }
 
+    cacheRequestCreator(plugin->instance);
+    saveCache();
+
     plugin->instance->unload();
     plugin->pluginLoader->unload();
     emit pluginUnloaded(plugin->instance);
@@ -96,8 +122,11 @@ void Plugins::shutdown()
     m_speedDial->saveSettings();
 
     foreach (PluginInterface* iPlugin, m_loadedPlugins) {
+        cacheRequestCreator(iPlugin);
         iPlugin->unload();
     }
+
+    saveCache();
 }
 
 void Plugins::c2f_loadSettings()
@@ -130,30 +159,76 @@ void Plugins::loadPlugins()
     }
 
     foreach (const QString &fullPath, m_allowedPlugins) {
-        QPluginLoader* loader = new QPluginLoader(fullPath);
-        PluginInterface* iPlugin = qobject_cast<PluginInterface*>(loader->instance());
+        CacheEntry entry;
 
-        if (!iPlugin) {
-            qWarning() << "Plugins::loadPlugins Loading" << fullPath << "failed:" << loader->errorString();
+        // Plugins that don't need to be ready for first page load are initialized later
+        if (cachedEntry(fullPath, &entry) && entry.initialized && !entry.startupCritical) {
+            m_deferredPlugins.append(fullPath);
             continue;
         }
 
-        Plugin plugin;
-        plugin.fullPath = fullPath;
-        plugin.pluginLoader = loader;
-        plugin.instance = initPlugin(PluginInterface::StartupInitState, iPlugin, loader);
+        loadAllowedPlugin(fullPath, PluginInterface::StartupInitState);
+    }
 
-        if (plugin.isLoaded()) {
-            plugin.pluginSpec = iPlugin->pluginSpec();
+    refreshLoadedPlugins();
+    saveCache();
 
-            m_loadedPlugins.append(plugin.instance);
-            m_availablePlugins.append(plugin);
-        }
+    if (!m_deferredPlugins.isEmpty()) {
+        QTimer::singleShot(0, this, SLOT(loadDeferredPlugins()));
+    }
+
+    std::cout << "QupZilla: " << m_loadedPlugins.count() << " extensions loaded"  << std::endl;
+}
+
+void Plugins::loadDeferredPlugins()
+{
+    if (m_deferredPlugins.isEmpty()) {
+        return;
+    }
+
+    StartupTimeline::Scope scope(QSL("deferred plugins"));
+
+    const QStringList deferredPlugins = m_deferredPlugins;
+    m_deferredPlugins.clear();
+
+    // Deferred plugins are initialized in LateInitState, exactly as if they were
+    // enabled in Preferences, because windows and pages already exist
+    foreach (const QString &fullPath, deferredPlugins) {
+        loadAllowedPlugin(fullPath, PluginInterface::LateInitState);
     }
 
     refreshLoadedPlugins();
+    saveCache();
 
-    std::cout << "QupZilla: " << m_loadedPlugins.count() << " extensions loaded"  << std::endl;
+    std::cout << "QupZilla: " << deferredPlugins.count() << " deferred extensions loaded"  << std::endl;
+}
+
+void Plugins::loadAllowedPlugin(const QString &fullPath, PluginInterface::InitState state)
+{
+    QPluginLoader* loader = new QPluginLoader(fullPath);
+    PluginInterface* iPlugin = qobject_cast<PluginInterface*>(loader->instance());
+
+    if (!iPlugin) {
+        qWarning() << "Plugins::loadPlugins Loading" << fullPath << "failed:" << loader->errorString();
+        delete loader;
+        return;
+    }
+
+    const int registrations = startupRegistrationsCount();
+
+    Plugin plugin;
+    plugin.fullPath = fullPath;
+    plugin.pluginLoader = loader;
+    plugin.instance = initPlugin(state, iPlugin, loader);
+
+    if (plugin.isLoaded()) {
+        plugin.pluginSpec = iPlugin->pluginSpec();
+
+        m_loadedPlugins.append(plugin.instance);
+        m_availablePlugins.append(plugin);
+
+        cacheInitializedPlugin(plugin, startupRegistrationsCount() != registrations);
+    }
 }
 
 void Plugins::loadAvailablePlugins()
@@ -182,28 +257,50 @@ void Plugins::loadAvailablePlugins()
                 continue;
             }
 
-            QPluginLoader* loader = new QPluginLoader(absolutePath);
-            PluginInterface* iPlugin = qobject_cast<PluginInterface*>(loader->instance());
+            CacheEntry entry;
 
-            if (!iPlugin) {
-                qWarning() << "Plugins::loadAvailablePlugins" << loader->errorString();
+            // Only new or changed plugins needs to be loaded to get their spec
+            if (!cachedEntry(absolutePath, &entry)) {
+                QPluginLoader loader(absolutePath);
+                PluginInterface* iPlugin = qobject_cast<PluginInterface*>(loader.instance());
+
+                const QFileInfo info(absolutePath);
+                entry.lastModified = info.lastModified();
+                entry.size = info.size();
+                entry.valid = iPlugin;
+
+                if (iPlugin) {
+                    entry.pluginSpec = iPlugin->pluginSpec();
+                    loader.unload();
+                }
+                else {
+                    qWarning() << "Plugins::loadAvailablePlugins" << loader.errorString();
+                }
+
+                setCachedEntry(absolutePath, entry);
+            }
+
+            if (!entry.valid) {
                 continue;
             }
 
             Plugin plugin;
             plugin.fileName = fileName;
             plugin.fullPath = absolutePath;
-            plugin.pluginSpec = iPlugin->pluginSpec();
-            plugin.pluginLoader = loader;
+            plugin.pluginSpec = entry.pluginSpec;
+            plugin.pluginLoader = new QPluginLoader(absolutePath);
             plugin.instance = 0;
 
-            loader->unload();
-
             if (!alreadySpecInAvailable(plugin.pluginSpec)) {
                 m_availablePlugins.append(plugin);
             }
+            else {
+                delete plugin.pluginLoader;
+            }
         }
     }
+
+    saveCache();
 }
 
 PluginInterface* Plugins::initPlugin(PluginInterface::InitState state, PluginInterface* pluginInterface, QPluginLoader* loader)
@@ -249,3 +346,155 @@ bool Plugins::alreadySpecInAvailable(const PluginSpec &spec)
 
     return false;
 }
+
+void Plugins::cacheRequestCreator(PluginInterface* plugin)
+{
+    if (!m_requestCreators.remove(plugin)) {
+        return;
+    }
+
+    foreach (const Plugin &p, m_availablePlugins) {
+        if (p.instance != plugin) {
+            continue;
+        }
+
+        CacheEntry entry;
+        if (cachedEntry(p.fullPath, &entry) && !entry.createsRequests) {
+            entry.createsRequests = true;
+            entry.startupCritical = true;
+            setCachedEntry(p.fullPath, entry);
+        }
+        break;
+    }
+}
+
+int Plugins::startupRegistrationsCount()
+{
+    return mApp->networkManager()->registeredSchemes().count() +
+           mApp->autoFill()->passwordManager()->availableBackends().count();
+}
+
+void Plugins::cacheInitializedPlugin(const Plugin &plugin, bool startupCritical)
+{
+    const QFileInfo info(plugin.fullPath);
+
+    // Plugins loaded with relative path (portable build) are not cached
+    if (!info.exists()) {
+        return;
+    }
+
+    CacheEntry entry;
+    cachedEntry(plugin.fullPath, &entry);
+
+    entry.lastModified = info.lastModified();
+    entry.size = info.size();
+    entry.valid = true;
+    entry.initialized = true;
+    entry.startupCritical = startupCritical || entry.createsRequests || m_requestCreators.contains(plugin.instance);
+    entry.pluginSpec = plugin.pluginSpec;
+
+    setCachedEntry(plugin.fullPath, entry);
+}
+
+bool Plugins::cachedEntry(const QString &fullPath, CacheEntry* entry)
+{
+    loadCache();
+
+    QHash<QString, CacheEntry>::const_iterator it = m_cache.constFind(fullPath);
+    if (it == m_cache.constEnd()) {
+        return false;
+    }
+
+    const QFileInfo info(fullPath);
+    if (!info.exists() || info.size() != it.value().size || info.lastModified() != it.value().lastModified) {
+        return false;
+    }
+
+    *entry = it.value();
+    return true;
+}
+
+void Plugins::setCachedEntry(const QString &fullPath, const CacheEntry &entry)
+{
+    loadCache();
+
+    m_cache[fullPath] = entry;
+    m_cacheChanged = true;
+}
+
+void Plugins::loadCache()
+{
+    if (m_cacheLoaded) {
+        return;
+    }
+
+    m_cacheLoaded = true;
+
+    QFile file(DataPaths::currentProfilePath() + QLatin1String("/plugins.cache"));
+    if (!file.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(s_streamVersion);
+
+    int version;
+    QString appVersion;
+    QString languageFile;
+    int count;
+
+    stream >> version >> appVersion >> languageFile >> count;
+
+    // Plugin specs are translated, so the cache is valid only for one language
+    if (stream.status() != QDataStream::Ok || version != s_cacheVersion ||
+        appVersion != Qz::VERSION || languageFile != mApp->currentLanguageFile()) {
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        QString fullPath;
+        CacheEntry entry;
+
+        stream >> fullPath >> entry.lastModified >> entry.size >> entry.valid >> entry.initialized
+               >> entry.startupCritical >> entry.createsRequests >> entry.pluginSpec.name
+               >> entry.pluginSpec.info >> entry.pluginSpec.description >> entry.pluginSpec.author
+               >> entry.pluginSpec.version >> entry.pluginSpec.icon >> entry.pluginSpec.hasSettings;
+
+        if (stream.status() != QDataStream::Ok) {
+            m_cache.clear();
+            return;
+        }
+
+        m_cache[fullPath] = entry;
+    }
+}
+
+void Plugins::saveCache()
+{
+    if (!m_cacheChanged) {
+        return;
+    }
+
+    m_cacheChanged = false;
+
+    QFile file(DataPaths::currentProfilePath() + QLatin1String("/plugins.cache"));
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "Plugins::saveCache Cannot open" << file.fileName();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(s_streamVersion);
+    stream << s_cacheVersion << Qz::VERSION << mApp->currentLanguageFile() << m_cache.count();
+
+    QHash<QString, CacheEntry>::const_iterator it = m_cache.constBegin();
+    while (it != m_cache.constEnd()) {
+        const CacheEntry &entry = it.value();
+
+        stream << it.key() << entry.lastModified << entry.size << entry.valid << entry.initialized
+               << entry.startupCritical << entry.createsRequests << entry.pluginSpec.name
+               << entry.pluginSpec.info << entry.pluginSpec.description << entry.pluginSpec.author
+               << entry.pluginSpec.version << entry.pluginSpec.icon << entry.pluginSpec.hasSettings;
+        ++it;
+    }
+}
@@ -21,6 +21,9 @@
 #include <QObject>
 #include <QVariant>
 #include <QPointer>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
 
 #include "qzcommon.h"
 #include "plugininterface.h"
@@ -57,6 +60,30 @@ public:
         }
     };
 
+    // Information about plugin file saved in plugins cache,
+    // so that unchanged plugins don't need to be loaded to get their spec
+    struct CacheEntry {
+        QDateTime lastModified;
+        qint64 size;
+        // File is valid QupZilla plugin
+        bool valid;
+        // Plugin was initialized at least once, so startupCritical is known
+        bool initialized;
+        // Plugin needs to be initialized before first page load
+        bool startupCritical;
+        // Plugin is creating network replies
+        bool createsRequests;
+        PluginSpec pluginSpec;
+
+        CacheEntry() {
+            size = -1;
+            valid = false;
+            initialized = false;
+            startupCritical = true;
+            createsRequests = false;
+        }
+    };
+
     explicit Plugins(QObject* parent = 0);
 
     QList<Plugin> getAvailablePlugins();
@@ -82,8 +109,16 @@ public slots:
     void loadSettings();
 
     void loadPlugins();
+    void loadDeferredPlugins();
 
 protected:
+    // Called for every created reply, cache is updated at unload or shutdown
+    void setCreatesRequests(PluginInterface* plugin) { m_requestCreators.insert(plugin); }
+
+    // Plugins handling created pages, schemes, passwords or events must be
+    // initialized before first page is loaded
+    virtual int startupRegistrationsCount();
+
     QList<PluginInterface*> m_loadedPlugins;
 
 signals:
@@ -95,9 +130,24 @@ private:
 
     void refreshLoadedPlugins();
     void loadAvailablePlugins();
+    void loadAllowedPlugin(const QString &fullPath, PluginInterface::InitState state);
+
+    void cacheRequestCreator(PluginInterface* plugin);
+    void cacheInitializedPlugin(const Plugin &plugin, bool startupCritical);
+
+    bool cachedEntry(const QString &fullPath, CacheEntry* entry);
+    void setCachedEntry(const QString &fullPath, const CacheEntry &entry);
+    void loadCache();
+    void saveCache();
 
     QList<Plugin> m_availablePlugins;
     QStringList m_allowedPlugins;
+    QStringList m_deferredPlugins;
+
+    QHash<QString, CacheEntry> m_cache;
+    QSet<PluginInterface*> m_requestCreators;
+    bool m_cacheLoaded;
+    bool m_cacheChanged;
 
     bool m_pluginsEnabled;
     bool m_pluginsLoaded;
@@ -33,6 +33,12 @@
 #include <QTextStream>
 #include <QMenu>
 
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrentRun>
+#else
+#include <QtConcurrentRun>
+#endif
+
 #include <hunspell/hunspell.hxx>
 
 Q_GLOBAL_STATIC(Speller, qz_speller)
@@ -41,10 +47,16 @@ Speller::Speller()
     : QObject()
     , m_textCodec(0)
     , m_hunspell(0)
+    , m_wordCache(5000)
+    , m_suggestionsCache(100)
+    , m_suggestStale(false)
     , m_enabled(false)
     , m_startPos(0)
     , m_endPos(0)
 {
+    m_suggestWatcher = new QFutureWatcher<QStringList>(this);
+    connect(m_suggestWatcher, SIGNAL(finished()), this, SLOT(suggestionsFinished()));
+
     loadSettings();
 }
 
@@ -73,8 +85,11 @@ void Speller::loadSettings()
 
 void Speller::initialize()
 {
+    QMutexLocker locker(&m_hunspellMutex);
+
     delete m_hunspell;
     m_hunspell = 0;
+    clearCache();
 
     if (m_dictionaryPath.isEmpty()) {
         qWarning() << "SpellCheck: Cannot locate dictionary path!";
@@ -96,6 +111,8 @@ void Speller::initialize()
 
     m_textCodec = QTextCodec::codecForName(m_hunspell->get_dic_encoding());
 
+    locker.unlock();
+
     if (m_userDictionary.exists()) {
         if (!m_userDictionary.open(QFile::ReadOnly)) {
             qWarning() << "SpellCheck: Cannot open" << m_userDictionary.fileName() << "for reading!";
@@ -192,21 +209,18 @@ void Speller::populateContextMenu(QMenu* menu, const QWebHitTestResult &hitTest)
         return;
     }
 
-    const int limit = 6;
-    QStringList suggests = suggest(word);
-    int count = suggests.count() > limit ? limit : suggests.count();
-
-    QFont boldFont = menu->font();
-    boldFont.setBold(true);
-
-    for (int i = 0; i < count; ++i) {
-        QAction* act = menu->addAction(suggests.at(i), this, SLOT(replaceWord()));
-        act->setData(suggests.at(i));
-        act->setFont(boldFont);
+    // Suggestions are slow to compute, so they are added to menu once they are ready
+    if (QStringList* suggests = m_suggestionsCache.object(word)) {
+        addSuggestionsToMenu(menu, 0, *suggests);
     }
+    else {
+        m_suggestMenu = menu;
+        m_suggestAction = menu->addAction(tr("Loading suggestions..."));
+        m_suggestAction->setEnabled(false);
 
-    if (count == 0) {
-        menu->addAction(tr("No suggestions"))->setEnabled(false);
+        if (m_suggestWord != word || !m_suggestWatcher->isRunning()) {
+            startSuggestions(word);
+        }
     }
 
     menu->addAction(tr("Add to dictionary"), this, SLOT(addToDictionary()))->setData(word);
@@ -279,8 +293,47 @@ void Speller::changeLanguage()
     loadSettings();
 }
 
+void Speller::startSuggestions(const QString &word)
+{
+    m_suggestWord = word;
+    m_suggestStale = false;
+    m_suggestWatcher->setFuture(QtConcurrent::run(this, &Speller::suggestWord, word));
+}
+
+void Speller::suggestionsFinished()
+{
+    const QString word = m_suggestWord;
+    const bool menuVisible = m_suggestMenu && m_suggestAction;
+
+    // Dictionary was changed while computing suggestions, compute them again
+    if (m_suggestStale && menuVisible) {
+        startSuggestions(word);
+        return;
+    }
+
+    const QStringList suggests = m_suggestWatcher->result();
+
+    if (!m_suggestStale) {
+        m_suggestionsCache.insert(word, new QStringList(suggests));
+    }
+
+    m_suggestWord.clear();
+    m_suggestStale = false;
+
+    if (!menuVisible) {
+        return;
+    }
+
+    addSuggestionsToMenu(m_suggestMenu, m_suggestAction, suggests);
+
+    m_suggestMenu->removeAction(m_suggestAction);
+    delete m_suggestAction;
+}
+
 void Speller::putWord(const QString &word)
 {
+    QMutexLocker locker(&m_hunspellMutex);
+
     if (!m_hunspell || !m_textCodec || word.isEmpty()) {
         return;
     }
@@ -290,6 +343,44 @@ void Speller::putWord(const QString &word)
     if (m_hunspell->add(data.constData()) != 0) {
         qWarning() << "SpellCheck: Error while adding" << word << "word!";
     }
+
+    locker.unlock();
+
+    clearCache();
+}
+
+void Speller::clearCache()
+{
+    m_wordCache.clear();
+    m_suggestionsCache.clear();
+
+    // Running job computes suggestions with previous dictionary
+    if (m_suggestWatcher->isRunning()) {
+        m_suggestStale = true;
+    }
+}
+
+void Speller::addSuggestionsToMenu(QMenu* menu, QAction* before, const QStringList &suggests)
+{
+    const int limit = 6;
+    int count = suggests.count() > limit ? limit : suggests.count();
+
+    QFont boldFont = menu->font();
+    boldFont.setBold(true);
+
+    for (int i = 0; i < count; ++i) {
+        QAction* act = new QAction(suggests.at(i), menu);
+        act->setData(suggests.at(i));
+        act->setFont(boldFont);
+        connect(act, SIGNAL(triggered()), this, SLOT(replaceWord()));
+        menu->insertAction(before, act);
+    }
+
+    if (count == 0) {
+        QAction* act = new QAction(tr("No suggestions"), menu);
+        act->setEnabled(false);
+        menu->insertAction(before, act);
+    }
 }
 
 bool Speller::isMisspelled(const QString &string)
@@ -298,13 +389,42 @@ bool Speller::isMisspelled(const QString &string)
         return false;
     }
 
+    if (bool* misspelled = m_wordCache.object(string)) {
+        return *misspelled;
+    }
+
+    // Suggestions are being computed, word is checked again with next repaint
+    if (!m_hunspellMutex.tryLock()) {
+        return false;
+    }
+
     const QByteArray data = m_textCodec->fromUnicode(string);
+    const bool misspelled = m_hunspell->spell(data.constData()) == 0;
+
+    m_hunspellMutex.unlock();
+
+    m_wordCache.insert(string, new bool(misspelled));
 
-    return m_hunspell->spell(data.constData()) == 0;
+    return misspelled;
 }
 
 QStringList Speller::suggest(const QString &word)
 {
+    if (QStringList* suggests = m_suggestionsCache.object(word)) {
+        return *suggests;
+    }
+
+    if (m_suggestWord != word || !m_suggestWatcher->isRunning()) {
+        startSuggestions(word);
+    }
+
+    return QStringList();
+}
+
+QStringList Speller::suggestWord(const QString &word)
+{
+    QMutexLocker locker(&m_hunspellMutex);
+
     if (!m_hunspell || !m_textCodec) {
         return QStringList();
     }
@@ -417,5 +537,7 @@ QString Speller::nameForLanguage(const QString &code) const
 
 Speller::~Speller()
 {
+    m_suggestWatcher->waitForFinished();
+
     delete m_hunspell;
 }
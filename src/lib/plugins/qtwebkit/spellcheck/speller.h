@@ -20,7 +20,11 @@
 
 #include <QWebElement>
 #include <QStringList>
+#include <QFutureWatcher>
+#include <QPointer>
 #include <QVector>
+#include <QCache>
+#include <QMutex>
 #include <QFile>
 
 #include "qzcommon.h"
@@ -29,6 +33,7 @@ class QTextCodec;
 class Hunspell;
 
 class QMenu;
+class QAction;
 class QWebHitTestResult;
 
 class QUPZILLA_EXPORT Speller : public QObject
@@ -63,6 +68,9 @@ public:
     void populateContextMenu(QMenu* menu, const QWebHitTestResult &hitTest);
 
     bool isMisspelled(const QString &string);
+
+    // Returns cached suggestions, otherwise starts computing them
+    // in background and returns empty list
     QStringList suggest(const QString &word);
 
     static bool isValidWord(const QString &str);
@@ -79,9 +87,17 @@ private slots:
     void showSettings();
     void changeLanguage();
 
+    void suggestionsFinished();
+
 private:
     void initialize();
     void putWord(const QString &word);
+    void clearCache();
+    void startSuggestions(const QString &word);
+
+    // Thread-safe, may be called from worker thread
+    QStringList suggestWord(const QString &word);
+    void addSuggestionsToMenu(QMenu* menu, QAction* before, const QStringList &suggests);
 
     bool dictionaryExists(const QString &path) const;
     QString getDictionaryPath() const;
@@ -91,6 +107,20 @@ private:
     QTextCodec* m_textCodec;
     Hunspell* m_hunspell;
 
+    // Locked while computing suggestions, spell checking is skipped instead of waiting
+    QMutex m_hunspellMutex;
+
+    // word -> is misspelled / suggestions, invalidated with dictionary changes
+    QCache<QString, bool> m_wordCache;
+    QCache<QString, QStringList> m_suggestionsCache;
+
+    // Suggestions computed in background for context menu
+    QFutureWatcher<QStringList>* m_suggestWatcher;
+    QPointer<QMenu> m_suggestMenu;
+    QPointer<QAction> m_suggestAction;
+    QString m_suggestWord;
+    bool m_suggestStale;
+
     QFile m_userDictionary;
     Language m_language;
     QVector<Language> m_availableLanguages;
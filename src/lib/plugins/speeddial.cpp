@@ -27,22 +27,39 @@
 #include <QWebFrame>
 #include <QWebPage>
 #include <QImage>
+#include <QBuffer>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QTimer>
 
 #define ENSURE_LOADED if (!m_loaded) loadSettings();
 
+// Increase when format of thumbnails index changes
+static const int thumbnailsIndexVersion = 1;
+
 SpeedDial::SpeedDial(QObject* parent)
     : QObject(parent)
     , m_maxPagesInRow(4)
     , m_sizeOfSpeedDials(231)
     , m_sdcentered(false)
+    , m_idleTimer(new QTimer(this))
+    , m_maxThumbnailers(2)
+    , m_thumbnailTimeout(30)
+    , m_thumbnailMaxAge(14)
     , m_loaded(false)
     , m_regenerateScript(true)
+    , m_revision(0)
 {
+    // Idle pages are kept for a while in case more thumbnails are requested
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(60 * 1000);
+    connect(m_idleTimer, SIGNAL(timeout()), this, SLOT(clearIdleThumbnailers()));
 }
 
 void SpeedDial::loadSettings()
 {
     m_loaded = true;
+    ++m_revision;
 
     Settings settings;
     settings.beginGroup("SpeedDial");
@@ -52,6 +69,9 @@ void SpeedDial::loadSettings()
     m_maxPagesInRow = settings.value("pagesrow", 4).toInt();
     m_sizeOfSpeedDials = settings.value("sdsize", 231).toInt();
     m_sdcentered = settings.value("sdcenter", 0).toInt();
+    m_maxThumbnailers = qMax(1, settings.value("thumbnailsConcurrency", 2).toInt());
+    m_thumbnailTimeout = settings.value("thumbnailsTimeout", 30).toInt();
+    m_thumbnailMaxAge = settings.value("thumbnailsMaxAge", 14).toInt();
     settings.endGroup();
 
     if (allPages.isEmpty()) {
@@ -68,6 +88,8 @@ void SpeedDial::loadSettings()
     if (!QDir(m_thumbnailsDir).exists()) {
         QDir(DataPaths::currentProfilePath()).mkdir("thumbnails");
     }
+
+    loadThumbnailsIndex();
 }
 
 void SpeedDial::saveSettings()
@@ -136,6 +158,7 @@ void SpeedDial::addPage(const QUrl &url, const QString &title)
 
     m_webPages.append(page);
     m_regenerateScript = true;
+    ++m_revision;
 
     foreach (QWebFrame* frame, cleanFrames()) {
         frame->page()->triggerAction(QWebPage::Reload);
@@ -155,6 +178,7 @@ void SpeedDial::removePage(const Page &page)
     removeImageForUrl(page.url);
     m_webPages.removeAll(page);
     m_regenerateScript = true;
+    ++m_revision;
 
     foreach (QWebFrame* frame, cleanFrames()) {
         frame->page()->triggerAction(QWebPage::Reload);
@@ -198,6 +222,11 @@ QString SpeedDial::backgroundImageSize()
     return m_backgroundImageSize;
 }
 
+int SpeedDial::revision() const
+{
+    return m_revision;
+}
+
 QString SpeedDial::initialScript()
 {
     ENSURE_LOADED;
@@ -210,9 +239,9 @@ QString SpeedDial::initialScript()
     m_initialScript.clear();
 
     foreach (const Page &page, m_webPages) {
-        QString imgSource = m_thumbnailsDir + QCryptographicHash::hash(page.url.toUtf8(), QCryptographicHash::Md4).toHex() + ".png";
+        QString imgSource = thumbnailFile(page.url);
 
-        if (!QFile(imgSource).exists()) {
+        if (imgSource.isEmpty()) {
             imgSource = "qrc:html/loading.gif";
 
             if (page.url.isEmpty()) {
@@ -221,6 +250,11 @@ QString SpeedDial::initialScript()
         }
         else {
             imgSource = QUrl::fromLocalFile(imgSource).toString();
+
+            // Outdated thumbnail is shown until new one is created
+            if (isThumbnailStale(page.url)) {
+                loadThumbnail(page.url);
+            }
         }
 
         m_initialScript.append(QString("addBox('%1', '%2', '%3');\n").arg(page.url, page.title, imgSource));
@@ -256,30 +290,51 @@ void SpeedDial::changed(const QString &allPages)
     }
 
     m_regenerateScript = true;
+    ++m_revision;
     emit pagesChanged();
 }
 
 void SpeedDial::loadThumbnail(const QString &url, bool loadTitle)
 {
+    ENSURE_LOADED;
+
     if (url.isEmpty()) {
         return;
     }
 
-    PageThumbnailer* thumbnailer = new PageThumbnailer(this);
-    thumbnailer->setUrl(QUrl::fromEncoded(url.toUtf8()));
-    thumbnailer->setLoadTitle(loadTitle);
-    connect(thumbnailer, SIGNAL(thumbnailCreated(QPixmap)), this, SLOT(thumbnailCreated(QPixmap)));
+    // Url is already being loaded
+    QHash<PageThumbnailer*, QString>::const_iterator it = m_runningThumbnailers.constBegin();
+    while (it != m_runningThumbnailers.constEnd()) {
+        if (it.value() == url) {
+            if (loadTitle) {
+                it.key()->setLoadTitle(true);
+            }
+            return;
+        }
+        ++it;
+    }
+
+    for (int i = 0; i < m_thumbnailRequests.count(); ++i) {
+        ThumbnailRequest &request = m_thumbnailRequests[i];
+        if (request.url == url) {
+            request.loadTitle = request.loadTitle || loadTitle;
+            return;
+        }
+    }
 
-    thumbnailer->start();
+    ThumbnailRequest request;
+    request.url = url;
+    request.loadTitle = loadTitle;
+    m_thumbnailRequests.append(request);
+
+    startThumbnailers();
 }
 
 void SpeedDial::removeImageForUrl(const QString &url)
 {
-    QString fileName = m_thumbnailsDir + QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Md4).toHex() + ".png";
+    ENSURE_LOADED;
 
-    if (QFile(fileName).exists()) {
-        QFile(fileName).remove();
-    }
+    removeThumbnail(url);
 }
 
 QString SpeedDial::getOpenFileName()
@@ -302,39 +357,46 @@ QString SpeedDial::urlFromUserInput(const QString &url)
 void SpeedDial::setBackgroundImage(const QString &image)
 {
     m_backgroundImage = image;
+    ++m_revision;
 }
 
 void SpeedDial::setBackgroundImageSize(const QString &size)
 {
     m_backgroundImageSize = size;
+    ++m_revision;
 }
 
 void SpeedDial::setPagesInRow(int count)
 {
     m_maxPagesInRow = count;
+    ++m_revision;
 }
 
 void SpeedDial::setSdSize(int count)
 {
     m_sizeOfSpeedDials = count;
+    ++m_revision;
 }
 
 void SpeedDial::setSdCentered(int cntr)
 {
     m_sdcentered = cntr;
+    ++m_revision;
 }
 
 void SpeedDial::thumbnailCreated(const QPixmap &pixmap)
 {
     PageThumbnailer* thumbnailer = qobject_cast<PageThumbnailer*>(sender());
-    if (!thumbnailer) {
+
+    // Ignore late signals of thumbnailers that are already idle
+    if (!thumbnailer || !m_runningThumbnailers.contains(thumbnailer)) {
         return;
     }
 
     bool loadTitle = thumbnailer->loadTitle();
     QString title = thumbnailer->title();
-    QString url = thumbnailer->url().toString();
-    QString fileName = m_thumbnailsDir + QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Md4).toHex() + ".png";
+    const QString url = m_runningThumbnailers.take(thumbnailer);
+    QString fileName;
 
     if (pixmap.isNull()) {
         fileName = "qrc:/html/broken-page.png";
@@ -342,14 +404,11 @@ void SpeedDial::thumbnailCreated(const QPixmap &pixmap)
         loadTitle = true;
     }
     else {
-        if (!pixmap.save(fileName, "PNG")) {
-            qWarning() << "SpeedDial::thumbnailCreated Cannot save thumbnail to " << fileName;
-        }
-
-        fileName = QUrl::fromLocalFile(fileName).toString();
+        fileName = QUrl::fromLocalFile(saveThumbnail(url, pixmap)).toString();
     }
 
     m_regenerateScript = true;
+    ++m_revision;
 
     cleanFrames();
     foreach (QWebFrame* frame, cleanFrames()) {
@@ -359,7 +418,192 @@ void SpeedDial::thumbnailCreated(const QPixmap &pixmap)
         }
     }
 
-    thumbnailer->deleteLater();
+    m_idleThumbnailers.append(thumbnailer);
+
+    startThumbnailers();
+}
+
+void SpeedDial::clearIdleThumbnailers()
+{
+    qDeleteAll(m_idleThumbnailers);
+    m_idleThumbnailers.clear();
+}
+
+void SpeedDial::startThumbnailers()
+{
+    while (!m_thumbnailRequests.isEmpty() && m_runningThumbnailers.count() < m_maxThumbnailers) {
+        const ThumbnailRequest request = m_thumbnailRequests.takeFirst();
+        const QUrl url = QUrl::fromEncoded(request.url.toUtf8());
+
+        // Reused thumbnailer would keep its previous url
+        if (!url.isValid()) {
+            continue;
+        }
+
+        PageThumbnailer* thumbnailer;
+
+        if (!m_idleThumbnailers.isEmpty()) {
+            thumbnailer = m_idleThumbnailers.takeLast();
+        }
+        else {
+            thumbnailer = new PageThumbnailer(this);
+            connect(thumbnailer, SIGNAL(thumbnailCreated(QPixmap)), this, SLOT(thumbnailCreated(QPixmap)));
+        }
+
+        thumbnailer->setUrl(url);
+        thumbnailer->setLoadTitle(request.loadTitle);
+        thumbnailer->setTimeout(m_thumbnailTimeout * 1000);
+
+        m_runningThumbnailers.insert(thumbnailer, request.url);
+        thumbnailer->start();
+    }
+
+    if (m_runningThumbnailers.isEmpty() && !m_idleThumbnailers.isEmpty()) {
+        m_idleTimer->start();
+    }
+    else {
+        m_idleTimer->stop();
+    }
+}
+
+QString SpeedDial::thumbnailFile(const QString &url) const
+{
+    QHash<QString, Thumbnail>::const_iterator it = m_thumbnails.constFind(url);
+    if (it == m_thumbnails.constEnd()) {
+        return QString();
+    }
+
+    return m_thumbnailsDir + it.value().fileName;
+}
+
+bool SpeedDial::isThumbnailStale(const QString &url) const
+{
+    if (m_thumbnailMaxAge <= 0 || !m_thumbnails.contains(url)) {
+        return false;
+    }
+
+    return m_thumbnails.value(url).created.daysTo(QDateTime::currentDateTime()) >= m_thumbnailMaxAge;
+}
+
+QString SpeedDial::saveThumbnail(const QString &url, const QPixmap &pixmap)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    pixmap.save(&buffer, "PNG");
+
+    const QString fileName = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex() + ".png";
+
+    // Remove previous thumbnail first, it may be the same file
+    removeThumbnail(url);
+
+    QFile file(m_thumbnailsDir + fileName);
+    if (!file.exists()) {
+        if (!file.open(QFile::WriteOnly) || file.write(data) != data.size()) {
+            qWarning() << "SpeedDial::thumbnailCreated Cannot save thumbnail to " << file.fileName();
+        }
+        file.close();
+    }
+
+    Thumbnail thumbnail;
+    thumbnail.fileName = fileName;
+    thumbnail.created = QDateTime::currentDateTime();
+    m_thumbnails[url] = thumbnail;
+
+    saveThumbnailsIndex();
+
+    return m_thumbnailsDir + fileName;
+}
+
+void SpeedDial::removeThumbnail(const QString &url)
+{
+    if (!m_thumbnails.contains(url)) {
+        return;
+    }
+
+    const QString fileName = m_thumbnails.take(url).fileName;
+
+    // File may be shared by other urls with the same thumbnail
+    bool used = false;
+    foreach (const Thumbnail &thumbnail, m_thumbnails) {
+        if (thumbnail.fileName == fileName) {
+            used = true;
+            break;
+        }
+    }
+
+    if (!used) {
+        QFile::remove(m_thumbnailsDir + fileName);
+    }
+
+    saveThumbnailsIndex();
+}
+
+void SpeedDial::loadThumbnailsIndex()
+{
+    m_thumbnails.clear();
+
+    QFile file(m_thumbnailsDir + QLatin1String("thumbnails.dat"));
+
+    if (file.open(QFile::ReadOnly)) {
+        QDataStream stream(&file);
+
+        int version;
+        int count;
+        stream >> version >> count;
+
+        if (stream.status() == QDataStream::Ok && version == thumbnailsIndexVersion) {
+            for (int i = 0; i < count; ++i) {
+                QString url;
+                Thumbnail thumbnail;
+                stream >> url >> thumbnail.fileName >> thumbnail.created;
+
+                if (stream.status() != QDataStream::Ok) {
+                    break;
+                }
+
+                if (QFile::exists(m_thumbnailsDir + thumbnail.fileName)) {
+                    m_thumbnails[url] = thumbnail;
+                }
+            }
+        }
+
+        return;
+    }
+
+    // Use thumbnails saved by previous versions, named by hash of url
+    foreach (const Page &page, m_webPages) {
+        const QString fileName = QCryptographicHash::hash(page.url.toUtf8(), QCryptographicHash::Md4).toHex() + ".png";
+        const QFileInfo info(m_thumbnailsDir + fileName);
+
+        if (info.exists()) {
+            Thumbnail thumbnail;
+            thumbnail.fileName = fileName;
+            thumbnail.created = info.lastModified();
+            m_thumbnails[page.url] = thumbnail;
+        }
+    }
+
+    saveThumbnailsIndex();
+}
+
+void SpeedDial::saveThumbnailsIndex()
+{
+    QFile file(m_thumbnailsDir + QLatin1String("thumbnails.dat"));
+
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "SpeedDial::saveThumbnailsIndex Cannot open" << file.fileName();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << thumbnailsIndexVersion << m_thumbnails.count();
+
+    QHash<QString, Thumbnail>::const_iterator it = m_thumbnails.constBegin();
+    while (it != m_thumbnails.constEnd()) {
+        stream << it.key() << it.value().fileName << it.value().created;
+        ++it;
+    }
 }
 
 QString SpeedDial::escapeTitle(QString title) const
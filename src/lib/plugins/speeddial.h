@@ -20,12 +20,15 @@
 
 #include <QObject>
 #include <QPointer>
+#include <QDateTime>
+#include <QHash>
 
 #include "qzcommon.h"
 
 class QUrl;
 class QWebFrame;
 class QPixmap;
+class QTimer;
 
 class PageThumbnailer;
 
@@ -63,6 +66,9 @@ public:
     QString backgroundImageSize();
     QString initialScript();
 
+    // Increased on every change of pages, thumbnails or settings that are shown on speed dial page
+    int revision() const;
+
 signals:
     void pagesChanged();
 
@@ -81,14 +87,36 @@ public slots:
 
 private slots:
     void thumbnailCreated(const QPixmap &pixmap);
+    void clearIdleThumbnailers();
 
 private:
+    // Thumbnails are saved in files named by hash of their content,
+    // so the same thumbnail is saved only once
+    struct Thumbnail {
+        QString fileName;
+        QDateTime created;
+    };
+
+    struct ThumbnailRequest {
+        QString url;
+        bool loadTitle;
+    };
+
     QString escapeTitle(QString string) const;
     QString escapeUrl(QString url) const;
 
     QList<QWebFrame*> cleanFrames();
     QString generateAllPages();
 
+    QString thumbnailFile(const QString &url) const;
+    bool isThumbnailStale(const QString &url) const;
+    QString saveThumbnail(const QString &url, const QPixmap &pixmap);
+    void removeThumbnail(const QString &url);
+    void loadThumbnailsIndex();
+    void saveThumbnailsIndex();
+
+    void startThumbnailers();
+
     QString m_initialScript;
     QString m_thumbnailsDir;
     QString m_backgroundImage;
@@ -100,8 +128,19 @@ private:
     QList<QPointer<QWebFrame> > m_webFrames;
     QList<Page> m_webPages;
 
+    QHash<QString, Thumbnail> m_thumbnails;
+    QList<ThumbnailRequest> m_thumbnailRequests;
+    // Running thumbnailer -> requested url
+    QHash<PageThumbnailer*, QString> m_runningThumbnailers;
+    QList<PageThumbnailer*> m_idleThumbnailers;
+    QTimer* m_idleTimer;
+    int m_maxThumbnailers;
+    int m_thumbnailTimeout;
+    int m_thumbnailMaxAge;
+
     bool m_loaded;
     bool m_regenerateScript;
+    int m_revision;
 };
 
 #endif // SPEEDDIAL_H
@@ -25,6 +25,7 @@
 #include "locationbar.h"
 #include "autofillmanager.h"
 #include "mainapplication.h"
+#include "networkcache.h"
 #include "cookiemanager.h"
 #include "pluginproxy.h"
 #include "pluginsmanager.h"
@@ -57,7 +58,6 @@
 #include <QCloseEvent>
 #include <QColorDialog>
 #include <QDesktopWidget>
-#include <QNetworkDiskCache>
 
 static QString createLanguageItem(const QString &lang)
 {
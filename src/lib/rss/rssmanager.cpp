@@ -24,17 +24,12 @@
 #include "iconprovider.h"
 #include "browsinglibrary.h"
 #include "qztools.h"
-#include "followredirectreply.h"
-#include "networkmanager.h"
 #include "qzsettings.h"
 
 #include <QMenu>
 #include <QLabel>
-#include <QXmlStreamReader>
-#include <QXmlStreamWriter>
 #include <QWebSettings>
 #include <QMessageBox>
-#include <QNetworkReply>
 #include <QBuffer>
 #include <QSqlQuery>
 
@@ -48,7 +43,6 @@ RSSManager::RSSManager(BrowserWindow* window, QWidget* parent)
     ui->tabWidget->setDocumentMode(false);
 #endif
     ui->tabWidget->setElideMode(Qt::ElideRight);
-    m_networkManager = mApp->networkManager();
 
     m_reloadButton = new QToolButton(this);
     m_reloadButton->setAutoRaise(true);
@@ -61,6 +55,10 @@ RSSManager::RSSManager(BrowserWindow* window, QWidget* parent)
     connect(ui->add, SIGNAL(clicked()), this, SLOT(addFeed()));
     connect(ui->deletebutton, SIGNAL(clicked()), this, SLOT(deleteFeed()));
     connect(ui->edit, SIGNAL(clicked()), this, SLOT(editFeed()));
+
+    RSSUpdater* updater = mApp->rssUpdater();
+    connect(updater, SIGNAL(feedUpdated(QUrl,QVector<RSSUpdater::Item>)), this, SLOT(feedUpdated(QUrl,QVector<RSSUpdater::Item>)));
+    connect(updater, SIGNAL(feedFailed(QUrl)), this, SLOT(feedFailed(QUrl)));
 }
 
 BrowserWindow* RSSManager::getQupZilla()
@@ -109,12 +107,19 @@ void RSSManager::refreshTable()
         connect(tree, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)), this, SLOT(loadFeed(QTreeWidgetItem*)));
         connect(tree, SIGNAL(itemMiddleButtonClicked(QTreeWidgetItem*)), this, SLOT(controlLoadFeed(QTreeWidgetItem*)));
         connect(tree, SIGNAL(itemControlClicked(QTreeWidgetItem*)), this, SLOT(controlLoadFeed(QTreeWidgetItem*)));
-        QTreeWidgetItem* item = new QTreeWidgetItem();
-        item->setText(0, tr("Loading..."));
-        tree->addTopLevelItem(item);
+
+        // Show stored items, only feeds that were never fetched are loaded now
+        const QVector<RSSUpdater::Item> items = mApp->rssUpdater()->items(address);
+
+        if (items.isEmpty()) {
+            setLoading(tree);
+            mApp->rssUpdater()->updateFeed(address);
+        }
+        else {
+            fillTree(tree, items);
+        }
 
         ui->tabWidget->setTabIcon(i, icon);
-        beginToLoadSlot(address);
         i++;
     }
     if (i > 0) {
@@ -149,12 +154,9 @@ void RSSManager::reloadFeeds()
     if (!treeWidget) {
         return;
     }
-    treeWidget->clear();
-    QTreeWidgetItem* item = new QTreeWidgetItem();
-    item->setText(0, tr("Loading..."));
-    treeWidget->addTopLevelItem(item);
+    setLoading(treeWidget);
 
-    beginToLoadSlot(QUrl(ui->tabWidget->tabToolTip(ui->tabWidget->currentIndex())));
+    mApp->rssUpdater()->updateFeed(QUrl(ui->tabWidget->tabToolTip(ui->tabWidget->currentIndex())));
 }
 
 void RSSManager::addFeed()
@@ -180,6 +182,8 @@ void RSSManager::deleteFeed()
     query.addBindValue(url);
     query.exec();
 
+    mApp->rssUpdater()->removeFeed(QUrl(url));
+
     ui->tabWidget->removeTab(ui->tabWidget->currentIndex());
     if (ui->tabWidget->count() == 0) {
         refreshTable();
@@ -234,6 +238,10 @@ void RSSManager::editFeed()
     query.bindValue(2, url);
     query.exec();
 
+    if (address != url) {
+        mApp->rssUpdater()->removeFeed(QUrl(url));
+    }
+
     refreshTable();
 }
 
@@ -291,99 +299,75 @@ void RSSManager::loadFeedInNewTab()
     }
 }
 
-void RSSManager::beginToLoadSlot(const QUrl &url)
+void RSSManager::feedUpdated(const QUrl &feed, const QVector<RSSUpdater::Item> &items)
 {
-    FollowRedirectReply* reply = new FollowRedirectReply(url, m_networkManager);
-    connect(reply, SIGNAL(finished()), this, SLOT(finished()));
-
-    QPair<FollowRedirectReply*, QUrl> pair;
-    pair.first = reply;
-    pair.second = url;
-    m_replies.append(pair);
+    if (TreeWidget* treeWidget = treeForFeed(feed)) {
+        fillTree(treeWidget, items);
+    }
 }
 
-void RSSManager::finished()
+void RSSManager::feedFailed(const QUrl &feed)
 {
-    FollowRedirectReply* reply = qobject_cast<FollowRedirectReply*> (sender());
-    if (!reply) {
-        return;
-    }
+    TreeWidget* treeWidget = treeForFeed(feed);
 
-    QString replyUrl;
-    for (int i = 0; i < m_replies.count(); i++) {
-        QPair<FollowRedirectReply*, QUrl> pair = m_replies.at(i);
-        if (pair.first == reply) {
-            replyUrl = pair.second.toString();
-            break;
-        }
+    if (!treeWidget) {
+        return;
     }
 
-    if (replyUrl.isEmpty()) {
+    // Keep showing items from last successful update
+    if (!mApp->rssUpdater()->items(feed).isEmpty()) {
+        fillTree(treeWidget, mApp->rssUpdater()->items(feed));
         return;
     }
 
-    QString currentTag;
-    QString linkString;
-    QString titleString;
+    treeWidget->clear();
 
-    QXmlStreamReader xml;
-    xml.addData(reply->readAll());
+    QTreeWidgetItem* item = new QTreeWidgetItem;
+    item->setText(0, tr("Error in fetching feed"));
+    treeWidget->addTopLevelItem(item);
+}
 
-    reply->deleteLater();
+TreeWidget* RSSManager::treeForFeed(const QUrl &feed) const
+{
+    const QString address = feed.toString();
 
-    int tabIndex = -1;
     for (int i = 0; i < ui->tabWidget->count(); i++) {
-        if (replyUrl == ui->tabWidget->tabToolTip(i)) {
-            tabIndex = i;
-            break;
+        if (address == ui->tabWidget->tabToolTip(i)) {
+            return qobject_cast<TreeWidget*>(ui->tabWidget->widget(i));
         }
     }
 
-    if (tabIndex == -1) {
-        return;
-    }
+    return 0;
+}
 
-    TreeWidget* treeWidget = qobject_cast<TreeWidget*>(ui->tabWidget->widget(tabIndex));
-    if (!treeWidget) {
-        return;
-    }
-    treeWidget->clear();
+void RSSManager::setLoading(TreeWidget* tree)
+{
+    tree->clear();
 
-    while (!xml.atEnd()) {
-        xml.readNext();
-        if (xml.isStartElement()) {
-            if (xml.name() == QLatin1String("item")) {
-                linkString = xml.attributes().value("rss:about").toString();
-            }
-            currentTag = xml.qualifiedName().toString();
-        }
-        else if (xml.isEndElement()) {
-            if (xml.qualifiedName() == QLatin1String("item")) {
-                QTreeWidgetItem* item = new QTreeWidgetItem;
-                item->setText(0, titleString);
-                item->setIcon(0, QIcon(":/icons/other/feed.png"));
-                item->setToolTip(0, linkString);
-                treeWidget->addTopLevelItem(item);
-
-                titleString.clear();
-                linkString.clear();
-            }
-        }
-        else if (xml.isCharacters() && !xml.isWhitespace()) {
-            if (currentTag == QLatin1String("title")) {
-                titleString = xml.text().toString();
-            }
-            else if (currentTag == QLatin1String("link")) {
-                linkString += xml.text().toString();
-            }
-        }
-    }
+    QTreeWidgetItem* item = new QTreeWidgetItem;
+    item->setText(0, tr("Loading..."));
+    tree->addTopLevelItem(item);
+}
 
-    if (treeWidget->topLevelItemCount() == 0) {
+void RSSManager::fillTree(TreeWidget* tree, const QVector<RSSUpdater::Item> &items)
+{
+    const QIcon icon(QLatin1String(":/icons/other/feed.png"));
+
+    QList<QTreeWidgetItem*> treeItems;
+    treeItems.reserve(items.size());
+
+    foreach (const RSSUpdater::Item &i, items) {
         QTreeWidgetItem* item = new QTreeWidgetItem;
-        item->setText(0, tr("Error in fetching feed"));
-        treeWidget->addTopLevelItem(item);
+        item->setText(0, i.title);
+        item->setIcon(0, icon);
+        item->setToolTip(0, i.link);
+        treeItems.append(item);
     }
+
+    tree->setUpdatesEnabled(false);
+    tree->clear();
+    tree->addTopLevelItems(treeItems);
+    tree->setUpdatesEnabled(true);
 }
 
 bool RSSManager::addRssFeed(const QUrl &url, const QString &title, const QIcon &icon)
@@ -412,6 +396,8 @@ bool RSSManager::addRssFeed(const QUrl &url, const QString &title, const QIcon &
         image.save(&buffer, "PNG");
         query.bindValue(2, buffer.data());
         query.exec();
+
+        mApp->rssUpdater()->updateFeed(url);
         return true;
     }
 
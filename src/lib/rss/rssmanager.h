@@ -19,11 +19,11 @@
 #define RSSMANAGER_H
 
 #include "qzcommon.h"
+#include "rssupdater.h"
 
 #include <QWidget>
 #include <QTreeWidget>
 #include <QUrl>
-#include <QNetworkAccessManager>
 #include <QFormLayout>
 #include <QPointer>
 #include <QDialogButtonBox>
@@ -36,8 +36,8 @@ class RSSManager;
 }
 
 class BrowserWindow;
-class FollowRedirectReply;
-class NetworkManager;
+class TreeWidget;
+
 class QUPZILLA_EXPORT RSSManager : public QWidget
 {
     Q_OBJECT
@@ -54,8 +54,8 @@ public slots:
     void refreshTable();
 
 private slots:
-    void beginToLoadSlot(const QUrl &url);
-    void finished();
+    void feedUpdated(const QUrl &feed, const QVector<RSSUpdater::Item> &items);
+    void feedFailed(const QUrl &feed);
     void loadFeed(QTreeWidgetItem* item);
     void controlLoadFeed(QTreeWidgetItem* item);
     void addFeed();
@@ -69,8 +69,9 @@ private:
     BrowserWindow* getQupZilla();
     void deleteAllTabs();
 
-    QList<QPair<FollowRedirectReply*, QUrl> > m_replies;
-    NetworkManager* m_networkManager;
+    TreeWidget* treeForFeed(const QUrl &feed) const;
+    void setLoading(TreeWidget* tree);
+    void fillTree(TreeWidget* tree, const QVector<RSSUpdater::Item> &items);
 
     Ui::RSSManager* ui;
     QToolButton* m_reloadButton;
@@ -0,0 +1,354 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "rssupdater.h"
+#include "mainapplication.h"
+#include "networkmanager.h"
+#include "settings.h"
+
+#include <QXmlStreamReader>
+#include <QNetworkReply>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QDateTime>
+#include <QTimer>
+
+struct RSSUpdater::FeedReply {
+    FeedReply() : inItem(false), redirectCount(0) { }
+
+    QUrl feed;
+    QXmlStreamReader xml;
+    QVector<Item> items;
+    Item currentItem;
+    QString currentTag;
+    bool inItem;
+    int redirectCount;
+};
+
+RSSUpdater::RSSUpdater(QObject* parent)
+    : QObject(parent)
+    , m_updateInterval(0)
+{
+    QSqlDatabase db = QSqlDatabase::database();
+    const QStringList tables = db.tables();
+
+    if (!tables.contains(QLatin1String("rss_items"))) {
+        db.exec("CREATE TABLE rss_items (id INTEGER PRIMARY KEY, address TEXT, title TEXT, link TEXT)");
+        db.exec("CREATE INDEX rssItemsAddress ON rss_items(address ASC)");
+    }
+
+    if (!tables.contains(QLatin1String("rss_status"))) {
+        db.exec("CREATE TABLE rss_status (address TEXT PRIMARY KEY, etag TEXT, last_modified TEXT, last_update NUMERIC)");
+    }
+
+    m_timer = new QTimer(this);
+    m_timer->setInterval(5 * 60 * 1000);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(updateFeeds()));
+
+    loadSettings();
+
+    // Don't slow down startup
+    QTimer::singleShot(30 * 1000, this, SLOT(updateFeeds()));
+}
+
+void RSSUpdater::loadSettings()
+{
+    Settings settings;
+    settings.beginGroup("RSS");
+    // Interval in minutes, 0 disables automatic updates
+    m_updateInterval = settings.value("updateInterval", 60).toInt();
+    settings.endGroup();
+
+    if (m_updateInterval > 0 && !mApp->isPrivate()) {
+        m_timer->start();
+    }
+    else {
+        m_timer->stop();
+    }
+}
+
+QVector<RSSUpdater::Item> RSSUpdater::items(const QUrl &feed) const
+{
+    QVector<Item> list;
+
+    QSqlQuery query;
+    query.prepare("SELECT title, link FROM rss_items WHERE address=? ORDER BY id ASC");
+    query.addBindValue(feed.toString());
+    query.exec();
+
+    while (query.next()) {
+        Item item;
+        item.title = query.value(0).toString();
+        item.link = query.value(1).toString();
+        list.append(item);
+    }
+
+    return list;
+}
+
+void RSSUpdater::updateFeed(const QUrl &feed)
+{
+    if (!feed.isValid()) {
+        return;
+    }
+
+    foreach (FeedReply* feedReply, m_replies) {
+        if (feedReply->feed == feed) {
+            return;
+        }
+    }
+
+    FeedReply* feedReply = new FeedReply;
+    feedReply->feed = feed;
+
+    startRequest(feedReply, feed);
+}
+
+void RSSUpdater::removeFeed(const QUrl &feed)
+{
+    QSqlQuery query;
+    query.prepare("DELETE FROM rss_items WHERE address=?");
+    query.addBindValue(feed.toString());
+    query.exec();
+
+    query.prepare("DELETE FROM rss_status WHERE address=?");
+    query.addBindValue(feed.toString());
+    query.exec();
+}
+
+void RSSUpdater::updateFeeds()
+{
+    if (m_updateInterval <= 0 || mApp->isPrivate()) {
+        return;
+    }
+
+    const qint64 threshold = QDateTime::currentMSecsSinceEpoch() - qint64(m_updateInterval) * 60 * 1000;
+
+    QSqlQuery query;
+    query.prepare("SELECT rss.address FROM rss LEFT JOIN rss_status ON rss.address = rss_status.address "
+                  "WHERE rss_status.last_update IS NULL OR rss_status.last_update < ?");
+    query.addBindValue(threshold);
+    query.exec();
+
+    while (query.next()) {
+        updateFeed(QUrl(query.value(0).toString()));
+    }
+}
+
+void RSSUpdater::replyReadyRead()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    FeedReply* feedReply = m_replies.value(reply);
+
+    if (!feedReply) {
+        return;
+    }
+
+    // Redirects and errors are handled when reply is finished
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status >= 300) {
+        return;
+    }
+
+    feedReply->xml.addData(reply->readAll());
+    parse(feedReply);
+}
+
+void RSSUpdater::replyFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    FeedReply* feedReply = m_replies.take(reply);
+
+    if (!feedReply) {
+        return;
+    }
+
+    reply->deleteLater();
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QUrl redirectUrl = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+    if (status >= 300 && status < 400 && status != 304 && redirectUrl.isValid() && feedReply->redirectCount < 5) {
+        feedReply->redirectCount++;
+        feedReply->xml.clear();
+        startRequest(feedReply, reply->url().resolved(redirectUrl));
+        return;
+    }
+
+    if (status == 304) {
+        QSqlQuery query;
+        query.prepare("UPDATE rss_status SET last_update=? WHERE address=?");
+        query.addBindValue(QDateTime::currentMSecsSinceEpoch());
+        query.addBindValue(feedReply->feed.toString());
+        query.exec();
+
+        emit feedUpdated(feedReply->feed, items(feedReply->feed));
+    }
+    else if (reply->error() == QNetworkReply::NoError && status < 300) {
+        feedReply->xml.addData(reply->readAll());
+        parse(feedReply);
+
+        if (feedReply->items.isEmpty()) {
+            emit feedFailed(feedReply->feed);
+        }
+        else {
+            saveItems(feedReply->feed, feedReply->items);
+            saveStatus(feedReply->feed, reply->rawHeader("ETag"), reply->rawHeader("Last-Modified"));
+
+            emit feedUpdated(feedReply->feed, feedReply->items);
+        }
+    }
+    else {
+        emit feedFailed(feedReply->feed);
+    }
+
+    delete feedReply;
+}
+
+void RSSUpdater::startRequest(FeedReply* feedReply, const QUrl &url)
+{
+    QNetworkRequest request(url);
+
+    QSqlQuery query;
+    query.prepare("SELECT etag, last_modified FROM rss_status WHERE address=?");
+    query.addBindValue(feedReply->feed.toString());
+    query.exec();
+
+    if (query.next()) {
+        const QByteArray etag = query.value(0).toByteArray();
+        const QByteArray lastModified = query.value(1).toByteArray();
+
+        if (!etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", etag);
+        }
+        if (!lastModified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", lastModified);
+        }
+    }
+
+    QNetworkReply* reply = mApp->networkManager()->get(request);
+    connect(reply, SIGNAL(readyRead()), this, SLOT(replyReadyRead()));
+    connect(reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+
+    m_replies.insert(reply, feedReply);
+}
+
+void RSSUpdater::parse(FeedReply* feedReply)
+{
+    // Supports RSS 0.9x, 1.0 (RDF), 2.0 and Atom feeds.
+    // Parsing stops with PrematureEndOfDocumentError when all received data
+    // are processed and continues when new data arrives.
+    QXmlStreamReader &xml = feedReply->xml;
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+
+        if (xml.isStartElement()) {
+            const QStringRef name = xml.qualifiedName();
+
+            if (name == QLatin1String("item") || name == QLatin1String("entry")) {
+                feedReply->inItem = true;
+                feedReply->currentItem = Item();
+                feedReply->currentItem.link = xml.attributes().value(QLatin1String("rdf:about")).toString();
+            }
+            else if (feedReply->inItem && name == QLatin1String("link")) {
+                const QXmlStreamAttributes attributes = xml.attributes();
+
+                if (!attributes.hasAttribute(QLatin1String("href"))) {
+                    feedReply->currentItem.link.clear();
+                }
+                else if (feedReply->currentItem.link.isEmpty() || attributes.value(QLatin1String("rel")) == QLatin1String("alternate")) {
+                    feedReply->currentItem.link = attributes.value(QLatin1String("href")).toString();
+                }
+            }
+
+            feedReply->currentTag = name.toString();
+        }
+        else if (xml.isEndElement()) {
+            const QStringRef name = xml.qualifiedName();
+
+            if (feedReply->inItem && (name == QLatin1String("item") || name == QLatin1String("entry"))) {
+                feedReply->inItem = false;
+
+                Item &item = feedReply->currentItem;
+                item.title = item.title.trimmed();
+                if (item.title.isEmpty()) {
+                    item.title = item.link;
+                }
+
+                feedReply->items.append(item);
+            }
+
+            feedReply->currentTag.clear();
+        }
+        else if (feedReply->inItem && xml.isCharacters() && !xml.isWhitespace()) {
+            if (feedReply->currentTag == QLatin1String("title")) {
+                feedReply->currentItem.title += xml.text().toString();
+            }
+            else if (feedReply->currentTag == QLatin1String("link")) {
+                feedReply->currentItem.link += xml.text().toString().trimmed();
+            }
+        }
+    }
+}
+
+void RSSUpdater::saveItems(const QUrl &feed, const QVector<Item> &items)
+{
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
+
+    QSqlQuery query;
+    query.prepare("DELETE FROM rss_items WHERE address=?");
+    query.addBindValue(feed.toString());
+    query.exec();
+
+    query.prepare("INSERT INTO rss_items (address, title, link) VALUES (?, ?, ?)");
+
+    foreach (const Item &item, items) {
+        query.bindValue(0, feed.toString());
+        query.bindValue(1, item.title);
+        query.bindValue(2, item.link);
+        query.exec();
+    }
+
+    db.commit();
+}
+
+void RSSUpdater::saveStatus(const QUrl &feed, const QByteArray &etag, const QByteArray &lastModified)
+{
+    QSqlQuery query;
+    query.prepare("INSERT OR REPLACE INTO rss_status (address, etag, last_modified, last_update) VALUES (?, ?, ?, ?)");
+    query.addBindValue(feed.toString());
+    query.addBindValue(QString::fromLatin1(etag));
+    query.addBindValue(QString::fromLatin1(lastModified));
+    query.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    query.exec();
+}
+
+RSSUpdater::~RSSUpdater()
+{
+    QHashIterator<QNetworkReply*, FeedReply*> it(m_replies);
+
+    while (it.hasNext()) {
+        it.next();
+        it.key()->disconnect(this);
+        it.key()->abort();
+        it.key()->deleteLater();
+        delete it.value();
+    }
+}
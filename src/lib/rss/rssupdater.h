@@ -0,0 +1,79 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef RSSUPDATER_H
+#define RSSUPDATER_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QUrl>
+
+#include "qzcommon.h"
+
+class QTimer;
+class QNetworkReply;
+
+class QUPZILLA_EXPORT RSSUpdater : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Item {
+        QString title;
+        QString link;
+    };
+
+    explicit RSSUpdater(QObject* parent = 0);
+    ~RSSUpdater();
+
+    void loadSettings();
+
+    // Returns items stored from last successful update
+    QVector<Item> items(const QUrl &feed) const;
+
+    void updateFeed(const QUrl &feed);
+    void removeFeed(const QUrl &feed);
+
+signals:
+    void feedUpdated(const QUrl &feed, const QVector<RSSUpdater::Item> &items);
+    void feedFailed(const QUrl &feed);
+
+public slots:
+    void updateFeeds();
+
+private slots:
+    void replyReadyRead();
+    void replyFinished();
+
+private:
+    struct FeedReply;
+
+    void startRequest(FeedReply* feedReply, const QUrl &url);
+    void parse(FeedReply* feedReply);
+    void saveItems(const QUrl &feed, const QVector<Item> &items);
+    void saveStatus(const QUrl &feed, const QByteArray &etag, const QByteArray &lastModified);
+
+    QTimer* m_timer;
+    int m_updateInterval;
+
+    QHash<QNetworkReply*, FeedReply*> m_replies;
+};
+
+Q_DECLARE_TYPEINFO(RSSUpdater::Item, Q_MOVABLE_TYPE);
+
+#endif // RSSUPDATER_H
@@ -23,7 +23,23 @@
 
 RestoreManager::RestoreManager()
 {
-    createFromFile(DataPaths::currentProfilePath() + QLatin1String("/session.dat"));
+    createFromData(readSessionFile());
+}
+
+RestoreManager::RestoreManager(const QByteArray &sessionData)
+{
+    createFromData(sessionData);
+}
+
+QByteArray RestoreManager::readSessionFile()
+{
+    QFile file(DataPaths::currentProfilePath() + QLatin1String("/session.dat"));
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    return file.readAll();
 }
 
 RestoreData RestoreManager::restoreData() const
@@ -36,15 +52,13 @@ bool RestoreManager::isValid() const
     return !m_data.isEmpty();
 }
 
-void RestoreManager::createFromFile(const QString &file)
+void RestoreManager::createFromData(const QByteArray &data)
 {
-    if (!QFile::exists(file)) {
+    if (data.isEmpty()) {
         return;
     }
 
-    QFile recoveryFile(file);
-    recoveryFile.open(QIODevice::ReadOnly);
-    QDataStream stream(&recoveryFile);
+    QDataStream stream(data);
 
     int version;
     stream >> version;
@@ -32,12 +32,17 @@ public:
     };
 
     explicit RestoreManager();
+    // Restore from data of session file already read by readSessionFile()
+    explicit RestoreManager(const QByteArray &sessionData);
+
+    // Can be called from any thread
+    static QByteArray readSessionFile();
 
     QVector<RestoreManager::WindowData> restoreData() const;
     bool isValid() const;
 
 private:
-    void createFromFile(const QString &file);
+    void createFromData(const QByteArray &data);
 
     QVector<RestoreManager::WindowData> m_data;
 };
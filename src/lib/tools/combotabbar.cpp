@@ -1018,6 +1018,57 @@ void TabBarHelper::initStyleBaseOption(QStyleOptionTabBarBaseV2* optTabBase, QTa
     }
 }
 
+void TabBarHelper::visibleTabsRange(int &first, int &last) const
+{
+    first = 0;
+    last = count() - 1;
+
+    if (!m_scrollArea || count() == 0) {
+        return;
+    }
+
+    QWidget* viewport = m_scrollArea->viewport();
+    const int viewportLeft = mapFrom(viewport, QPoint(0, 0)).x();
+    const int viewportRight = viewportLeft + viewport->width() - 1;
+    const bool rtl = isRightToLeft();
+
+    // Tabs are laid out in order of their indexes, so the range is found with binary
+    // search on tab positions instead of testing every tab (widths may differ)
+    int low = 0;
+    int high = count();
+
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        const QRect rect = tabRect(middle);
+
+        // Tab is before the viewport
+        if (rtl ? rect.left() > viewportRight : rect.right() < viewportLeft) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    first = low;
+    high = count();
+
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        const QRect rect = tabRect(middle);
+
+        // Tab is not after the viewport
+        if (rtl ? rect.right() >= viewportLeft : rect.left() <= viewportRight) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    last = low - 1;
+}
+
 // some codes were taken from qtabbar.cpp
 void TabBarHelper::paintEvent(QPaintEvent* event)
 {
@@ -1039,8 +1090,9 @@ void TabBarHelper::paintEvent(QPaintEvent* event)
     QStylePainter p(this);
     int selected = currentIndex();
 
-    for (int i = 0; i < count(); ++i) {
-        optTabBase.tabBarRect |= tabRect(i);
+    // Tabs are laid out next to each other, first and last tab are enough
+    if (count() > 0) {
+        optTabBase.tabBarRect = tabRect(0) | tabRect(count() - 1);
     }
 
     optTabBase.selectedTabRect = QRect();
@@ -1052,7 +1104,11 @@ void TabBarHelper::paintEvent(QPaintEvent* event)
     const QPoint cursorPos = QCursor::pos();
     int indexUnderMouse = isDisplayedOnViewPort(cursorPos.x(), cursorPos.x()) ? tabAt(mapFromGlobal(cursorPos)) : -1;
 
-    for (int i = 0; i < count(); ++i) {
+    int firstIndex;
+    int lastIndex;
+    visibleTabsRange(firstIndex, lastIndex);
+
+    for (int i = firstIndex; i <= lastIndex; ++i) {
         QStyleOptionTabV3 tab;
         initStyleOption(&tab, i);
 
@@ -216,6 +216,8 @@ public:
     void useFastTabSizeHint(bool enabled);
 
     bool isDisplayedOnViewPort(int globalLeft, int globalRight);
+    // Range of tabs that are at least partially shown in scroll area
+    void visibleTabsRange(int &first, int &last) const;
     bool isDragInProgress() const;
     void enableBluredBackground(bool enable);
 
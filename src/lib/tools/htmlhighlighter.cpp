@@ -56,75 +56,281 @@
  ****************************************************************************/
 #include "htmlhighlighter.h"
 
+#include <QTextDocument>
+#include <QTimer>
+
+#include <limits>
+
+// Number of blocks highlighted in one event loop iteration
+static const int s_chunkSize = 200;
+
+static bool isTagNameChar(const QChar &c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char(':') || c == QLatin1Char('-') || c == QLatin1Char('_');
+}
+
+// Returns end of tag name (including '<', '</' or '<!') or pos if there is no tag at pos
+static int tagNameEnd(const QString &text, int pos)
+{
+    const int length = text.length();
+    int i = pos + 1;
+
+    if (i < length && (text.at(i) == QLatin1Char('/') || text.at(i) == QLatin1Char('!'))) {
+        ++i;
+    }
+
+    if (i >= length || !text.at(i).isLetter()) {
+        return pos;
+    }
+
+    while (i < length && isTagNameChar(text.at(i))) {
+        ++i;
+    }
+
+    return i;
+}
+
 HtmlHighlighter::HtmlHighlighter(QTextDocument* parent)
     : QSyntaxHighlighter(parent)
+    , m_highlightLimit(std::numeric_limits<int>::max())
 {
-    HighlightingRule rule;
-
     // tags: <tag1> </tag1>
-    tagFormat.setForeground(Qt::darkBlue);
-    tagFormat.setFontWeight(QFont::Bold);
-    QStringList keywordPatterns;
-    keywordPatterns << "</?([A-Za-z:0-9]{1,20})/?(>| )?" << ">" << "(<!DOCTYPE html>|<!DOCTYPE html PUBLIC)";
-    foreach (const QString &pattern, keywordPatterns) {
-        rule.pattern = QzRegExp(pattern);
-        rule.format = tagFormat;
-        highlightingRules.append(rule);
-    }
+    m_tagFormat.setForeground(Qt::darkBlue);
+    m_tagFormat.setFontWeight(QFont::Bold);
 
     // options: <tag option1="" option2="">
-    tagOptionsFormat.setForeground(Qt::black);
-    tagOptionsFormat.setFontWeight(QFont::Bold);
-    rule.pattern = QzRegExp("(\\S{2,20})=\"");
-    rule.format = tagOptionsFormat;
-    highlightingRules.append(rule);
+    m_tagOptionsFormat.setForeground(Qt::black);
+    m_tagOptionsFormat.setFontWeight(QFont::Bold);
 
     // " " strings
-    quotationFormat.setForeground(Qt::darkGreen);
-    QzRegExp rx("\".*\"");
-    rx.setMinimal(true);
-    rule.pattern = rx;
-    rule.format = quotationFormat;
-    highlightingRules.append(rule);
+    m_quotationFormat.setForeground(Qt::darkGreen);
 
     // <!-- --> comments
-    multiLineCommentFormat.setForeground(Qt::gray);
-    commentStartExpression = QzRegExp("<!--");
-    commentEndExpression = QzRegExp("-->");
+    m_commentFormat.setForeground(Qt::gray);
+
+    m_chunkTimer = new QTimer(this);
+    m_chunkTimer->setSingleShot(true);
+    m_chunkTimer->setInterval(0);
+    connect(m_chunkTimer, SIGNAL(timeout()), this, SLOT(highlightNextChunk()));
+}
+
+void HtmlHighlighter::resetHighlighting()
+{
+    m_highlightLimit = 0;
+    m_chunkTimer->start();
+}
+
+void HtmlHighlighter::highlightToBlock(int blockNumber)
+{
+    if (!document() || blockNumber < m_highlightLimit) {
+        return;
+    }
+
+    const QTextBlock block = document()->findBlockByNumber(m_highlightLimit);
+    m_highlightLimit = blockNumber + 1;
+
+    // All not yet highlighted blocks have state -1 and highlighted blocks always
+    // change it, so rehighlighting continues with next blocks up to the limit
+    if (block.isValid()) {
+        rehighlightBlock(block);
+    }
+}
+
+void HtmlHighlighter::highlightNextChunk()
+{
+    if (!document() || m_highlightLimit == std::numeric_limits<int>::max()) {
+        return;
+    }
+
+    highlightToBlock(m_highlightLimit + s_chunkSize - 1);
+
+    if (m_highlightLimit >= document()->blockCount()) {
+        m_highlightLimit = std::numeric_limits<int>::max();
+    }
+    else {
+        m_chunkTimer->start();
+    }
 }
 
 void HtmlHighlighter::highlightBlock(const QString &text)
 {
-    foreach (const HighlightingRule &rule, highlightingRules) {
-        QzRegExp expression(rule.pattern);
-        int index = expression.indexIn(text);
-        while (index >= 0) {
-            int length = expression.matchedLength();
-            setFormat(index, length, rule.format);
-            index = expression.indexIn(text, index + length);
+    if (currentBlock().blockNumber() >= m_highlightLimit) {
+        setCurrentBlockState(-1);
+        return;
+    }
+
+    int state = previousBlockState() < 0 ? NormalState : previousBlockState();
+    int rawText = state & RawTextMask;
+    state &= StateMask;
+
+    const int length = text.length();
+    int pos = 0;
+
+    while (pos < length) {
+        switch (state) {
+        case CommentState: {
+            const int end = text.indexOf(QLatin1String("-->"), pos);
+            const int commentEnd = end == -1 ? length : end + 3;
+            setFormat(pos, commentEnd - pos, m_commentFormat);
+            if (end != -1) {
+                state = NormalState;
+            }
+            pos = commentEnd;
+            break;
         }
+
+        case DoubleQuotedState:
+        case SingleQuotedState: {
+            const QLatin1Char quote(state == DoubleQuotedState ? '"' : '\'');
+            const int end = text.indexOf(quote, pos);
+            const int quoteEnd = end == -1 ? length : end + 1;
+            setFormat(pos, quoteEnd - pos, m_quotationFormat);
+            if (end != -1) {
+                state = TagState;
+            }
+            pos = quoteEnd;
+            break;
+        }
+
+        case TagState:
+            pos = highlightTag(text, pos, state, rawText);
+            break;
+
+        case ScriptState:
+        case StyleState:
+            pos = highlightRawText(text, pos, state);
+            break;
+
+        default:
+            pos = highlightText(text, pos, state, rawText);
+            break;
+        }
+    }
+
+    setCurrentBlockState(state | rawText);
+}
+
+int HtmlHighlighter::highlightText(const QString &text, int pos, int &state, int &rawText)
+{
+    const int length = text.length();
+    int i = text.indexOf(QLatin1Char('<'), pos);
+
+    while (i != -1) {
+        if (text.midRef(i, 4) == QLatin1String("<!--")) {
+            highlightQuotes(text, pos, i);
+            state = CommentState;
+            return i;
+        }
+
+        const int nameEnd = tagNameEnd(text, i);
+        if (nameEnd > i) {
+            highlightQuotes(text, pos, i);
+            setFormat(i, nameEnd - i, m_tagFormat);
+
+            if (text.at(i + 1).isLetter()) {
+                const QStringRef name = text.midRef(i + 1, nameEnd - i - 1);
+                if (name.compare(QLatin1String("script"), Qt::CaseInsensitive) == 0) {
+                    rawText = ScriptRawText;
+                }
+                else if (name.compare(QLatin1String("style"), Qt::CaseInsensitive) == 0) {
+                    rawText = StyleRawText;
+                }
+            }
+
+            state = TagState;
+            return nameEnd;
+        }
+
+        i = text.indexOf(QLatin1Char('<'), i + 1);
     }
 
-    // Highlighting multi-line comments
-    setCurrentBlockState(0);
+    highlightQuotes(text, pos, length);
+    return length;
+}
+
+int HtmlHighlighter::highlightTag(const QString &text, int pos, int &state, int &rawText)
+{
+    const int length = text.length();
+    const QChar c = text.at(pos);
+
+    if (c == QLatin1Char('>')) {
+        setFormat(pos, 1, m_tagFormat);
+        state = rawText == ScriptRawText ? ScriptState : rawText == StyleRawText ? StyleState : NormalState;
+        rawText = NoRawText;
+        return pos + 1;
+    }
+
+    if (c == QLatin1Char('/') && pos + 1 < length && text.at(pos + 1) == QLatin1Char('>')) {
+        setFormat(pos, 2, m_tagFormat);
+        state = NormalState;
+        rawText = NoRawText;
+        return pos + 2;
+    }
 
-    int startIndex = 0;
-    if (previousBlockState() != 1) {
-        startIndex = commentStartExpression.indexIn(text);
+    if (c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+        setFormat(pos, 1, m_quotationFormat);
+        state = c == QLatin1Char('"') ? DoubleQuotedState : SingleQuotedState;
+        return pos + 1;
     }
 
-    while (startIndex >= 0) {
-        int endIndex = commentEndExpression.indexIn(text, startIndex);
-        int commentLength;
-        if (endIndex == -1) {
-            setCurrentBlockState(1);
-            commentLength = text.length() - startIndex;
+    if (c.isSpace() || c == QLatin1Char('=')) {
+        return pos + 1;
+    }
+
+    // Attribute name or unquoted value
+    int end = pos + 1;
+    while (end < length) {
+        const QChar ch = text.at(end);
+        if (ch.isSpace() || ch == QLatin1Char('=') || ch == QLatin1Char('>') || ch == QLatin1Char('"') || ch == QLatin1Char('\'')) {
+            break;
+        }
+        if (ch == QLatin1Char('/') && end + 1 < length && text.at(end + 1) == QLatin1Char('>')) {
+            break;
+        }
+        ++end;
+    }
+
+    if (end < length && text.at(end) == QLatin1Char('=')) {
+        ++end;
+        setFormat(pos, end - pos, m_tagOptionsFormat);
+    }
+
+    return end;
+}
+
+int HtmlHighlighter::highlightRawText(const QString &text, int pos, int &state)
+{
+    const QLatin1String closingTag(state == ScriptState ? "</script" : "</style");
+    const int end = text.indexOf(closingTag, pos, Qt::CaseInsensitive);
+
+    if (end == -1) {
+        highlightQuotes(text, pos, text.length());
+        return text.length();
+    }
+
+    highlightQuotes(text, pos, end);
+
+    const int nameEnd = tagNameEnd(text, end);
+    setFormat(end, nameEnd - end, m_tagFormat);
+    state = TagState;
+    return nameEnd;
+}
+
+void HtmlHighlighter::highlightQuotes(const QString &text, int from, int to)
+{
+    int start = -1;
+
+    for (int i = from; i < to; ++i) {
+        if (text.at(i) != QLatin1Char('"')) {
+            continue;
+        }
+
+        if (start == -1) {
+            start = i;
         }
         else {
-            commentLength = endIndex - startIndex
-                            + commentEndExpression.matchedLength();
+            setFormat(start, i - start + 1, m_quotationFormat);
+            start = -1;
         }
-        setFormat(startIndex, commentLength, multiLineCommentFormat);
-        startIndex = commentStartExpression.indexIn(text, startIndex + commentLength);
     }
 }
@@ -62,33 +62,61 @@
 #include <QTextCharFormat>
 
 #include "qzcommon.h"
-#include "qzregexp.h"
 
 class QTextDocument;
+class QTimer;
 
 class QUPZILLA_EXPORT HtmlHighlighter : public QSyntaxHighlighter
 {
+    Q_OBJECT
+
 public:
     HtmlHighlighter(QTextDocument* parent = 0);
 
+    // Stops highlighting of all blocks, must be called before setting new text.
+    // Blocks are then highlighted in chunks from the event loop.
+    void resetHighlighting();
+    // Synchronously highlights all blocks up to blockNumber (eg. visible blocks)
+    void highlightToBlock(int blockNumber);
+
 protected:
     void highlightBlock(const QString &text);
 
+private slots:
+    void highlightNextChunk();
+
 private:
-    struct HighlightingRule {
-        QzRegExp pattern;
-        QTextCharFormat format;
+    enum BlockState {
+        NormalState = 0,
+        CommentState = 1,
+        TagState = 2,
+        DoubleQuotedState = 3,
+        SingleQuotedState = 4,
+        ScriptState = 5,
+        StyleState = 6,
+        StateMask = 0xf
+    };
+
+    // Raw text (<script>, <style>) that starts after currently opened tag is closed
+    enum RawText {
+        NoRawText = 0,
+        ScriptRawText = 1 << 4,
+        StyleRawText = 2 << 4,
+        RawTextMask = 0x30
     };
 
-    QVector<HighlightingRule> highlightingRules;
+    int highlightText(const QString &text, int pos, int &state, int &rawText);
+    int highlightTag(const QString &text, int pos, int &state, int &rawText);
+    int highlightRawText(const QString &text, int pos, int &state);
+    void highlightQuotes(const QString &text, int from, int to);
 
-    QzRegExp commentStartExpression;
-    QzRegExp commentEndExpression;
+    QTextCharFormat m_tagFormat;
+    QTextCharFormat m_tagOptionsFormat;
+    QTextCharFormat m_commentFormat;
+    QTextCharFormat m_quotationFormat;
 
-    QTextCharFormat tagFormat;
-    QTextCharFormat tagOptionsFormat;
-    QTextCharFormat multiLineCommentFormat;
-    QTextCharFormat quotationFormat;
+    int m_highlightLimit;
+    QTimer* m_chunkTimer;
 };
 
 #endif
@@ -0,0 +1,125 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "htmltemplate.h"
+
+static bool isPlaceholderChar(const QChar &c)
+{
+    const ushort u = c.unicode();
+    return (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '-' || u == '_';
+}
+
+HtmlTemplate::HtmlTemplate(const QString &source)
+    : m_length(0)
+{
+    setSource(source);
+}
+
+void HtmlTemplate::setSource(const QString &source)
+{
+    m_segments.clear();
+
+    const int length = source.length();
+    int textStart = 0;
+    int pos = 0;
+
+    while ((pos = source.indexOf(QLatin1Char('%'), pos)) != -1) {
+        int end = pos + 1;
+        while (end < length && isPlaceholderChar(source.at(end))) {
+            ++end;
+        }
+
+        // Not a placeholder, eg. "100%" in stylesheet
+        if (end == pos + 1 || end == length || source.at(end) != QLatin1Char('%')) {
+            ++pos;
+            continue;
+        }
+
+        appendText(source.mid(textStart, pos - textStart));
+
+        Segment segment;
+        segment.text = source.mid(pos + 1, end - pos - 1);
+        segment.isPlaceholder = true;
+        m_segments.append(segment);
+
+        pos = end + 1;
+        textStart = pos;
+    }
+
+    appendText(source.mid(textStart));
+    updateLength();
+}
+
+bool HtmlTemplate::isEmpty() const
+{
+    return m_segments.isEmpty();
+}
+
+QString HtmlTemplate::render(const QHash<QString, QString> &values) const
+{
+    int length = m_length;
+    foreach (const QString &value, values) {
+        length += value.length();
+    }
+
+    QString output;
+    output.reserve(length);
+
+    foreach (const Segment &segment, m_segments) {
+        if (!segment.isPlaceholder) {
+            output.append(segment.text);
+            continue;
+        }
+
+        QHash<QString, QString>::const_iterator it = values.constFind(segment.text);
+        if (it != values.constEnd()) {
+            output.append(it.value());
+        }
+        else {
+            output.append(QLatin1Char('%') + segment.text + QLatin1Char('%'));
+        }
+    }
+
+    return output;
+}
+
+void HtmlTemplate::appendText(const QString &text)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+
+    // Adjacent text segments are merged
+    if (!m_segments.isEmpty() && !m_segments.last().isPlaceholder) {
+        m_segments.last().text.append(text);
+        return;
+    }
+
+    Segment segment;
+    segment.text = text;
+    segment.isPlaceholder = false;
+    m_segments.append(segment);
+}
+
+void HtmlTemplate::updateLength()
+{
+    m_length = 0;
+
+    foreach (const Segment &segment, m_segments) {
+        m_length += segment.text.length();
+    }
+}
@@ -0,0 +1,54 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef HTMLTEMPLATE_H
+#define HTMLTEMPLATE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+#include "qzcommon.h"
+
+// Page template with placeholders written as %NAME%, where name consists of
+// upper-case letters, digits, '-' and '_'. Template is parsed only once,
+// rendering is then a single pass over parsed segments.
+class QUPZILLA_EXPORT HtmlTemplate
+{
+public:
+    explicit HtmlTemplate(const QString &source = QString());
+
+    void setSource(const QString &source);
+    bool isEmpty() const;
+
+    // Placeholders without value are kept in output
+    QString render(const QHash<QString, QString> &values = QHash<QString, QString>()) const;
+
+private:
+    struct Segment {
+        QString text;
+        bool isPlaceholder;
+    };
+
+    void appendText(const QString &text);
+    void updateLength();
+
+    QVector<Segment> m_segments;
+    int m_length;
+};
+
+#endif // HTMLTEMPLATE_H
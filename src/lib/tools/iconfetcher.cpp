@@ -54,15 +54,16 @@ void IconFetcher::pageDownloaded()
     rx.setMinimal(true);
 
     QString shortcutIconTag;
-    int pos = 0;
-    while ((pos = rx.indexIn(html, pos)) != -1) {
-        QString linkTag = rx.cap(0);
-        pos += rx.matchedLength();
+    QzRegExpMatch match = rx.matchIn(html, 0, QzRegExp::DontCaptureTexts);
+    while (match.hasMatch()) {
+        const QString linkTag = match.captured();
 
         if (linkTag.contains(QLatin1String("rel=\"shortcut icon\""), Qt::CaseInsensitive)) {
             shortcutIconTag = linkTag;
             break;
         }
+
+        match = rx.matchIn(html, match.capturedEnd(), QzRegExp::DontCaptureTexts);
     }
 
     FollowRedirectReply* newReply;
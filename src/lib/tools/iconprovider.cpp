@@ -23,14 +23,149 @@
 
 #include <QTimer>
 #include <QBuffer>
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QSqlError>
+#include <QDebug>
+#include <QCryptographicHash>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrentRun>
+#else
+#include <QtConcurrentRun>
+#endif
 
 Q_GLOBAL_STATIC(IconProvider, qz_icon_provider)
 
+// Background writes of icons are serialized, so they don't insert the same data twice
+Q_GLOBAL_STATIC(QMutex, qz_icons_mutex)
+
+// Set while database still has schema of older versions, may be read from any thread
+static QAtomicInt s_legacySchema(0);
+
+static bool isLegacySchema()
+{
+#if QT_VERSION >= 0x050000
+    return s_legacySchema.load() != 0;
+#else
+    return s_legacySchema != 0;
+#endif
+}
+
+// Returns id of row in icon_data with given data, inserts new row if needed.
+// Returns -1 on error.
+static qint64 iconDataId(QSqlDatabase &db, const QByteArray &data)
+{
+    const QString hash = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+
+    QSqlQuery query(db);
+    query.prepare("SELECT id FROM icon_data WHERE hash = ?");
+    query.addBindValue(hash);
+    query.exec();
+
+    if (query.next()) {
+        return query.value(0).toLongLong();
+    }
+
+    query.prepare("INSERT INTO icon_data (hash, icon) VALUES (?,?)");
+    query.addBindValue(hash);
+    query.addBindValue(data);
+
+    if (!query.exec()) {
+        qWarning() << "IconProvider: Cannot insert icon data:" << query.lastError().text();
+        return -1;
+    }
+
+    return query.lastInsertId().toLongLong();
+}
+
+static void clearDatabase()
+{
+    QMutexLocker locker(qz_icons_mutex());
+
+    QSqlDatabase db = SqlDatabase::instance()->databaseForThread(QThread::currentThread());
+    db.exec("DELETE FROM icons");
+    db.exec("DELETE FROM icon_data");
+    db.exec("VACUUM");
+}
+
+// Icons are stored once in icon_data (keyed by hash of the data) and icons
+// only maps urls to it, so all pages of one site share single icon row.
+// Returns false on error, movedIcons is set when icons saved by older versions were moved.
+static bool migrateDatabase(QSqlDatabase &db, bool* movedIcons)
+{
+    if (!db.transaction()) {
+        qWarning() << "IconProvider: Cannot start transaction:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    bool ok = query.exec("CREATE TABLE icon_data (id INTEGER PRIMARY KEY, hash TEXT, icon BLOB)") &&
+              query.exec("CREATE UNIQUE INDEX iconDataHash ON icon_data(hash ASC)") &&
+              query.exec("ALTER TABLE icons ADD COLUMN data_id INTEGER") &&
+              query.exec("CREATE INDEX iconsDataId ON icons(data_id ASC)");
+
+    // Move icons saved by older versions to icon_data
+    QVector<QPair<qint64, QByteArray> > oldIcons;
+
+    if (ok && query.exec("SELECT id, icon FROM icons WHERE icon IS NOT NULL")) {
+        while (query.next()) {
+            oldIcons.append(qMakePair(query.value(0).toLongLong(), query.value(1).toByteArray()));
+        }
+    }
+
+    for (int i = 0; ok && i < oldIcons.size(); ++i) {
+        const qint64 dataId = iconDataId(db, oldIcons.at(i).second);
+        if (dataId < 0) {
+            ok = false;
+            break;
+        }
+
+        query.prepare("UPDATE icons SET data_id = ?, icon = NULL WHERE id = ?");
+        query.addBindValue(dataId);
+        query.addBindValue(oldIcons.at(i).first);
+        ok = query.exec();
+    }
+
+    if (!ok || !db.commit()) {
+        qWarning() << "IconProvider: Cannot update icons database:" << query.lastError().text() << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    *movedIcons = !oldIcons.isEmpty();
+    return true;
+}
+
+// Runs on worker thread, moving icons of big database takes a while
+static bool updateDatabaseSchema()
+{
+    QMutexLocker locker(qz_icons_mutex());
+
+    QSqlDatabase db = SqlDatabase::instance()->databaseForThread(QThread::currentThread());
+    bool movedIcons = false;
+
+    if (!migrateDatabase(db, &movedIcons)) {
+        return false;
+    }
+
+    // Reclaim space freed by moved icons
+    if (movedIcons) {
+        db.exec("VACUUM");
+    }
+
+    return true;
+}
+
 IconProvider::IconProvider()
     : QWidget()
 {
     m_autoSaver = new AutoSaver(this);
     connect(m_autoSaver, SIGNAL(save()), this, SLOT(saveIconsToDatabase()));
+
+    updateDatabase();
 }
 
 void IconProvider::saveIcon(WebView* view)
@@ -48,8 +183,16 @@ void IconProvider::saveIcon(WebView* view)
         return;
     }
 
-    if (m_iconBuffer.contains(item)) {
-        return;
+    // Only the last icon of each url is saved
+    for (int i = 0; i < m_iconBuffer.size(); ++i) {
+        if (m_iconBuffer.at(i).first == item.first) {
+            if (m_iconBuffer.at(i).second == item.second) {
+                return;
+            }
+
+            m_iconBuffer.remove(i);
+            break;
+        }
     }
 
     m_autoSaver->changeOcurred();
@@ -182,12 +325,15 @@ QImage IconProvider::imageForUrl(const QUrl &url)
     }
 
     QSqlQuery query;
-    query.prepare("SELECT icon FROM icons WHERE url LIKE ? LIMIT 1");
+    query.prepare(QString("SELECT %1 WHERE icons.url LIKE ? LIMIT 1").arg(iconDataSource()));
     query.addBindValue(QString("%1%").arg(QString::fromUtf8(url.toEncoded(QUrl::RemoveFragment))));
     query.exec();
 
     if (query.next()) {
-        return QImage::fromData(query.value(0).toByteArray());
+        const QImage image = QImage::fromData(query.value(0).toByteArray());
+        if (!image.isNull()) {
+            return image;
+        }
     }
 
     return IconProvider::emptyWebImage();
@@ -207,7 +353,7 @@ QImage IconProvider::imageForDomain(const QUrl &url)
     }
 
     QSqlQuery query;
-    query.prepare("SELECT icon FROM icons WHERE url LIKE ?");
+    query.prepare(QString("SELECT %1 WHERE icons.url LIKE ? LIMIT 1").arg(iconDataSource()));
     query.addBindValue(QString("%%1%").arg(url.host()));
     query.exec();
 
@@ -218,6 +364,15 @@ QImage IconProvider::imageForDomain(const QUrl &url)
     return QImage();
 }
 
+QString IconProvider::iconDataSource()
+{
+    if (isLegacySchema()) {
+        return QLatin1String("icons.icon FROM icons");
+    }
+
+    return QLatin1String("icon_data.icon FROM icons INNER JOIN icon_data ON icons.data_id = icon_data.id");
+}
+
 IconProvider* IconProvider::instance()
 {
     return qz_icon_provider();
@@ -225,39 +380,117 @@ IconProvider* IconProvider::instance()
 
 void IconProvider::saveIconsToDatabase()
 {
-    foreach (const BufferedIcon &ic, m_iconBuffer) {
-        QSqlQuery query;
-        query.prepare("SELECT id FROM icons WHERE url = ?");
-        query.bindValue(0, ic.first.toEncoded(QUrl::RemoveFragment));
+    if (m_iconBuffer.isEmpty()) {
+        return;
+    }
+
+    QtConcurrent::run(&IconProvider::writeIcons, m_iconBuffer);
+
+    m_iconBuffer.clear();
+}
+
+void IconProvider::clearIconsDatabase()
+{
+    QtConcurrent::run(&clearDatabase);
+
+    clearIconsBuffer();
+}
+
+void IconProvider::clearIconsBuffer()
+{
+    m_iconBuffer.clear();
+}
+
+void IconProvider::updateDatabase()
+{
+    if (QSqlDatabase::database().tables().contains(QLatin1String("icon_data"))) {
+        return;
+    }
+
+    // Icons are read with old schema until the database is updated.
+    // Database is opened read-only in private mode, so it is updated
+    // only with next normal session.
+    s_legacySchema.fetchAndStoreOrdered(1);
+
+    if (mApp->isPrivate()) {
+        return;
+    }
+
+    QFutureWatcher<bool>* watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, SIGNAL(finished()), this, SLOT(databaseUpdated()));
+    watcher->setFuture(QtConcurrent::run(&updateDatabaseSchema));
+}
+
+void IconProvider::databaseUpdated()
+{
+    QFutureWatcher<bool>* watcher = static_cast<QFutureWatcher<bool>*>(sender());
+
+    if (watcher->result()) {
+        s_legacySchema.fetchAndStoreOrdered(0);
+    }
+
+    watcher->deleteLater();
+}
+
+void IconProvider::writeIcons(const QVector<BufferedIcon> &icons)
+{
+    QMutexLocker locker(qz_icons_mutex());
+
+    QSqlDatabase db = SqlDatabase::instance()->databaseForThread(QThread::currentThread());
+
+    if (!db.transaction()) {
+        qWarning() << "IconProvider: Cannot start transaction:" << db.lastError().text();
+        return;
+    }
+
+    bool replaced = false;
+
+    foreach (const BufferedIcon &ic, icons) {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        ic.second.save(&buffer, "PNG");
+
+        const qint64 dataId = iconDataId(db, data);
+        if (dataId < 0) {
+            continue;
+        }
+
+        const QByteArray url = ic.first.toEncoded(QUrl::RemoveFragment);
+
+        QSqlQuery query(db);
+        query.prepare("SELECT data_id FROM icons WHERE url = ?");
+        query.addBindValue(url);
         query.exec();
 
         if (query.next()) {
-            query.prepare("UPDATE icons SET icon = ? WHERE url = ?");
+            // Icon didn't change, nothing to write
+            if (query.value(0).toLongLong() == dataId) {
+                continue;
+            }
+
+            query.prepare("UPDATE icons SET data_id = ?, icon = NULL WHERE url = ?");
+            replaced = true;
         }
         else {
-            query.prepare("INSERT INTO icons (icon, url) VALUES (?,?)");
+            query.prepare("INSERT INTO icons (data_id, url) VALUES (?,?)");
         }
 
-        QByteArray ba;
-        QBuffer buffer(&ba);
-        buffer.open(QIODevice::WriteOnly);
-        ic.second.save(&buffer, "PNG");
-        query.bindValue(0, buffer.data());
-        query.bindValue(1, ic.first.toEncoded(QUrl::RemoveFragment));
-
-        SqlDatabase::instance()->execAsync(query);
+        query.addBindValue(dataId);
+        query.addBindValue(url);
+        query.exec();
     }
 
-    m_iconBuffer.clear();
-}
-
-void IconProvider::clearIconsDatabase()
-{
-    QSqlQuery query;
-    query.exec("DELETE FROM icons");
-    query.exec("VACUUM");
+    // Remove data that is no longer used by any url (replaced icons or urls
+    // deleted together with history entries)
+    if (replaced) {
+        db.exec("DELETE FROM icon_data WHERE id NOT IN (SELECT data_id FROM icons WHERE data_id IS NOT NULL)");
+    }
 
-    m_iconBuffer.clear();
+    if (!db.commit()) {
+        qWarning() << "IconProvider: Cannot write icons:" << db.lastError().text();
+        db.rollback();
+    }
 }
 
 QIcon IconProvider::iconFromImage(const QImage &image)
@@ -61,17 +61,29 @@ public:
     static QIcon iconForDomain(const QUrl &url);
     static QImage imageForDomain(const QUrl &url);
 
+    // "column FROM tables" part of query for icon data of rows in icons table
+    static QString iconDataSource();
+
     static IconProvider* instance();
 
+    // Drops icons not yet written to database
+    void clearIconsBuffer();
+
 public slots:
     void saveIconsToDatabase();
     void clearIconsDatabase();
 
+private slots:
+    void databaseUpdated();
+
 private:
     typedef QPair<QUrl, QImage> BufferedIcon;
 
+    void updateDatabase();
     QIcon iconFromImage(const QImage &image);
 
+    static void writeIcons(const QVector<BufferedIcon> &icons);
+
     QImage m_emptyWebImage;
     QPixmap m_bookmarkIcon;
     QVector<BufferedIcon> m_iconBuffer;
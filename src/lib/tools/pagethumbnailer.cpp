@@ -22,6 +22,7 @@
 #include <QWebPage>
 #include <QWebFrame>
 #include <QPainter>
+#include <QTimer>
 
 CleanPluginFactory::CleanPluginFactory(QObject* parent)
     : QWebPluginFactory(parent)
@@ -46,8 +47,11 @@ QObject* CleanPluginFactory::create(const QString &mimeType, const QUrl &url, co
 PageThumbnailer::PageThumbnailer(QObject* parent)
     : QObject(parent)
     , m_page(new QWebPage(this))
+    , m_timeoutTimer(new QTimer(this))
     , m_size(QSize(450, 253))
     , m_loadTitle(false)
+    , m_running(false)
+    , m_loadStarted(false)
 {
     NetworkManagerProxy* networkProxy = new NetworkManagerProxy(this);
     networkProxy->setPrimaryNetworkAccessManager(mApp->networkManager());
@@ -59,6 +63,12 @@ PageThumbnailer::PageThumbnailer(QObject* parent)
     // HD Ready -,-
     // Every page should fit in this resolution
     m_page->setViewportSize(QSize(1280, 720));
+
+    m_timeoutTimer->setSingleShot(true);
+
+    connect(m_page, SIGNAL(loadStarted()), this, SLOT(loadStarted()));
+    connect(m_page, SIGNAL(loadFinished(bool)), this, SLOT(createThumbnail(bool)));
+    connect(m_timeoutTimer, SIGNAL(timeout()), this, SLOT(loadTimeout()));
 }
 
 void PageThumbnailer::setSize(const QSize &size)
@@ -107,32 +117,78 @@ void PageThumbnailer::setEnableFlash(bool enable)
     }
 }
 
+void PageThumbnailer::setTimeout(int msecs)
+{
+    m_timeoutTimer->setInterval(msecs);
+}
+
 void PageThumbnailer::start()
 {
+    m_title.clear();
+    m_running = true;
+    m_loadStarted = false;
+
+    if (m_timeoutTimer->interval() > 0) {
+        m_timeoutTimer->start();
+    }
+
     m_page->mainFrame()->load(m_url);
+}
 
-    connect(m_page, SIGNAL(loadFinished(bool)), this, SLOT(createThumbnail(bool)));
+bool PageThumbnailer::isRunning() const
+{
+    return m_running;
+}
+
+void PageThumbnailer::loadStarted()
+{
+    m_loadStarted = true;
 }
 
 void PageThumbnailer::createThumbnail(bool status)
 {
-    if (!status) {
-        emit thumbnailCreated(QPixmap());
+    // Loading was stopped after timeout, or it is late signal of previous url
+    if (!m_running || !m_loadStarted) {
+        return;
+    }
+
+    finish(status);
+}
+
+void PageThumbnailer::loadTimeout()
+{
+    if (!m_running) {
         return;
     }
 
-    m_title = m_page->mainFrame()->title().trimmed();
+    // Some resources are taking too long, use what was already loaded
+    finish(true);
+}
+
+void PageThumbnailer::finish(bool status)
+{
+    m_running = false;
+    m_timeoutTimer->stop();
+    m_page->triggerAction(QWebPage::Stop);
+
+    QPixmap thumbnail;
 
-    QPixmap pixmap(2 * m_size);
+    if (status) {
+        m_title = m_page->mainFrame()->title().trimmed();
 
-    qreal scalingFactor = 2 * static_cast<qreal>(m_size.width()) / 1280;
+        QPixmap pixmap(2 * m_size);
 
-    QPainter painter(&pixmap);
-    painter.scale(scalingFactor, scalingFactor);
-    m_page->mainFrame()->render(&painter, QWebFrame::ContentsLayer);
-    painter.end();
+        qreal scalingFactor = 2 * static_cast<qreal>(m_size.width()) / 1280;
+
+        QPainter painter(&pixmap);
+        painter.scale(scalingFactor, scalingFactor);
+        m_page->mainFrame()->render(&painter, QWebFrame::ContentsLayer);
+        painter.end();
+
+        thumbnail = pixmap.scaled(m_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
 
-    emit thumbnailCreated(pixmap.scaled(m_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    emit thumbnailCreated(thumbnail);
 }
 
 PageThumbnailer::~PageThumbnailer()
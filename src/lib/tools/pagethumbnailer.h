@@ -27,6 +27,7 @@
 
 class QWebPage;
 class QPixmap;
+class QTimer;
 
 class QUPZILLA_EXPORT CleanPluginFactory : public QWebPluginFactory
 {
@@ -56,7 +57,12 @@ public:
 
     void setEnableFlash(bool enable);
 
+    // Thumbnail of partially loaded page is created after timeout, 0 disables the timeout
+    void setTimeout(int msecs);
+
+    // Thumbnailer can be started again with different url after thumbnailCreated() was emitted
     void start();
+    bool isRunning() const;
 
 signals:
     void thumbnailCreated(const QPixmap &);
@@ -64,15 +70,22 @@ signals:
 public slots:
 
 private slots:
+    void loadStarted();
     void createThumbnail(bool status);
+    void loadTimeout();
 
 private:
+    void finish(bool status);
+
     QWebPage* m_page;
+    QTimer* m_timeoutTimer;
 
     QSize m_size;
     QUrl m_url;
     QString m_title;
     bool m_loadTitle;
+    bool m_running;
+    bool m_loadStarted;
 };
 
 #endif // PAGETHUMBNAILER_H
@@ -18,15 +18,143 @@
 #include "qzregexp.h"
 #include "qztools.h"
 
-#if (QT_VERSION >= 0x050000)
+QzRegExpMatch::QzRegExpMatch()
+#if (QT_VERSION < 0x050000)
+    : m_start(-1)
+    , m_length(-1)
+#endif
+{
+}
+
+#if (QT_VERSION < 0x050000)
+bool QzRegExpMatch::hasMatch() const
+{
+    return m_start != -1;
+}
+
+int QzRegExpMatch::capturedStart() const
+{
+    return m_start;
+}
+
+int QzRegExpMatch::capturedLength() const
+{
+    return m_length;
+}
+
+int QzRegExpMatch::capturedEnd() const
+{
+    return m_start != -1 ? m_start + m_length : -1;
+}
+
+QString QzRegExpMatch::captured(int nth) const
+{
+    if (nth == 0 && m_start != -1) {
+        return m_subject.mid(m_start, m_length);
+    }
+
+    if (!QzTools::containsIndex(m_capturedTexts, nth)) {
+        return QString();
+    }
+
+    return m_capturedTexts.at(nth);
+}
+
 QzRegExp::QzRegExp()
-    : QRegularExpression(QString(), QRegularExpression::DotMatchesEverythingOption)
+    : QRegExp()
+{
+}
+
+QzRegExp::QzRegExp(const QString &pattern, Qt::CaseSensitivity cs)
+    : QRegExp(pattern, cs)
+{
+    // Compile the expression now, so copies made when matching share it
+    isValid();
+}
+
+QzRegExp::QzRegExp(const QzRegExp &re)
+    : QRegExp(re)
+{
+}
+
+void QzRegExp::setMinimal(bool minimal)
+{
+    QRegExp::setMinimal(minimal);
+}
+
+QzRegExpMatch QzRegExp::matchIn(const QString &str, int offset, MatchOption option) const
+{
+    // QRegExp stores results of the last match, so matching is done on a copy
+    // that shares the compiled expression
+    QRegExp re(*this);
+    QzRegExpMatch m;
+
+    m.m_start = re.indexIn(str, offset);
+
+    if (m.m_start != -1) {
+        m.m_subject = str;
+        m.m_length = re.matchedLength();
+
+        if (option != DontCaptureTexts) {
+            m.m_capturedTexts = re.capturedTexts();
+        }
+    }
+
+    return m;
+}
+
+bool QzRegExp::matches(const QString &str) const
+{
+    QRegExp re(*this);
+    return re.indexIn(str) != -1;
+}
+
+#else // Qt 5
+
+static QRegularExpression::PatternOptions defaultPatternOptions()
+{
+    QRegularExpression::PatternOptions options = QRegularExpression::DotMatchesEverythingOption;
+#if (QT_VERSION < 0x050C00)
+    // Since Qt 5.12 expressions are always optimized on first usage
+    options |= QRegularExpression::OptimizeOnFirstUsageOption;
+#endif
+    return options;
+}
+
+bool QzRegExpMatch::hasMatch() const
+{
+    return m_match.hasMatch();
+}
+
+int QzRegExpMatch::capturedStart() const
+{
+    return m_match.capturedStart();
+}
+
+int QzRegExpMatch::capturedLength() const
+{
+    return m_match.hasMatch() ? m_match.capturedLength() : -1;
+}
+
+int QzRegExpMatch::capturedEnd() const
+{
+    return m_match.capturedEnd();
+}
+
+QString QzRegExpMatch::captured(int nth) const
+{
+    // QRegularExpressionMatch creates captured texts only when requested
+    return m_match.captured(nth);
+}
+
+QzRegExp::QzRegExp()
+    : QRegularExpression(QString(), defaultPatternOptions())
     , m_matchedLength(-1)
 {
 }
 
 QzRegExp::QzRegExp(const QString &pattern, Qt::CaseSensitivity cs)
-    : QRegularExpression(pattern, QRegularExpression::DotMatchesEverythingOption)
+    : QRegularExpression(pattern, defaultPatternOptions())
     , m_matchedLength(-1)
 {
     if (cs == Qt::CaseInsensitive) {
@@ -54,6 +182,20 @@ void QzRegExp::setMinimal(bool minimal)
     setPatternOptions(opt);
 }
 
+QzRegExpMatch QzRegExp::matchIn(const QString &str, int offset, MatchOption option) const
+{
+    Q_UNUSED(option)
+
+    QzRegExpMatch m;
+    m.m_match = match(str, offset);
+    return m;
+}
+
+bool QzRegExp::matches(const QString &str) const
+{
+    return match(str).hasMatch();
+}
+
 int QzRegExp::indexIn(const QString &str, int offset) const
 {
     QzRegExp* that = const_cast<QzRegExp*>(this);
@@ -84,4 +226,3 @@ QString QzRegExp::cap(int nth) const
     return m_capturedTexts.at(nth);
 }
 #endif // (QT_VERSION >= 0x050000)
-
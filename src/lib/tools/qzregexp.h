@@ -19,25 +19,70 @@
 #define QZREGEXP_H
 
 #include <QObject> // Needed for QT_VERSION
+#include <QStringList>
 
 #if (QT_VERSION < 0x050000)
-// Qt 4 - use QRegExp directly
 #include <QRegExp>
-#define QzRegExp QRegExp
-#else // Qt 5
+#else
 #include <QRegularExpression>
-#include <QStringList>
+#endif
 
 #include "qzcommon.h"
 
+class QUPZILLA_EXPORT QzRegExpMatch
+{
+public:
+    QzRegExpMatch();
+
+    bool hasMatch() const;
+
+    int capturedStart() const;
+    int capturedLength() const;
+    int capturedEnd() const;
+
+    // Captured texts are only available when matched without DontCaptureTexts option,
+    // otherwise only the whole match (nth = 0) is returned
+    QString captured(int nth = 0) const;
+
+private:
+    friend class QzRegExp;
+
+#if (QT_VERSION < 0x050000)
+    QString m_subject;
+    int m_start;
+    int m_length;
+    QStringList m_capturedTexts;
+#else
+    QRegularExpressionMatch m_match;
+#endif
+};
+
+#if (QT_VERSION < 0x050000)
+class QUPZILLA_EXPORT QzRegExp : public QRegExp
+#else
 class QUPZILLA_EXPORT QzRegExp : public QRegularExpression
+#endif
 {
 public:
+    enum MatchOption {
+        NoMatchOption = 0,
+        DontCaptureTexts = 1
+    };
+
     QzRegExp();
     QzRegExp(const QString &pattern, Qt::CaseSensitivity cs = Qt::CaseSensitive);
     QzRegExp(const QzRegExp &re);
 
     void setMinimal(bool minimal);
+
+    // Matching functions that don't modify the object and are safe to call
+    // concurrently from multiple threads on shared expression
+    QzRegExpMatch matchIn(const QString &str, int offset = 0, MatchOption option = NoMatchOption) const;
+    bool matches(const QString &str) const;
+
+#if (QT_VERSION >= 0x050000)
+    // QRegExp compatible interface, it stores the results of last match
+    // so it must not be used on expressions shared between threads
     int indexIn(const QString &str, int offset = 0) const;
     int matchedLength() const;
     QString cap(int nth = 0) const;
@@ -45,8 +90,7 @@ public:
 private:
     QStringList m_capturedTexts;
     int m_matchedLength;
-
+#endif
 };
-#endif // Qt 5
 
 #endif // QZREGEXP_H
@@ -21,6 +21,7 @@
 #include "webview.h"
 #include "webpage.h"
 #include "mainapplication.h"
+#include "networkcache.h"
 #include "downloaditem.h"
 #include "certificateinfowidget.h"
 #include "qztools.h"
@@ -29,7 +30,6 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QFileDialog>
-#include <QNetworkDiskCache>
 #include <QWebFrame>
 #include <QClipboard>
 #include <QWebSecurityOrigin>
@@ -51,6 +51,7 @@ TabBar::TabBar(BrowserWindow* window, TabWidget* tabWidget)
     , m_clickedTab(0)
     , m_normalTabWidth(0)
     , m_activeTabWidth(0)
+    , m_overflowedTabHeight(-1)
 {
     setObjectName("tabbar");
     setContextMenuPolicy(Qt::CustomContextMenu);
@@ -218,14 +219,21 @@ QSize TabBar::tabSizeHint(int index, bool fast) const
     static int MAXIMUM_TAB_WIDTH = comboTabBarPixelMetric(ComboTabBar::NormalTabMaximumWidth);
     static int MINIMUM_TAB_WIDTH = comboTabBarPixelMetric(ComboTabBar::NormalTabMinimumWidth);
 
-    QSize size = ComboTabBar::tabSizeHint(index);
-
     // The overflowed tabs have similar size and we can use this fast method
     if (fast) {
-        size.setWidth(index >= pinnedTabsCount() ? MINIMUM_TAB_WIDTH : PINNED_TAB_WIDTH);
-        return size;
+        // Height is the same for all tabs, so there is no need to ask the style
+        // (and measure tab text) for each tab again
+        if (m_overflowedTabHeight < 0) {
+            m_overflowedTabHeight = ComboTabBar::tabSizeHint(index).height();
+        }
+
+        return QSize(index >= pinnedTabsCount() ? MINIMUM_TAB_WIDTH : PINNED_TAB_WIDTH, m_overflowedTabHeight);
     }
 
+    m_overflowedTabHeight = -1;
+
+    QSize size = ComboTabBar::tabSizeHint(index);
+
     WebTab* webTab = qobject_cast<WebTab*>(m_tabWidget->widget(index));
     TabBar* tabBar = const_cast <TabBar*>(this);
 
@@ -677,6 +685,11 @@ bool TabBar::event(QEvent* event)
         hideTabPreview(false);
         break;
 
+    case QEvent::FontChange:
+    case QEvent::StyleChange:
+        m_overflowedTabHeight = -1;
+        break;
+
     default:
         break;
     }
@@ -114,6 +114,7 @@ private:
 
     mutable int m_normalTabWidth;
     mutable int m_activeTabWidth;
+    mutable int m_overflowedTabHeight;
 
     QColor m_originalTabTextColor;
     QRect m_originalGeometry;
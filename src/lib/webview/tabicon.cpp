@@ -21,29 +21,58 @@
 #include "tabbedwebview.h"
 
 #include <QTimer>
+#include <QCoreApplication>
 
 #define ANIMATION_INTERVAL 70
 
+// Animation image and timer are shared by all tab icons, so icons of all
+// loading tabs are updated (and repainted) together in one timer tick
+struct TabIconAnimation {
+    TabIconAnimation()
+        : framesCount(0)
+        , runningCount(0)
+        , timer(0)
+    {
+    }
+
+    QImage image;
+    int framesCount;
+    int runningCount;
+    QTimer* timer;
+};
+
+Q_GLOBAL_STATIC(TabIconAnimation, qz_tab_icon_animation)
+
 TabIcon::TabIcon(QWidget* parent)
     : QWidget(parent)
     , m_tab(0)
     , m_currentFrame(0)
+    , m_animationDelay(0)
     , m_animationRunning(false)
+    , m_animationTimerConnected(false)
 {
     setObjectName(QSL("tab-icon"));
 
-    m_animationImage = QImage(QSL(":icons/other/loading.png"));
-    m_framesCount = m_animationImage.width() / 16;
+    TabIconAnimation* animation = qz_tab_icon_animation();
+
+    if (!animation->timer) {
+        animation->image = QImage(QSL(":icons/other/loading.png"));
+        animation->framesCount = animation->image.width() / 16;
 
-    m_updateTimer = new QTimer(this);
-    m_updateTimer->setInterval(ANIMATION_INTERVAL);
-    connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(updateAnimationFrame()));
+        animation->timer = new QTimer(QCoreApplication::instance());
+        animation->timer->setInterval(ANIMATION_INTERVAL);
+    }
 
     resize(16, 16);
 
     setIcon(IconProvider::emptyWebIcon());
 }
 
+TabIcon::~TabIcon()
+{
+    stopAnimationTimer();
+}
+
 void TabIcon::setWebTab(WebTab* tab)
 {
     m_tab = tab;
@@ -65,19 +94,45 @@ void TabIcon::showLoadingAnimation()
 {
     m_currentFrame = 0;
 
-    // Start animation delayed with 100 ms
-    m_updateTimer->setInterval(100);
-    m_updateTimer->start();
+    // Start animation delayed with one more tick
+    m_animationDelay = 1;
+
+    if (!m_animationTimerConnected) {
+        TabIconAnimation* animation = qz_tab_icon_animation();
+
+        connect(animation->timer, SIGNAL(timeout()), this, SLOT(updateAnimationFrame()));
+        m_animationTimerConnected = true;
+
+        if (animation->runningCount++ == 0) {
+            animation->timer->start();
+        }
+    }
 }
 
 void TabIcon::hideLoadingAnimation()
 {
     m_animationRunning = false;
 
-    m_updateTimer->stop();
+    stopAnimationTimer();
     showIcon();
 }
 
+void TabIcon::stopAnimationTimer()
+{
+    if (!m_animationTimerConnected) {
+        return;
+    }
+
+    TabIconAnimation* animation = qz_tab_icon_animation();
+
+    disconnect(animation->timer, SIGNAL(timeout()), this, SLOT(updateAnimationFrame()));
+    m_animationTimerConnected = false;
+
+    if (--animation->runningCount == 0) {
+        animation->timer->stop();
+    }
+}
+
 void TabIcon::showIcon()
 {
     m_siteImage = m_tab->icon().pixmap(16).toImage();
@@ -86,13 +141,15 @@ void TabIcon::showIcon()
 
 void TabIcon::updateAnimationFrame()
 {
-    if (!m_animationRunning) {
-        m_animationRunning = true;
-        m_updateTimer->setInterval(ANIMATION_INTERVAL);
+    if (m_animationDelay > 0) {
+        --m_animationDelay;
+        return;
     }
 
+    m_animationRunning = true;
+
     update();
-    m_currentFrame = (m_currentFrame + 1) % m_framesCount;
+    m_currentFrame = (m_currentFrame + 1) % qz_tab_icon_animation()->framesCount;
 }
 
 void TabIcon::paintEvent(QPaintEvent* event)
@@ -102,7 +159,7 @@ void TabIcon::paintEvent(QPaintEvent* event)
     QPainter p(this);
 
     if (m_animationRunning) {
-        p.drawImage(0, 0, m_animationImage, m_currentFrame * 16, 0, 16, 16);
+        p.drawImage(0, 0, qz_tab_icon_animation()->image, m_currentFrame * 16, 0, 16, 16);
     }
     else {
         p.drawImage(0, 0, m_siteImage);
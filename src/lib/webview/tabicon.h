@@ -23,8 +23,6 @@
 
 #include "qzcommon.h"
 
-class QTimer;
-
 class WebTab;
 
 class QUPZILLA_EXPORT TabIcon : public QWidget
@@ -33,6 +31,7 @@ class QUPZILLA_EXPORT TabIcon : public QWidget
 
 public:
     explicit TabIcon(QWidget* parent = 0);
+    ~TabIcon();
 
     void setWebTab(WebTab* tab);
     void setIcon(const QIcon &icon);
@@ -46,15 +45,15 @@ private slots:
 
 private:
     void paintEvent(QPaintEvent* event);
+    void stopAnimationTimer();
 
     WebTab* m_tab;
-    QTimer* m_updateTimer;
 
     QImage m_siteImage;
-    QImage m_animationImage;
     int m_currentFrame;
-    int m_framesCount;
+    int m_animationDelay;
     bool m_animationRunning;
+    bool m_animationTimerConnected;
 };
 
 #endif // TABICON_H
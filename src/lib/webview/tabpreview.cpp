@@ -86,17 +86,42 @@ void TabPreview::setPreviewIndex(int index)
 
 void TabPreview::setWebTab(WebTab* webTab, bool noPixmap)
 {
+    if (m_webTab) {
+        disconnect(m_webTab.data(), SIGNAL(tabPreviewChanged()), this, SLOT(tabPreviewChanged()));
+    }
+
+    m_webTab = webTab;
+    m_title->setText(webTab->title());
+
     if (webTab->isRestored() && !webTab->isLoading() && !noPixmap) {
-        m_title->setText(webTab->title());
-        m_pixmapLabel->setPixmap(webTab->renderTabPreview());
+        connect(webTab, SIGNAL(tabPreviewChanged()), this, SLOT(tabPreviewChanged()));
+
+        // Show cached preview immediately, it is replaced once updated preview is ready
+        QPixmap preview = webTab->tabPreview();
+        if (preview.isNull()) {
+            preview = QPixmap(WebTab::tabPreviewSize());
+            preview.fill(Qt::transparent);
+        }
+
+        m_pixmapLabel->setPixmap(preview);
         m_pixmapLabel->show();
+
+        if (!webTab->isTabPreviewValid()) {
+            webTab->updateTabPreview();
+        }
     }
     else {
-        m_title->setText(webTab->title());
         m_pixmapLabel->hide();
     }
 }
 
+void TabPreview::tabPreviewChanged()
+{
+    if (m_webTab && m_pixmapLabel->isVisible()) {
+        m_pixmapLabel->setPixmap(m_webTab->tabPreview());
+    }
+}
+
 void TabPreview::setAnimationsEnabled(bool enabled)
 {
     m_animationsEnabled = enabled;
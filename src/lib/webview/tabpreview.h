@@ -21,6 +21,7 @@
 
 #include <QFrame>
 #include <QTimeLine>
+#include <QPointer>
 
 #ifdef ENABLE_OPACITY_EFFECT
 #include <QGraphicsOpacityEffect>
@@ -52,6 +53,7 @@ public slots:
 
 private slots:
     void setAnimationFrame(int frame);
+    void tabPreviewChanged();
 #ifdef ENABLE_OPACITY_EFFECT
     void setOpacity(int opacity);
 #endif
@@ -66,6 +68,7 @@ private:
     QPoint calculatePosition(const QRect &tabRect, const QSize &previewSize);
 
     BrowserWindow* m_window;
+    QPointer<WebTab> m_webTab;
     QLabel* m_pixmapLabel;
     QLabel* m_title;
 
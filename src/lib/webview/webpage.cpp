@@ -64,7 +64,8 @@
 QString WebPage::s_lastUploadLocation = QDir::homePath();
 QUrl WebPage::s_lastUnsupportedUrl;
 QTime WebPage::s_lastUnsupportedUrlTime;
-QList<WebPage*> WebPage::s_livingPages;
+quint64 WebPage::s_lastPageId = 0;
+QHash<quint64, WebPage*> WebPage::s_livingPages;
 
 WebPage::WebPage(QObject* parent)
     : QWebPage(parent)
@@ -75,6 +76,7 @@ WebPage::WebPage(QObject* parent)
     , m_blockAlerts(false)
     , m_secureStatus(false)
     , m_adjustingScheduled(false)
+    , m_pageId(++s_lastPageId)
 {
     m_javaScriptEnabled = QWebSettings::globalSettings()->testAttribute(QWebSettings::JavascriptEnabled);
 
@@ -112,7 +114,7 @@ WebPage::WebPage(QObject* parent)
             this, SLOT(appCacheQuotaExceeded(QWebSecurityOrigin*,quint64)));
 #endif
 
-    s_livingPages.append(this);
+    s_livingPages.insert(m_pageId, this);
 }
 
 WebPage::~WebPage()
@@ -124,7 +126,7 @@ WebPage::~WebPage()
         m_runningLoop = 0;
     }
 
-    s_livingPages.removeOne(this);
+    s_livingPages.remove(m_pageId);
 
     // Page's network manager will be deleted and then set to null
     // Fixes issue with network manager being used after deleted in destructor
@@ -563,10 +565,7 @@ bool WebPage::acceptNavigationRequest(QWebFrame* frame, const QNetworkRequest &r
 
 void WebPage::populateNetworkRequest(QNetworkRequest &request)
 {
-    WebPage* pagePointer = this;
-
-    QVariant variant = QVariant::fromValue((void*) pagePointer);
-    request.setAttribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100), variant);
+    request.setAttribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100), QVariant(m_pageId));
 
     if (m_lastRequestUrl == request.url()) {
         request.setAttribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 101), m_lastRequestType);
@@ -1051,11 +1050,17 @@ QString WebPage::chooseFile(QWebFrame* originatingFrame, const QString &oldFile)
     return fileName;
 }
 
-bool WebPage::isPointerSafeToUse(WebPage* page)
+quint64 WebPage::pageId() const
+{
+    return m_pageId;
+}
+
+WebPage* WebPage::fromRequest(const QNetworkRequest &request)
 {
-    // Pointer to WebPage is passed with every QNetworkRequest casted to void*
-    // So there is no way to test whether pointer is still valid or not, except
-    // this hack.
+    // Id of page is passed with every QNetworkRequest instead of pointer.
+    // Ids are never reused, so request of already deleted page can't
+    // be matched to another page that was created later at the same address.
+    const quint64 id = request.attribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100)).toULongLong();
 
-    return page == 0 ? false : s_livingPages.contains(page);
+    return id == 0 ? 0 : s_livingPages.value(id);
 }
@@ -21,6 +21,7 @@
 #include <QWebPage>
 #include <QSslCertificate>
 #include <QVector>
+#include <QHash>
 
 #include "qzcommon.h"
 #include "passwordmanager.h"
@@ -83,7 +84,10 @@ public:
     QWebElement activeElement() const;
     QString userAgentForUrl(const QUrl &url) const;
 
-    static bool isPointerSafeToUse(WebPage* page);
+    quint64 pageId() const;
+
+    // Returns page that created the request or 0 if it was already deleted
+    static WebPage* fromRequest(const QNetworkRequest &request);
 
 signals:
     void privacyChanged(bool status);
@@ -128,7 +132,8 @@ private:
     static QString s_lastUploadLocation;
     static QUrl s_lastUnsupportedUrl;
     static QTime s_lastUnsupportedUrlTime;
-    static QList<WebPage*> s_livingPages;
+    static quint64 s_lastPageId;
+    static QHash<quint64, WebPage*> s_livingPages;
 
     NetworkManagerProxy* m_networkProxy;
     TabbedWebView* m_view;
@@ -148,6 +153,8 @@ private:
     bool m_secureStatus;
     bool m_javaScriptEnabled;
     bool m_adjustingScheduled;
+
+    quint64 m_pageId;
 };
 
 #endif // WEBPAGE_H
@@ -32,8 +32,23 @@
 #include <QWebFrame>
 #include <QLabel>
 #include <QTimer>
+#include <QPainter>
+#include <QFutureWatcher>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrentRun>
+#else
+#include <QtConcurrentRun>
+#endif
 
 static const int savedTabVersion = 1;
+static const int tabPreviewWidth = 230;
+static const int tabPreviewHeight = 150;
+
+static QImage scaleTabPreview(const QImage &image)
+{
+    return image.scaled(tabPreviewWidth, tabPreviewHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
 
 WebTab::SavedTab::SavedTab(WebTab* webTab)
 {
@@ -89,6 +104,10 @@ WebTab::WebTab(BrowserWindow* window)
     , m_tabBar(window->tabWidget()->getTabBar())
     , m_isPinned(false)
     , m_inspectorVisible(false)
+    , m_tabPreviewScaling(0)
+    , m_tabPreviewGeneration(0)
+    , m_renderedPreviewGeneration(-1)
+    , m_scaledPreviewGeneration(-1)
 {
     setObjectName("webtab");
 
@@ -114,6 +133,12 @@ WebTab::WebTab(BrowserWindow* window)
     setLayout(m_layout);
 
     connect(m_webView, SIGNAL(showNotification(QWidget*)), this, SLOT(showNotification(QWidget*)));
+
+    // Cached tab preview is outdated after page was loaded, repainted or resized
+    // (QWebPage::scrollRequested and repaintRequested are not emitted for pages shown in view)
+    connect(m_webView, SIGNAL(loadFinished(bool)), this, SLOT(invalidateTabPreview()));
+    connect(page->mainFrame(), SIGNAL(contentsSizeChanged(QSize)), this, SLOT(invalidateTabPreview()));
+    m_webView->installEventFilter(this);
 }
 
 TabbedWebView* WebTab::webView() const
@@ -301,42 +326,96 @@ void WebTab::p_restoreTab(const WebTab::SavedTab &tab)
     p_restoreTab(tab.url, tab.history);
 }
 
-QPixmap WebTab::renderTabPreview()
+QSize WebTab::tabPreviewSize()
 {
-    TabbedWebView* currentWebView = m_window->weView();
-    WebPage* page = m_webView->page();
-    const QSize oldSize = page->viewportSize();
-    const QPoint originalScrollPosition = page->mainFrame()->scrollPosition();
+    return QSize(tabPreviewWidth, tabPreviewHeight);
+}
 
-    // Hack to ensure rendering the same preview before and after the page was shown for the first time
-    // This can occur eg. with opening background tabs
-    if (currentWebView) {
-        page->setViewportSize(currentWebView->size());
+QPixmap WebTab::tabPreview() const
+{
+    return m_tabPreview;
+}
+
+bool WebTab::isTabPreviewValid() const
+{
+    return !m_tabPreview.isNull() && m_scaledPreviewGeneration == m_tabPreviewGeneration;
+}
+
+void WebTab::updateTabPreview()
+{
+    // Preview is already being scaled
+    if (m_tabPreviewScaling && m_tabPreviewScaling->isRunning()) {
+        return;
     }
 
-    const int previewWidth = 230;
-    const int previewHeight = 150;
-    const int scrollBarExtent = style()->pixelMetric(QStyle::PM_ScrollBarExtent);
-    const int pageWidth = qMin(page->mainFrame()->contentsSize().width(), 1280);
-    const int pageHeight = (pageWidth / 23 * 15);
-    const qreal scalingFactor = 2 * static_cast<qreal>(previewWidth) / pageWidth;
+    WebPage* page = m_webView->page();
+    const QSize oldSize = page->viewportSize();
+    QSize viewportSize = oldSize;
+
+    // Background tabs that were not yet shown don't have viewport size,
+    // so use size of current tab to render the same preview as after they are shown
+    if (viewportSize.isEmpty()) {
+        TabbedWebView* currentWebView = m_window->weView();
+        viewportSize = currentWebView ? currentWebView->size() : size();
+        page->setViewportSize(viewportSize);
+    }
 
-    page->setViewportSize(QSize(pageWidth, pageHeight));
+    // Only the visible part of page without scrollbar is rendered, so the viewport
+    // doesn't need to be resized which would force relayout of the page
+    const int scrollBarWidth = page->mainFrame()->scrollBarGeometry(Qt::Vertical).width();
+    const int pageWidth = qMax(1, qMin(viewportSize.width() - scrollBarWidth, 1280));
+    const int pageHeight = pageWidth * tabPreviewHeight / tabPreviewWidth;
+    const qreal scalingFactor = 2 * static_cast<qreal>(tabPreviewWidth) / pageWidth;
 
-    QPixmap pageImage((2 * previewWidth) - scrollBarExtent, (2 * previewHeight) - scrollBarExtent);
+    QImage pageImage(2 * tabPreviewWidth, 2 * tabPreviewHeight, QImage::Format_ARGB32_Premultiplied);
     pageImage.fill(Qt::transparent);
 
     QPainter p(&pageImage);
     p.scale(scalingFactor, scalingFactor);
-    m_webView->page()->mainFrame()->render(&p, QWebFrame::ContentsLayer);
+    page->mainFrame()->render(&p, QWebFrame::ContentsLayer, QRegion(0, 0, pageWidth, pageHeight));
     p.end();
 
-    page->setViewportSize(oldSize);
-    // Restore also scrollbar positions, to prevent messing scrolling to anchor links
-    page->mainFrame()->setScrollBarValue(Qt::Vertical, originalScrollPosition.y());
-    page->mainFrame()->setScrollBarValue(Qt::Horizontal, originalScrollPosition.x());
+    if (viewportSize != oldSize) {
+        page->setViewportSize(oldSize);
+    }
+
+    if (!m_tabPreviewScaling) {
+        m_tabPreviewScaling = new QFutureWatcher<QImage>(this);
+        connect(m_tabPreviewScaling, SIGNAL(finished()), this, SLOT(tabPreviewScaled()));
+    }
+
+    m_renderedPreviewGeneration = m_tabPreviewGeneration;
+    m_tabPreviewScaling->setFuture(QtConcurrent::run(scaleTabPreview, pageImage));
+}
+
+void WebTab::invalidateTabPreview()
+{
+    ++m_tabPreviewGeneration;
+}
+
+void WebTab::tabPreviewScaled()
+{
+    m_tabPreview = QPixmap::fromImage(m_tabPreviewScaling->result());
+    m_scaledPreviewGeneration = m_renderedPreviewGeneration;
+
+    emit tabPreviewChanged();
+}
+
+bool WebTab::eventFilter(QObject* obj, QEvent* event)
+{
+    // Scrolling and any other change of page content repaints the view
+    if (obj == m_webView && event->type() == QEvent::Paint) {
+        invalidateTabPreview();
+    }
+
+    return QWidget::eventFilter(obj, event);
+}
+
+void WebTab::resizeEvent(QResizeEvent* event)
+{
+    invalidateTabPreview();
 
-    return pageImage.scaled(previewWidth, previewHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    QWidget::resizeEvent(event);
 }
 
 void WebTab::showNotification(QWidget* notif)
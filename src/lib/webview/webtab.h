@@ -21,12 +21,17 @@
 #include <QWidget>
 #include <QIcon>
 #include <QUrl>
+#include <QImage>
+#include <QPixmap>
 
 #include "qzcommon.h"
 
 class QVBoxLayout;
 class QWebHistory;
 
+template<typename T>
+class QFutureWatcher;
+
 class BrowserWindow;
 class LocationBar;
 class TabbedWebView;
@@ -92,12 +97,28 @@ public:
     void p_restoreTab(const SavedTab &tab);
     void p_restoreTab(const QUrl &url, const QByteArray &history);
 
-    QPixmap renderTabPreview();
+    static QSize tabPreviewSize();
+
+    // Last rendered preview, it may be null or outdated (see isTabPreviewValid)
+    QPixmap tabPreview() const;
+    bool isTabPreviewValid() const;
+    // Renders new preview, tabPreviewChanged() is emitted when it is ready
+    void updateTabPreview();
+
+signals:
+    void tabPreviewChanged();
 
 private slots:
     void showNotification(QWidget* notif);
     void slotRestore();
 
+    void invalidateTabPreview();
+    void tabPreviewScaled();
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event);
+    void resizeEvent(QResizeEvent* event);
+
 private:
     BrowserWindow* m_window;
     TabbedWebView* m_webView;
@@ -109,6 +130,12 @@ private:
     SavedTab m_savedTab;
     bool m_isPinned;
     bool m_inspectorVisible;
+
+    QPixmap m_tabPreview;
+    QFutureWatcher<QImage>* m_tabPreviewScaling;
+    int m_tabPreviewGeneration;
+    int m_renderedPreviewGeneration;
+    int m_scaledPreviewGeneration;
 };
 
 #endif // WEBTAB_H
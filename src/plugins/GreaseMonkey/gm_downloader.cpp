@@ -38,10 +38,8 @@ GM_Downloader::GM_Downloader(const QNetworkRequest &request, GM_Manager* manager
     m_reply = new FollowRedirectReply(request.url(), mApp->networkManager());
     connect(m_reply, SIGNAL(finished()), this, SLOT(scriptDownloaded()));
 
-    QVariant v = request.attribute((QNetworkRequest::Attribute)(QNetworkRequest::User + 100));
-    WebPage* webPage = static_cast<WebPage*>(v.value<void*>());
-
-    if (WebPage::isPointerSafeToUse(webPage)) {
+    WebPage* webPage = WebPage::fromRequest(request);
+    if (webPage) {
         m_widget = webPage->view();
     }
 }
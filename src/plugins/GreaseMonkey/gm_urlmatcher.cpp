@@ -71,7 +71,7 @@ QString GM_UrlMatcher::pattern() const
 bool GM_UrlMatcher::match(const QString &urlString) const
 {
     if (m_useRegExp) {
-        return m_regExp.indexIn(urlString) != -1;
+        return m_regExp.matches(urlString);
     }
     else {
         return wildcardMatch(urlString, m_matchString);
@@ -67,7 +67,15 @@ HEADERS += \
     updatertest.h \
     pactest.h \
     passwordbackendtest.h \
-    networktest.h
+    networktest.h \
+    networkcachetest.h \
+    requestinfotest.h \
+    proxytest.h \
+    bookmarkstest.h \
+    htmltemplatetest.h \
+    combotabbartest.h \
+    qzregexptest.h \
+    opensearchtest.h
 
 SOURCES += \
     qztoolstest.cpp \
@@ -79,4 +87,12 @@ SOURCES += \
     updatertest.cpp \
     pactest.cpp \
     passwordbackendtest.cpp \
-    networktest.cpp
+    networktest.cpp \
+    networkcachetest.cpp \
+    requestinfotest.cpp \
+    proxytest.cpp \
+    bookmarkstest.cpp \
+    htmltemplatetest.cpp \
+    combotabbartest.cpp \
+    qzregexptest.cpp \
+    opensearchtest.cpp
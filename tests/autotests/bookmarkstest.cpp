@@ -0,0 +1,146 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "bookmarkstest.h"
+#include "bookmarks.h"
+#include "bookmarkitem.h"
+#include "datapaths.h"
+#include "settings.h"
+
+#include <QtTest/QtTest>
+#include <QDir>
+
+static BookmarkItem* createBookmark(const QString &url, const QString &title, const QString &keyword = QString())
+{
+    BookmarkItem* item = new BookmarkItem(BookmarkItem::Url);
+    item->setUrl(QUrl(url));
+    item->setTitle(title);
+    item->setKeyword(keyword);
+    return item;
+}
+
+void BookmarksTest::initTestCase()
+{
+    DataPaths::setCurrentProfilePath(QDir::tempPath() + "qz-test");
+    Settings::createSettings(QDir::tempPath() + "qz-test/settings.ini");
+}
+
+void BookmarksTest::init()
+{
+    m_bookmarks = new Bookmarks;
+}
+
+void BookmarksTest::cleanup()
+{
+    delete m_bookmarks;
+
+    // Start every test with default bookmarks
+    QFile::remove(DataPaths::currentProfilePath() + QLatin1String("/bookmarks.json"));
+}
+
+void BookmarksTest::urlIndexTest()
+{
+    const QUrl url("http://qz-test.example.com/index.html");
+    QVERIFY(!m_bookmarks->isBookmarked(url));
+
+    BookmarkItem* item1 = createBookmark(url.toString(), "Test page");
+    BookmarkItem* item2 = createBookmark(url.toString(), "Same page");
+    m_bookmarks->addBookmark(m_bookmarks->unsortedFolder(), item1);
+    m_bookmarks->addBookmark(m_bookmarks->menuFolder(), item2);
+
+    QVERIFY(m_bookmarks->isBookmarked(url));
+    QVERIFY(m_bookmarks->snapshot()->isBookmarked(url));
+    QCOMPARE(m_bookmarks->searchBookmarks(url).count(), 2);
+
+    m_bookmarks->removeBookmark(item1);
+    QVERIFY(m_bookmarks->isBookmarked(url));
+    QCOMPARE(m_bookmarks->searchBookmarks(url), QList<BookmarkItem*>() << item2);
+
+    m_bookmarks->removeBookmark(item2);
+    QVERIFY(!m_bookmarks->isBookmarked(url));
+    QVERIFY(!m_bookmarks->snapshot()->isBookmarked(url));
+
+    delete item1;
+    delete item2;
+}
+
+void BookmarksTest::changeBookmarkTest()
+{
+    const QUrl oldUrl("http://qz-test.example.com/old");
+    const QUrl newUrl("http://qz-test.example.com/new");
+
+    BookmarkItem* item = createBookmark(oldUrl.toString(), "Original title");
+    m_bookmarks->addBookmark(m_bookmarks->unsortedFolder(), item);
+
+    item->setUrl(newUrl);
+    item->setTitle("Renamed qzchanged");
+    m_bookmarks->changeBookmark(item);
+
+    QVERIFY(!m_bookmarks->isBookmarked(oldUrl));
+    QVERIFY(m_bookmarks->isBookmarked(newUrl));
+    QCOMPARE(m_bookmarks->searchBookmarks("qzchanged"), QList<BookmarkItem*>() << item);
+    QVERIFY(m_bookmarks->searchBookmarks("Original title").isEmpty());
+}
+
+void BookmarksTest::removeFolderTest()
+{
+    const QUrl url("http://qz-test.example.com/in-folder");
+
+    BookmarkItem* folder = new BookmarkItem(BookmarkItem::Folder);
+    folder->setTitle("Folder");
+    folder->addChild(createBookmark(url.toString(), "In folder"));
+    m_bookmarks->addBookmark(m_bookmarks->unsortedFolder(), folder);
+
+    QVERIFY(m_bookmarks->isBookmarked(url));
+
+    m_bookmarks->removeBookmark(folder);
+    QVERIFY(!m_bookmarks->isBookmarked(url));
+
+    delete folder;
+}
+
+void BookmarksTest::snapshotSearchTest()
+{
+    BookmarkItem* item1 = createBookmark("http://qz-test.example.com/1", "Xyzzy documentation");
+    BookmarkItem* item2 = createBookmark("http://qz-test.example.com/xyzzy", "Something else");
+    BookmarkItem* item3 = createBookmark("http://qz-test.example.com/3", "Another page", "xyz");
+    m_bookmarks->addBookmark(m_bookmarks->unsortedFolder(), item1);
+    m_bookmarks->addBookmark(m_bookmarks->unsortedFolder(), item2);
+    m_bookmarks->addBookmark(m_bookmarks->unsortedFolder(), item3);
+
+    QSharedPointer<const BookmarksSnapshot> snapshot = m_bookmarks->snapshot();
+
+    // Title word match comes before url match
+    QVector<BookmarksSnapshot::Entry> entries = snapshot->search("xyzzy");
+    QCOMPARE(entries.count(), 2);
+    QCOMPARE(entries.at(0).item, item1);
+    QCOMPARE(entries.at(1).item, item2);
+
+    // Keyword must match exactly
+    entries = snapshot->search("XYZ");
+    QCOMPARE(entries.count(), 3);
+    QCOMPARE(snapshot->search("xyz", 1).count(), 1);
+    QCOMPARE(snapshot->search("xyz", -1, Qt::CaseSensitive).count(), 2);
+    QVERIFY(snapshot->search("XYZ", -1, Qt::CaseSensitive).isEmpty());
+
+    // Snapshot is immutable
+    m_bookmarks->removeBookmark(item1);
+    QCOMPARE(snapshot->search("xyzzy").count(), 2);
+    QCOMPARE(m_bookmarks->snapshot()->search("xyzzy").count(), 1);
+
+    delete item1;
+}
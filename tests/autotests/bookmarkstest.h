@@ -0,0 +1,44 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef BOOKMARKSTEST_H
+#define BOOKMARKSTEST_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class Bookmarks;
+
+class BookmarksTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void urlIndexTest();
+    void changeBookmarkTest();
+    void removeFolderTest();
+    void snapshotSearchTest();
+
+private:
+    Bookmarks* m_bookmarks;
+};
+
+#endif // BOOKMARKSTEST_H
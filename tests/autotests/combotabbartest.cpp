@@ -0,0 +1,150 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "combotabbartest.h"
+#include "combotabbar.h"
+
+#include <QtTest/QtTest>
+#include <QPixmap>
+
+static void addTabsData()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("1500") << 1500;
+}
+
+void ComboTabBarTest::openCloseTabs_data()
+{
+    addTabsData();
+}
+
+void ComboTabBarTest::openCloseTabs()
+{
+    QFETCH(int, count);
+
+    ComboTabBar tabBar;
+    tabBar.setTabsClosable(true);
+    tabBar.resize(800, 30);
+    tabBar.show();
+
+    QBENCHMARK {
+        for (int i = 0; i < count; ++i) {
+            tabBar.addTab(QString("Tab %1").arg(i));
+        }
+
+        while (tabBar.count() > 0) {
+            tabBar.removeTab(tabBar.count() - 1);
+        }
+    }
+
+    QCOMPARE(tabBar.count(), 0);
+}
+
+void ComboTabBarTest::paintTabs_data()
+{
+    addTabsData();
+}
+
+void ComboTabBarTest::paintTabs()
+{
+    QFETCH(int, count);
+
+    ComboTabBar tabBar;
+    tabBar.setTabsClosable(true);
+    tabBar.resize(800, 30);
+    tabBar.show();
+
+    for (int i = 0; i < count; ++i) {
+        tabBar.addTab(QString("Tab %1").arg(i));
+    }
+
+    tabBar.setCurrentIndex(count / 2);
+    tabBar.ensureVisible(count / 2);
+
+    QCOMPARE(tabBar.count(), count);
+
+    // Time of painting one frame of the tabbar
+    QPixmap frame(tabBar.size());
+
+    QBENCHMARK {
+        tabBar.render(&frame);
+    }
+}
+
+void ComboTabBarTest::visibleTabsRange_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("current");
+
+    QTest::newRow("NotOverflowed") << 3 << 1;
+    QTest::newRow("First") << 200 << 0;
+    QTest::newRow("Middle") << 200 << 100;
+    QTest::newRow("Last") << 200 << 199;
+}
+
+void ComboTabBarTest::visibleTabsRange()
+{
+    QFETCH(int, count);
+    QFETCH(int, current);
+
+    ComboTabBar tabBar;
+    tabBar.setTabsClosable(true);
+    tabBar.resize(800, 30);
+    tabBar.show();
+
+    for (int i = 0; i < count; ++i) {
+        // Titles of different length, so the range doesn't depend on equal widths
+        tabBar.addTab(QString("Tab %1").arg(QString(i % 7, QLatin1Char('x'))));
+    }
+
+    tabBar.setCurrentIndex(current);
+    tabBar.ensureVisible(current);
+    QTest::qWait(500);
+
+    TabBarHelper* helper = 0;
+    foreach (TabBarHelper* h, tabBar.findChildren<TabBarHelper*>()) {
+        if (h->count() == count) {
+            helper = h;
+        }
+    }
+    QVERIFY(helper);
+
+    // Same test as painting uses for every tab
+    int expectedFirst = -1;
+    int expectedLast = -1;
+    for (int i = 0; i < helper->count(); ++i) {
+        const QRect rect = helper->tabRect(i);
+        if (helper->isDisplayedOnViewPort(helper->mapToGlobal(rect.topLeft()).x(), helper->mapToGlobal(rect.topRight()).x())) {
+            if (expectedFirst == -1) {
+                expectedFirst = i;
+            }
+            expectedLast = i;
+        }
+    }
+
+    int first;
+    int last;
+    helper->visibleTabsRange(first, last);
+
+    QVERIFY(expectedFirst != -1);
+    QCOMPARE(first, expectedFirst);
+    QCOMPARE(last, expectedLast);
+    QVERIFY(first <= current && current <= last);
+}
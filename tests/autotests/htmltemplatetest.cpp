@@ -0,0 +1,56 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "htmltemplatetest.h"
+#include "htmltemplate.h"
+
+#include <QtTest/QtTest>
+
+void HtmlTemplateTest::render_data()
+{
+    QTest::addColumn<QString>("source");
+    QTest::addColumn<QString>("result");
+
+    QTest::newRow("Empty") << "" << "";
+    QTest::newRow("NoPlaceholder") << "<b>Lorem ipsum</b>" << "<b>Lorem ipsum</b>";
+    QTest::newRow("Placeholder") << "<title>%TITLE%</title>" << "<title>Title</title>";
+    QTest::newRow("OnlyPlaceholder") << "%TITLE%" << "Title";
+    QTest::newRow("Adjacent") << "%TITLE%%SD-SIZE%" << "Title231";
+    QTest::newRow("Repeated") << "%TITLE% %TITLE%" << "Title Title";
+    QTest::newRow("Unknown") << "%TITLE% %UNKNOWN%" << "Title %UNKNOWN%";
+    QTest::newRow("Percent") << "width: 100%; %IMG_PLUS%" << "width: 100%; qrc:plus.png";
+    QTest::newRow("DoublePercent") << "50%%TITLE%" << "50%Title";
+    QTest::newRow("LowerCase") << "%title% %TITLE%" << "%title% Title";
+    QTest::newRow("Unterminated") << "%TITLE% 100%TITLE" << "Title 100%TITLE";
+    QTest::newRow("EmptyName") << "%%" << "%%";
+    QTest::newRow("ValueWithPlaceholder") << "%VALUE% %TITLE%" << "%TITLE% Title";
+}
+
+void HtmlTemplateTest::render()
+{
+    QFETCH(QString, source);
+    QFETCH(QString, result);
+
+    QHash<QString, QString> values;
+    values["TITLE"] = "Title";
+    values["SD-SIZE"] = "231";
+    values["IMG_PLUS"] = "qrc:plus.png";
+    values["VALUE"] = "%TITLE%";
+
+    HtmlTemplate t(source);
+    QCOMPARE(t.render(values), result);
+}
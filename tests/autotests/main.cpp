@@ -24,6 +24,14 @@
 #include "pactest.h"
 #include "passwordbackendtest.h"
 #include "networktest.h"
+#include "networkcachetest.h"
+#include "requestinfotest.h"
+#include "proxytest.h"
+#include "opensearchtest.h"
+#include "bookmarkstest.h"
+#include "htmltemplatetest.h"
+#include "combotabbartest.h"
+#include "qzregexptest.h"
 
 #include <QtTest/QtTest>
 
@@ -48,6 +56,14 @@ int main(int argc, char *argv[])
     RUN_TEST(UpdaterTest)
     RUN_TEST(PacTest)
     RUN_TEST(NetworkTest)
+    RUN_TEST(NetworkCacheTest)
+    RUN_TEST(RequestInfoTest)
+    RUN_TEST(ProxyTest)
+    RUN_TEST(OpenSearchTest)
+    RUN_TEST(BookmarksTest)
+    RUN_TEST(HtmlTemplateTest)
+    RUN_TEST(ComboTabBarTest)
+    RUN_TEST(QzRegExpTest)
 
     RUN_TEST(DatabasePasswordBackendTest)
     RUN_TEST(DatabaseEncryptedPasswordBackendTest)
@@ -0,0 +1,185 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "networkcachetest.h"
+#include "networkcache.h"
+#include "qztools.h"
+
+#include <QtTest/QtTest>
+#include <QDateTime>
+
+void NetworkCacheTest::init()
+{
+    m_path = QDir::tempPath() + QString("/qupzilla-networkcachetest-%1/").arg(QDateTime::currentMSecsSinceEpoch());
+}
+
+void NetworkCacheTest::cleanup()
+{
+    QzTools::removeDir(m_path);
+}
+
+bool NetworkCacheTest::insertItem(NetworkCache* cache, const QUrl &url, const QByteArray &data)
+{
+    QNetworkCacheMetaData::RawHeaderList headers;
+    headers.append(qMakePair(QByteArray("Content-Length"), QByteArray::number(data.size())));
+
+    QNetworkCacheMetaData metaData;
+    metaData.setUrl(url);
+    metaData.setRawHeaders(headers);
+
+    QIODevice* device = cache->prepare(metaData);
+    if (!device) {
+        return false;
+    }
+
+    device->write(data);
+    cache->insert(device);
+    return true;
+}
+
+void NetworkCacheTest::insertAndReadTest()
+{
+    NetworkCache cache;
+    cache.setCacheDirectory(m_path);
+
+    const QUrl smallUrl("http://example.com/small.png");
+    const QUrl bigUrl("http://example.com/big.js");
+    const QByteArray smallData(100, 'a');
+    const QByteArray bigData(100 * 1024, 'b');
+
+    QVERIFY(insertItem(&cache, smallUrl, smallData));
+    QVERIFY(insertItem(&cache, bigUrl, bigData));
+
+    QCOMPARE(cache.metaData(smallUrl).url(), smallUrl);
+    QCOMPARE(cache.metaData(bigUrl).url(), bigUrl);
+
+    QIODevice* device = cache.data(smallUrl);
+    QVERIFY(device);
+    QCOMPARE(device->readAll(), smallData);
+    delete device;
+
+    // Big entries are not loaded into memory
+    device = cache.data(bigUrl);
+    QVERIFY(qobject_cast<QFile*>(device));
+    QCOMPARE(device->readAll(), bigData);
+    delete device;
+
+    const NetworkCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.entries, 2);
+    QCOMPARE(stats.hits, qint64(2));
+    QCOMPARE(stats.memoryHits, qint64(1));
+    QCOMPARE(stats.memoryEntries, 1);
+    QCOMPARE(stats.bytesRead, qint64(smallData.size() + bigData.size()));
+    QVERIFY(cache.cacheSize() > smallData.size() + bigData.size());
+
+    QVERIFY(cache.remove(bigUrl));
+    QVERIFY(!cache.data(bigUrl));
+    QCOMPARE(cache.statistics().entries, 1);
+}
+
+void NetworkCacheTest::missingEntryTest()
+{
+    NetworkCache cache;
+    cache.setCacheDirectory(m_path);
+
+    const QUrl url("http://example.com/missing.css");
+
+    QVERIFY(!cache.metaData(url).isValid());
+    QVERIFY(!cache.data(url));
+    QVERIFY(!cache.remove(url));
+
+    // Lookup of missing entry is counted only once
+    QCOMPARE(cache.statistics().misses, qint64(1));
+    QCOMPARE(cache.statistics().hits, qint64(0));
+}
+
+void NetworkCacheTest::persistentIndexTest()
+{
+    const QUrl url("http://example.com/image.jpg");
+    const QByteArray data(50 * 1024, 'c');
+    qint64 size;
+
+    {
+        NetworkCache cache;
+        cache.setCacheDirectory(m_path);
+        QVERIFY(insertItem(&cache, url, data));
+        size = cache.cacheSize();
+    }
+
+    QVERIFY(QFile::exists(m_path + QLatin1String("index")));
+
+    NetworkCache cache;
+    cache.setCacheDirectory(m_path);
+    QCOMPARE(cache.cacheSize(), size);
+    QCOMPARE(cache.statistics().entries, 1);
+
+    QIODevice* device = cache.data(url);
+    QVERIFY(device);
+    QCOMPARE(device->readAll(), data);
+    delete device;
+
+    // Index is rebuilt from entries when index file is missing
+    cache.clear();
+    QVERIFY(insertItem(&cache, url, data));
+    QFile::remove(m_path + QLatin1String("index"));
+
+    NetworkCache rebuiltCache;
+    rebuiltCache.setCacheDirectory(m_path);
+    QCOMPARE(rebuiltCache.cacheSize(), size);
+    QVERIFY(rebuiltCache.metaData(url).isValid());
+}
+
+void NetworkCacheTest::lruEvictionTest()
+{
+    NetworkCache cache;
+    cache.setCacheDirectory(m_path);
+    cache.setMaximumCacheSize(200 * 1024);
+
+    const QByteArray data(40 * 1024, 'd');
+
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(insertItem(&cache, QUrl(QString("http://example.com/%1").arg(i)), data));
+    }
+
+    // Access makes first entry the most recently used one
+    QVERIFY(cache.metaData(QUrl("http://example.com/0")).isValid());
+
+    QVERIFY(insertItem(&cache, QUrl("http://example.com/4"), data));
+    QVERIFY(insertItem(&cache, QUrl("http://example.com/5"), data));
+
+    QVERIFY(cache.cacheSize() <= cache.maximumCacheSize());
+    QVERIFY(cache.statistics().evictions > 0);
+    QVERIFY(cache.metaData(QUrl("http://example.com/0")).isValid());
+    QVERIFY(!cache.metaData(QUrl("http://example.com/1")).isValid());
+    QVERIFY(cache.metaData(QUrl("http://example.com/5")).isValid());
+}
+
+void NetworkCacheTest::legacyFilesTest()
+{
+    QDir().mkpath(m_path + QLatin1String("data8/0"));
+
+    QFile file(m_path + QLatin1String("data8/0/legacy.d"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(1024, 'e'));
+    file.close();
+
+    NetworkCache cache;
+    cache.setCacheDirectory(m_path);
+
+    QVERIFY(!QFile::exists(m_path + QLatin1String("data8")));
+    QCOMPARE(cache.cacheSize(), qint64(0));
+}
@@ -0,0 +1,46 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef NETWORKCACHETEST_H
+#define NETWORKCACHETEST_H
+
+#include <QObject>
+#include <QUrl>
+
+class NetworkCache;
+
+class NetworkCacheTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void insertAndReadTest();
+    void missingEntryTest();
+    void persistentIndexTest();
+    void lruEvictionTest();
+    void legacyFilesTest();
+
+private:
+    bool insertItem(NetworkCache* cache, const QUrl &url, const QByteArray &data);
+
+    QString m_path;
+};
+
+#endif // NETWORKCACHETEST_H
@@ -0,0 +1,247 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "opensearchtest.h"
+#include "opensearchengine.h"
+
+#include <QtTest/QtTest>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QTcpSocket>
+#include <QEventLoop>
+
+static QStringList s_words = QStringList() << "qupzilla" << "qupzilla browser" << "quick"
+                                           << "quiet" << "query" << "quest";
+
+SuggestionsServer::SuggestionsServer(QObject* parent)
+    : QTcpServer(parent)
+{
+    connect(this, SIGNAL(newConnection()), this, SLOT(newClient()));
+}
+
+QStringList SuggestionsServer::requests() const
+{
+    return m_requests;
+}
+
+void SuggestionsServer::clearRequests()
+{
+    m_requests.clear();
+}
+
+void SuggestionsServer::newClient()
+{
+    while (QTcpSocket* socket = nextPendingConnection()) {
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+void SuggestionsServer::readRequest()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket || !socket->canReadLine()) {
+        return;
+    }
+
+    // GET /suggest?q=term HTTP/1.1
+    const QByteArray line = socket->readLine();
+    const int start = line.indexOf("q=") + 2;
+    const int end = line.indexOf(' ', start);
+    const QString term = QUrl::fromPercentEncoding(line.mid(start, end - start));
+
+    m_requests.append(term);
+
+    QStringList suggestions;
+    foreach (const QString &word, s_words) {
+        if (word.startsWith(term)) {
+            suggestions.append(QString("\"%1\"").arg(word));
+        }
+    }
+
+    QByteArray body = QString("[\"%1\",[%2]]").arg(term, suggestions.join(",")).toUtf8();
+
+    // Broken server
+    if (term.startsWith(QLatin1String("inv"))) {
+        body = "<html>Error</html>";
+    }
+
+    socket->readAll();
+    socket->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: application/json\r\n"
+                  "Connection: close\r\n"
+                  "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body);
+    socket->disconnectFromHost();
+}
+
+static void waitForSuggestions(OpenSearchEngine* engine)
+{
+    QEventLoop loop;
+    QObject::connect(engine, SIGNAL(suggestions(QStringList)), &loop, SLOT(quit()));
+    QTimer::singleShot(5000, &loop, SLOT(quit()));
+    loop.exec();
+}
+
+static void waitForReply(QNetworkAccessManager* manager)
+{
+    QEventLoop loop;
+    QObject::connect(manager, SIGNAL(finished(QNetworkReply*)), &loop, SLOT(quit()));
+    QTimer::singleShot(5000, &loop, SLOT(quit()));
+    loop.exec();
+}
+
+static OpenSearchEngine* createEngine(QNetworkAccessManager* manager, quint16 port)
+{
+    OpenSearchEngine* engine = new OpenSearchEngine;
+    engine->setNetworkAccessManager(manager);
+    engine->setSuggestionsUrlTemplate(QString("http://127.0.0.1:%1/suggest?q={searchTerms}").arg(port));
+    engine->setSuggestionsDelay(100);
+    return engine;
+}
+
+void OpenSearchTest::initTestCase()
+{
+    m_server = new SuggestionsServer;
+    QVERIFY(m_server->listen(QHostAddress::LocalHost));
+
+    m_manager = new QNetworkAccessManager;
+    m_manager->setProxy(QNetworkProxy::NoProxy);
+}
+
+void OpenSearchTest::cleanupTestCase()
+{
+    delete m_manager;
+    delete m_server;
+}
+
+void OpenSearchTest::init()
+{
+    m_server->clearRequests();
+}
+
+void OpenSearchTest::debounceTest()
+{
+    OpenSearchEngine* engine = createEngine(m_manager, m_server->serverPort());
+    QSignalSpy spy(engine, SIGNAL(suggestions(QStringList)));
+
+    engine->requestSuggestions("q");
+    engine->requestSuggestions("qu");
+    engine->requestSuggestions("qup");
+
+    waitForSuggestions(engine);
+
+    QCOMPARE(m_server->requests(), QStringList() << "qup");
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toStringList(), QStringList() << "qupzilla" << "qupzilla browser");
+
+    delete engine;
+}
+
+void OpenSearchTest::cacheTest()
+{
+    OpenSearchEngine* engine = createEngine(m_manager, m_server->serverPort());
+
+    engine->requestSuggestions("que");
+    waitForSuggestions(engine);
+    QCOMPARE(m_server->requests().count(), 1);
+
+    // Backspace and retype
+    QSignalSpy spy(engine, SIGNAL(suggestions(QStringList)));
+    engine->requestSuggestions("que");
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toStringList(), QStringList() << "query" << "quest");
+    QCOMPARE(m_server->requests().count(), 1);
+
+    // Changing engine clears the cache
+    engine->setSuggestionsUrlTemplate(QString("http://127.0.0.1:%1/suggest?q={searchTerms}").arg(m_server->serverPort()));
+    engine->requestSuggestions("que");
+    waitForSuggestions(engine);
+    QCOMPARE(m_server->requests().count(), 2);
+
+    delete engine;
+}
+
+void OpenSearchTest::prefixFilterTest()
+{
+    OpenSearchEngine* engine = createEngine(m_manager, m_server->serverPort());
+
+    engine->requestSuggestions("qu");
+    waitForSuggestions(engine);
+    QCOMPARE(m_server->requests(), QStringList() << "qu");
+
+    // Response for "qu" contained less than 10 suggestions, so it is complete
+    QSignalSpy spy(engine, SIGNAL(suggestions(QStringList)));
+    engine->requestSuggestions("qui");
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toStringList(), QStringList() << "quick" << "quiet");
+    QCOMPARE(m_server->requests(), QStringList() << "qu");
+
+    delete engine;
+}
+
+void OpenSearchTest::unusableResponseTest_data()
+{
+    QTest::addColumn<QString>("term");
+    QTest::addColumn<QString>("longerTerm");
+    QTest::addColumn<int>("failed");
+
+    QTest::newRow("invalid") << "inv" << "inva" << 2;
+    QTest::newRow("empty") << "emp" << "empt" << 0;
+}
+
+void OpenSearchTest::unusableResponseTest()
+{
+    QFETCH(QString, term);
+    QFETCH(QString, longerTerm);
+    QFETCH(int, failed);
+
+    OpenSearchEngine* engine = createEngine(m_manager, m_server->serverPort());
+
+    engine->requestSuggestions(term);
+    waitForReply(m_manager);
+    QCOMPARE(m_server->requests(), QStringList() << term);
+
+    // Neither empty nor unparsable response is used for longer terms
+    engine->requestSuggestions(longerTerm);
+    waitForReply(m_manager);
+    QCOMPARE(m_server->requests(), QStringList() << term << longerTerm);
+    QCOMPARE(engine->suggestionsStats().prefixHits, 0);
+    QCOMPARE(engine->suggestionsStats().failed, failed);
+
+    delete engine;
+}
+
+void OpenSearchTest::statsTest()
+{
+    OpenSearchEngine* engine = createEngine(m_manager, m_server->serverPort());
+
+    engine->requestSuggestions("qup");
+    waitForSuggestions(engine);
+    engine->requestSuggestions("qup");
+    engine->requestSuggestions("qupz");
+
+    OpenSearchEngine::SuggestionsStats stats = engine->suggestionsStats();
+    QCOMPARE(stats.requests, 1);
+    QCOMPARE(stats.cacheHits, 1);
+    QCOMPARE(stats.prefixHits, 1);
+    QCOMPARE(stats.failed, 0);
+    QVERIFY(stats.maxLatency >= stats.averageLatency());
+
+    delete engine;
+}
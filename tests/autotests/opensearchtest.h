@@ -0,0 +1,67 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#ifndef OPENSEARCHTEST_H
+#define OPENSEARCHTEST_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QStringList>
+
+class QNetworkAccessManager;
+
+// Local HTTP stand-in for suggestions server
+class SuggestionsServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit SuggestionsServer(QObject* parent = 0);
+
+    QStringList requests() const;
+    void clearRequests();
+
+private slots:
+    void newClient();
+    void readRequest();
+
+private:
+    QStringList m_requests;
+};
+
+class OpenSearchTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void debounceTest();
+    void cacheTest();
+    void prefixFilterTest();
+    void unusableResponseTest_data();
+    void unusableResponseTest();
+    void statsTest();
+
+private:
+    SuggestionsServer* m_server;
+    QNetworkAccessManager* m_manager;
+};
+
+#endif // OPENSEARCHTEST_H
@@ -0,0 +1,162 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "proxytest.h"
+#include "networkproxyfactory.h"
+#include "datapaths.h"
+#include "settings.h"
+
+#include <QtTest/QtTest>
+#include <QDir>
+#include <QFile>
+#include <QSettings>
+
+static QStringList largeExceptionList(int count)
+{
+    QStringList list;
+    list << "localhost" << "127.0.0.1" << "10.0.0.0/8" << "*intranet*";
+
+    for (int i = 0; i < count; ++i) {
+        switch (i % 4) {
+        case 0:
+            list.append(QString("host%1.corp.example.com").arg(i));
+            break;
+        case 1:
+            list.append(QString("*.dept%1.example.org").arg(i));
+            break;
+        case 2:
+            list.append(QString("172.%1.0.0/16").arg(i % 256));
+            break;
+        default:
+            list.append(QString("build%1-*.example.net").arg(i));
+            break;
+        }
+    }
+
+    return list;
+}
+
+static QString settingsFile()
+{
+    return QDir::tempPath() + QLatin1String("/qz-test-proxy/settings.ini");
+}
+
+void ProxyTest::initTestCase()
+{
+    // Benchmark overwrites Web-Proxy group, so don't share settings with other tests
+    QFile::remove(settingsFile());
+    DataPaths::setCurrentProfilePath(QDir::tempPath() + "qz-test");
+    Settings::createSettings(settingsFile());
+}
+
+void ProxyTest::cleanupTestCase()
+{
+    Settings::globalSettings()->clear();
+    Settings::syncSettings();
+    QFile::remove(settingsFile());
+    QDir(QDir::tempPath()).rmdir(QLatin1String("qz-test-proxy"));
+
+    Settings::createSettings(QDir::tempPath() + "qz-test/settings.ini");
+}
+
+void ProxyTest::exceptionsMatchTest_data()
+{
+    QTest::addColumn<QStringList>("exceptions");
+    QTest::addColumn<QString>("host");
+    QTest::addColumn<bool>("result");
+
+    QStringList list;
+    list << "localhost" << "127.0.0.1" << "::1" << "example.com" << ".example.org"
+         << "*.example.net" << "192.168.0.0/16" << "*intranet*" << "build-?.local"
+         << "10.0" << "172.16." << "corpnet";
+
+    QTest::newRow("exact1") << list << "localhost" << true;
+    QTest::newRow("exact2") << list << "LocalHost" << true;
+    QTest::newRow("exact3") << list << "127.0.0.1" << true;
+    QTest::newRow("exact4") << list << "::1" << true;
+    QTest::newRow("exact5") << list << "127.0.0.2" << false;
+    QTest::newRow("domain1") << list << "example.com" << true;
+    QTest::newRow("domain2") << list << "www.example.com" << true;
+    QTest::newRow("domain3") << list << "anotherexample.com" << false;
+    QTest::newRow("domain4") << list << "example.com." << true;
+    QTest::newRow("domain5") << list << "a.b.example.org" << true;
+    QTest::newRow("domain6") << list << "www.example.net" << true;
+    QTest::newRow("domain7") << list << "example.co" << false;
+    QTest::newRow("subnet1") << list << "192.168.10.1" << true;
+    QTest::newRow("subnet2") << list << "192.169.10.1" << false;
+    QTest::newRow("wildcard1") << list << "my.intranet.lan" << true;
+    QTest::newRow("wildcard2") << list << "build-1.local" << true;
+    QTest::newRow("wildcard3") << list << "build-12.local" << false;
+    QTest::newRow("substring1") << list << "10.0.5.1" << true;
+    QTest::newRow("substring2") << list << "110.0.5.1" << true;
+    QTest::newRow("substring3") << list << "172.16.1.1" << true;
+    QTest::newRow("substring4") << list << "172.17.1.1" << false;
+    QTest::newRow("substring5") << list << "www.corpnet.lan" << true;
+    QTest::newRow("empty") << list << "" << false;
+}
+
+void ProxyTest::exceptionsMatchTest()
+{
+    QFETCH(QStringList, exceptions);
+    QFETCH(QString, host);
+    QFETCH(bool, result);
+
+    ProxyExceptions matcher;
+    matcher.setExceptions(exceptions);
+
+    QCOMPARE(matcher.match(host), result);
+}
+
+void ProxyTest::queryProxyBenchmark_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10") << 10;
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+void ProxyTest::queryProxyBenchmark()
+{
+    QFETCH(int, count);
+
+    // Defined proxy without hostname resolves to NoProxy, so only exceptions are measured
+    Settings settings;
+    settings.beginGroup("Web-Proxy");
+    settings.setValue("UseProxy", NetworkProxyFactory::DefinedProxy);
+    settings.setValue("HostName", QString());
+    settings.setValue("ProxyExceptions", largeExceptionList(count));
+    settings.endGroup();
+
+    NetworkProxyFactory factory;
+    factory.loadSettings();
+
+    QList<QNetworkProxyQuery> queries;
+    queries << QNetworkProxyQuery(QUrl("http://www.qupzilla.com/"))
+            << QNetworkProxyQuery(QUrl("https://host4.corp.example.com/login"))
+            << QNetworkProxyQuery(QUrl("http://www.dept5.example.org/"))
+            << QNetworkProxyQuery(QUrl("http://172.6.1.1/"))
+            << QNetworkProxyQuery(QUrl("http://build7-x86.example.net/"))
+            << QNetworkProxyQuery(QUrl("http://10.1.2.3:8080/"))
+            << QNetworkProxyQuery(QUrl("http://en.wikipedia.org/wiki/Proxy_server"));
+
+    QBENCHMARK {
+        foreach (const QNetworkProxyQuery &query, queries) {
+            factory.queryProxy(query);
+        }
+    }
+}
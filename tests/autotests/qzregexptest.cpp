@@ -0,0 +1,126 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "qzregexptest.h"
+#include "qzregexp.h"
+
+#include <QtTest/QtTest>
+#include <QThread>
+
+class MatchingThread : public QThread
+{
+public:
+    MatchingThread(const QzRegExp &rx)
+        : m_rx(rx)
+        , m_failed(false)
+    {
+    }
+
+    bool failed() const { return m_failed; }
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < 2000; ++i) {
+            const QString str = QString("http://host%1.example.com/ads/banner.png").arg(i);
+            const QzRegExpMatch match = m_rx.matchIn(str);
+
+            if (!m_rx.matches(str) || match.captured(1) != QString("host%1").arg(i)) {
+                m_failed = true;
+            }
+        }
+    }
+
+private:
+    const QzRegExp &m_rx;
+    bool m_failed;
+};
+
+void QzRegExpTest::matchIn_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<int>("start");
+    QTest::addColumn<int>("length");
+    QTest::addColumn<QString>("cap1");
+
+    QTest::newRow("NoMatch") << "a(b)c" << "xyz" << 0 << -1 << -1 << "";
+    QTest::newRow("Match") << "a(b)c" << "xabcx" << 0 << 1 << 3 << "b";
+    QTest::newRow("MatchWithOffset") << "a(b+)c" << "abcxabbc" << 1 << 4 << 4 << "bb";
+    QTest::newRow("NoMatchAfterOffset") << "a(b)c" << "abcx" << 1 << -1 << -1 << "";
+}
+
+void QzRegExpTest::matchIn()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QString, string);
+    QFETCH(int, offset);
+    QFETCH(int, start);
+    QFETCH(int, length);
+    QFETCH(QString, cap1);
+
+    QzRegExp rx(pattern);
+    QzRegExpMatch match = rx.matchIn(string, offset);
+
+    QCOMPARE(match.hasMatch(), start != -1);
+    QCOMPARE(match.capturedStart(), start);
+    QCOMPARE(match.capturedLength(), length);
+    QCOMPARE(match.captured(1), cap1);
+
+    // Matching must not change results of QRegExp compatible interface
+    QCOMPARE(rx.matchedLength(), -1);
+}
+
+void QzRegExpTest::dontCaptureTexts()
+{
+    QzRegExp rx("<link(.*)>", Qt::CaseInsensitive);
+    rx.setMinimal(true);
+
+    const QString html("<head><LINK rel=\"icon\"><link href=\"a\"></head>");
+    QzRegExpMatch match = rx.matchIn(html, 0, QzRegExp::DontCaptureTexts);
+
+    QVERIFY(match.hasMatch());
+    QCOMPARE(match.captured(), QString("<LINK rel=\"icon\">"));
+
+    match = rx.matchIn(html, match.capturedEnd(), QzRegExp::DontCaptureTexts);
+
+    QVERIFY(match.hasMatch());
+    QCOMPARE(match.captured(0), QString("<link href=\"a\">"));
+    QCOMPARE(match.capturedEnd(), html.indexOf(QLatin1String("</head>")));
+}
+
+void QzRegExpTest::concurrentMatching()
+{
+    const QzRegExp rx("^http://(host\\d+)\\.example\\.com/ads/");
+
+    QList<MatchingThread*> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.append(new MatchingThread(rx));
+    }
+
+    foreach (MatchingThread* thread, threads) {
+        thread->start();
+    }
+
+    foreach (MatchingThread* thread, threads) {
+        thread->wait();
+        QVERIFY(!thread->failed());
+    }
+
+    qDeleteAll(threads);
+}
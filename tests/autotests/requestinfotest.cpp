@@ -0,0 +1,107 @@
+/* ============================================================
+* QupZilla - WebKit based browser
+* Copyright (C) 2014  David Rosca <nowrep@gmail.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+* ============================================================ */
+#include "requestinfotest.h"
+#include "requestinfo.h"
+
+#include <QtTest/QtTest>
+
+Q_DECLARE_METATYPE(RequestInfo::Scheme)
+
+void RequestInfoTest::schemeTest_data()
+{
+    QTest::addColumn<QUrl>("url");
+    QTest::addColumn<RequestInfo::Scheme>("scheme");
+    QTest::addColumn<QString>("schemeString");
+    QTest::addColumn<QString>("host");
+
+    QTest::newRow("http") << QUrl("http://www.example.com/") << RequestInfo::HttpScheme << "http" << "www.example.com";
+    QTest::newRow("https") << QUrl("HTTPS://WWW.Example.COM/Path") << RequestInfo::HttpsScheme << "https" << "www.example.com";
+    QTest::newRow("ftp") << QUrl("ftp://ftp.example.com/file") << RequestInfo::FtpScheme << "ftp" << "ftp.example.com";
+    QTest::newRow("file") << QUrl("file:///home/user/file.html") << RequestInfo::FileScheme << "file" << "";
+    QTest::newRow("qupzilla") << QUrl("qupzilla:config") << RequestInfo::QupZillaScheme << "qupzilla" << "";
+    QTest::newRow("abp") << QUrl("abp:subscribe?location=x") << RequestInfo::AdBlockScheme << "abp" << "";
+    QTest::newRow("other") << QUrl("gopher://example.com/") << RequestInfo::OtherScheme << "gopher" << "example.com";
+}
+
+void RequestInfoTest::schemeTest()
+{
+    QFETCH(QUrl, url);
+    QFETCH(RequestInfo::Scheme, scheme);
+    QFETCH(QString, schemeString);
+    QFETCH(QString, host);
+
+    const RequestInfo info(url);
+
+    QCOMPARE(info.scheme(), scheme);
+    QCOMPARE(info.schemeString(), schemeString);
+    QCOMPARE(info.host(), host);
+    QCOMPARE(info.isHttp(), scheme == RequestInfo::HttpScheme || scheme == RequestInfo::HttpsScheme);
+}
+
+void RequestInfoTest::hostMatchesDomainsTest_data()
+{
+    QTest::addColumn<QString>("host");
+    QTest::addColumn<bool>("result");
+
+    QTest::newRow("exact") << "live.com" << true;
+    QTest::newRow("subdomain") << "login.live.com" << true;
+    QTest::newRow("subsubdomain") << "a.login.live.com" << true;
+    QTest::newRow("uppercase") << "LOGIN.Live.com" << true;
+    QTest::newRow("prefix") << "notlive.com" << false;
+    QTest::newRow("suffix") << "live.com.evil.org" << false;
+    QTest::newRow("tld") << "com" << false;
+    QTest::newRow("other") << "i0.cz.example.com" << false;
+}
+
+void RequestInfoTest::hostMatchesDomainsTest()
+{
+    QFETCH(QString, host);
+    QFETCH(bool, result);
+
+    QSet<QString> domains;
+    domains << "live.com" << "i0.cz" << "centrum.sk";
+
+    const RequestInfo info(QUrl(QString("https://%1/").arg(host)));
+
+    QCOMPARE(info.hostMatchesDomains(domains), result);
+    QCOMPARE(info.hostMatchesDomains(QSet<QString>()), false);
+}
+
+void RequestInfoTest::registrableDomainTest_data()
+{
+    QTest::addColumn<QUrl>("url");
+    QTest::addColumn<QString>("domain");
+
+    QTest::newRow("simple") << QUrl("http://example.com/") << "example.com";
+    QTest::newRow("subdomain") << QUrl("http://www.example.com/") << "example.com";
+    QTest::newRow("subsubdomain") << QUrl("http://a.b.example.com/") << "example.com";
+#if QT_VERSION >= 0x040800
+    QTest::newRow("co.uk") << QUrl("http://www.example.co.uk/") << "example.co.uk";
+#endif
+}
+
+void RequestInfoTest::registrableDomainTest()
+{
+    QFETCH(QUrl, url);
+    QFETCH(QString, domain);
+
+    const RequestInfo info(url);
+
+    QCOMPARE(info.registrableDomain(), domain);
+    QCOMPARE(RequestInfo::registrableDomainForUrl(url), domain);
+}